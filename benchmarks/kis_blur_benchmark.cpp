@@ -15,6 +15,7 @@
 #include <KoColor.h>
 
 #include <kis_image.h>
+#include <kis_default_bounds.h>
 
 #include "filter/kis_filter_registry.h"
 #include "filter/kis_filter_configuration.h"
@@ -24,6 +25,9 @@
 
 #include "kis_selection.h"
 #include <kis_iterator_ng.h>
+#include <kis_gaussian_kernel.h>
+#include <kis_convolution_kernel.h>
+#include <kis_convolution_painter.h>
 #include <KisGlobalResourcesInterface.h>
 
 void KisBlurBenchmark::initTestCase()
@@ -76,6 +80,66 @@ void KisBlurBenchmark::benchmarkFilter()
     }
 }
 
+namespace {
+/**
+ * BORDER_REPEAT needs the bounds of the image to be known
+ */
+KisPaintDeviceSP createBoundedCopy(KisPaintDeviceSP src, KisImageSP image)
+{
+    KisPaintDeviceSP dev = new KisPaintDevice(*src);
+    dev->setDefaultBounds(new KisDefaultBounds(image));
+    return dev;
+}
+}
 
+void KisBlurBenchmark::benchmarkLargeRadius_data()
+{
+    QTest::addColumn<qreal>("radius");
+
+    QTest::newRow("100") << 100.0;
+    QTest::newRow("200") << 200.0;
+    QTest::newRow("300") << 300.0;
+    QTest::newRow("500") << 500.0;
+}
+
+void KisBlurBenchmark::benchmarkLargeRadius()
+{
+    QFETCH(qreal, radius);
+
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    KisImageSP image = new KisImage(0, rc.width(), rc.height(), m_colorSpace, "blur benchmark");
+    KisPaintDeviceSP dev = createBoundedCopy(m_device, image);
+
+    QBENCHMARK_ONCE {
+        KisGaussianKernel::applyGaussian(dev, rc, radius, radius,
+                                         m_colorSpace->channelFlags(true, true), 0);
+    }
+}
+
+void KisBlurBenchmark::benchmarkLargeRadiusFFT_data()
+{
+    benchmarkLargeRadius_data();
+}
+
+void KisBlurBenchmark::benchmarkLargeRadiusFFT()
+{
+    QFETCH(qreal, radius);
+
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const QRect rc(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT);
+    KisImageSP image = new KisImage(0, rc.width(), rc.height(), m_colorSpace, "blur benchmark");
+    KisPaintDeviceSP dev = createBoundedCopy(m_device, image);
+
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(radius, radius);
+
+    QBENCHMARK_ONCE {
+        KisConvolutionPainter painter(dev, KisConvolutionPainter::FFTW);
+        painter.setChannelFlags(m_colorSpace->channelFlags(true, true));
+        painter.applyMatrix(kernel, dev, rc.topLeft(), rc.topLeft(), rc.size(), BORDER_REPEAT);
+    }
+}
 
 SIMPLE_TEST_MAIN(KisBlurBenchmark)
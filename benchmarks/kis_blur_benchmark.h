@@ -27,6 +27,11 @@ private Q_SLOTS:
     void cleanupTestCase();
     
     void benchmarkFilter();
+
+    void benchmarkLargeRadius_data();
+    void benchmarkLargeRadius();
+    void benchmarkLargeRadiusFFT_data();
+    void benchmarkLargeRadiusFFT();
     
 };
 
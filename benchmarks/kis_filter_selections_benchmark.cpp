@@ -7,6 +7,7 @@
 #include "kis_filter_selections_benchmark.h"
 
 #include "kis_painter.h"
+#include "kis_pixel_selection.h"
 
 #include <simpletest.h>
 #include <testutil.h>
@@ -137,6 +138,8 @@ void KisFilterSelectionsBenchmark::testAll()
     testFilter("invert");
 //    testFilter("levels");
 
+    testSelectionOperations(WARMUP_CYCLES);
+    testSelectionOperations(NUM_CYCLES);
 }
 
 void KisFilterSelectionsBenchmark::testUsualSelections(int num)
@@ -278,4 +281,64 @@ void KisFilterSelectionsBenchmark::testBitBltSelections(int num)
         dbgKrita << "bitBlt with sel:\t\t\t" << avTime;
 }
 
+void KisFilterSelectionsBenchmark::testSelectionOperations(int num)
+{
+    /**
+     * The selection has large fully selected and fully deselected areas,
+     * so most of the patches should be processed without touching the
+     * pixels
+     */
+    KisPixelSelectionSP shiftedSelection = new KisPixelSelection(*m_selection->pixelSelection());
+    shiftedSelection->moveTo(QPoint(100, 64));
+
+    double addTime = 0;
+    double subtractTime = 0;
+    double intersectTime = 0;
+    double invertTime = 0;
+    KisTimeCounter timer;
+
+    for (int i = 0; i < num; i++) {
+        KisPixelSelectionSP selection = new KisPixelSelection(*m_selection->pixelSelection());
+
+        timer.restart();
+        selection->addSelection(shiftedSelection);
+        addTime += timer.elapsed();
+
+        timer.restart();
+        selection->subtractSelection(m_selection->pixelSelection());
+        subtractTime += timer.elapsed();
+
+        timer.restart();
+        selection->intersectSelection(shiftedSelection);
+        intersectTime += timer.elapsed();
+
+        timer.restart();
+        selection->invert();
+        invertTime += timer.elapsed();
+    }
+
+    KisPaintDeviceSP projection =
+        new KisPaintDevice(m_device->colorSpace());
+    QRect filterRect = m_selection->selectedExactRect();
+
+    timer.restart();
+    for (int i = 0; i < num; i++) {
+        KisPainter gc(projection);
+        gc.beginTransaction();
+        gc.setCompositeOpId(COMPOSITE_OVER);
+        gc.setSelection(m_selection);
+        gc.bitBlt(filterRect.topLeft(), m_device, filterRect);
+        gc.deleteTransaction();
+    }
+    const double bitBltTime = double(timer.elapsed()) / num;
+
+    if (num > WARMUP_CYCLES || SHOW_WARMUPS) {
+        dbgKrita << "Add selection:\t\t\t\t" << addTime / num;
+        dbgKrita << "Subtract selection:\t\t\t" << subtractTime / num;
+        dbgKrita << "Intersect selection:\t\t\t" << intersectTime / num;
+        dbgKrita << "Invert selection:\t\t\t" << invertTime / num;
+        dbgKrita << "bitBlt (over) with sel:\t\t" << bitBltTime;
+    }
+}
+
 SIMPLE_TEST_MAIN(KisFilterSelectionsBenchmark)
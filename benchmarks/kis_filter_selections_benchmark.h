@@ -31,6 +31,7 @@ private:
     void testGoodSelections(int num);
     void testBitBltWOSelections(int num);
     void testBitBltSelections(int num);
+    void testSelectionOperations(int num);
 private:
     KisSelectionSP m_selection;
     KisPaintDeviceSP m_device;
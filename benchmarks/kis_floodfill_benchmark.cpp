@@ -21,6 +21,13 @@
 #include "kis_floodfill_benchmark.h"
 
 #include <kis_fill_painter.h>
+#include <kis_pixel_selection.h>
+#include <kis_default_bounds.h>
+#include <floodfill/kis_scanline_fill.h>
+
+namespace {
+const QSize comicPageSize(7000, 10000);
+}
 
 void KisFloodFillBenchmark::initTestCase()
 {
@@ -70,6 +77,36 @@ void KisFloodFillBenchmark::initTestCase()
     m_existingSelection = new KisPaintDevice(alphacs);
     m_existingSelection->fill(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT, defaultSelected.data());
 
+    // a line art page: a white sheet with a few panels and lots of dabs in them
+    m_comicPage = new KisPaintDevice(m_colorSpace);
+    m_comicPage->fill(QRect(QPoint(), comicPageSize), KoColor(Qt::white, m_colorSpace));
+
+    const KoColor ink(Qt::black, m_colorSpace);
+    const int border = 20;
+    const int panelWidth = comicPageSize.width() / 2;
+    const int panelHeight = comicPageSize.height() / 3;
+
+    for (int row = 0; row < 3; row++) {
+        for (int col = 0; col < 2; col++) {
+            const QRect panel(col * panelWidth + 100, row * panelHeight + 100,
+                              panelWidth - 200, panelHeight - 200);
+
+            m_comicPage->fill(QRect(panel.left(), panel.top(), panel.width(), border), ink);
+            m_comicPage->fill(QRect(panel.left(), panel.bottom() - border + 1, panel.width(), border), ink);
+            m_comicPage->fill(QRect(panel.left(), panel.top(), border, panel.height()), ink);
+            m_comicPage->fill(QRect(panel.right() - border + 1, panel.top(), border, panel.height()), ink);
+        }
+    }
+
+    KisPainter pagePainter(m_comicPage);
+    pagePainter.setFillStyle(KisPainter::FillStyleForegroundColor);
+    pagePainter.setPaintColor(ink);
+
+    for (int i = 0; i < 3000; i++) {
+        x = rand() % comicPageSize.width();
+        y = rand() % comicPageSize.height();
+        pagePainter.paintEllipse(x, y, 5 + rand() % 200, 5 + rand() % 200);
+    }
 }
 
 void KisFloodFillBenchmark::benchmarkFlood()
@@ -170,6 +207,37 @@ void KisFloodFillBenchmark::benchmarkFloodWithSelectionAsBoundary()
     }
 }
 
+void KisFloodFillBenchmark::benchmarkComicPageFill_data()
+{
+    QTest::addColumn<bool>("useParallelEngine");
+    QTest::addColumn<int>("opacitySpread");
+
+    QTest::newRow("scanline") << false << 100;
+    QTest::newRow("parallel") << true << 100;
+    QTest::newRow("scanline-soft") << false << 50;
+    QTest::newRow("parallel-soft") << true << 50;
+}
+
+void KisFloodFillBenchmark::benchmarkComicPageFill()
+{
+    QFETCH(bool, useParallelEngine);
+    QFETCH(int, opacitySpread);
+
+    const QRect pageRect(QPoint(), comicPageSize);
+
+    QBENCHMARK
+    {
+        KisPixelSelectionSP pixelSelection =
+            new KisPixelSelection(new KisSelectionDefaultBounds(m_comicPage));
+
+        // fill the first panel around the dabs
+        KisScanlineFill gc(m_comicPage, QPoint(130, 130), pageRect);
+        gc.setUseParallelEngine(useParallelEngine);
+        gc.setThreshold(15);
+        gc.setOpacitySpread(opacitySpread);
+        gc.fillSelection(pixelSelection);
+    }
+}
 
 void KisFloodFillBenchmark::cleanupTestCase()
 {
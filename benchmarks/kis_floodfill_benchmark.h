@@ -25,6 +25,7 @@ private:
     KisPaintDeviceSP m_deviceWithSelectionAsBoundary;
     KisPaintDeviceSP m_deviceWithoutSelectionAsBoundary;
     KisPaintDeviceSP m_existingSelection;
+    KisPaintDeviceSP m_comicPage;
     int m_startX;
     int m_startY;
     
@@ -36,9 +37,8 @@ private Q_SLOTS:
     void benchmarkFloodWithoutSelectionAsBoundary();
     void benchmarkFloodWithSelectionAsBoundary();
 
-    
-    
-    
+    void benchmarkComicPageFill_data();
+    void benchmarkComicPageFill();
 };
 
 #endif
@@ -15,6 +15,11 @@
 
 #include <simpletest.h>
 
+#include <QThread>
+
+#include <thread>
+#include <vector>
+
 #include "kis_iterator_ng.h"
 
 void KisHLineIteratorBenchmark::initTestCase()
@@ -178,5 +183,54 @@ void KisHLineIteratorBenchmark::benchmarkTwoIteratorsNoMemCpy(){
 }
 
 
+/**
+ * Splits the test image into horizontal stripes and writes \p color into
+ * every stripe of \p device from a separate thread. The stripes are
+ * interleaved with the tile height, so that all the threads access the
+ * tile hash table and the extent manager concurrently.
+ */
+static void concurrentFill(KisPaintDevice *device, const KoColor &color)
+{
+    const int numThreads = qMax(2, QThread::idealThreadCount());
+    const int pixelSize = device->pixelSize();
+    const int stripeHeight = 64;
+
+    std::vector<std::thread> threads;
+
+    for (int i = 0; i < numThreads; i++) {
+        threads.emplace_back([=] () {
+            for (int y = i * stripeHeight; y < TEST_IMAGE_HEIGHT; y += numThreads * stripeHeight) {
+                const int height = qMin(stripeHeight, TEST_IMAGE_HEIGHT - y);
+                KisHLineIteratorSP it = device->createHLineIteratorNG(0, y, TEST_IMAGE_WIDTH);
+
+                for (int j = 0; j < height; j++) {
+                    do {
+                        memcpy(it->rawData(), color.data(), pixelSize);
+                    } while (it->nextPixel());
+                    it->nextRow();
+                }
+            }
+        });
+    }
+
+    for (std::thread &thread : threads) {
+        thread.join();
+    }
+}
+
+void KisHLineIteratorBenchmark::benchmarkConcurrentWriteNewTiles()
+{
+    QBENCHMARK{
+        KisPaintDevice device(m_colorSpace);
+        concurrentFill(&device, *m_color);
+    }
+}
+
+void KisHLineIteratorBenchmark::benchmarkConcurrentWriteBytes()
+{
+    QBENCHMARK{
+        concurrentFill(m_device, *m_color);
+    }
+}
 
 SIMPLE_TEST_MAIN(KisHLineIteratorBenchmark)
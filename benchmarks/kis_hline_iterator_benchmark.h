@@ -44,6 +44,12 @@ private Q_SLOTS:
     void benchmarkConstNoMemCpy();
     // copy from one device to another
     void benchmarkTwoIteratorsNoMemCpy();
+
+    // several threads writing into a shared device,
+    // creating new tiles on the way
+    void benchmarkConcurrentWriteNewTiles();
+    // several threads writing into the already existing tiles
+    void benchmarkConcurrentWriteBytes();
     
 
     
@@ -90,6 +90,41 @@ void KisLevelFilterBenchmark::benchmarkFilter()
     }
 }
 
+void KisLevelFilterBenchmark::benchmarkDodgeBurn_data()
+{
+    QTest::addColumn<QString>("filterId");
+    QTest::addColumn<int>("type");
+
+    // the type values correspond to KisFilterDodgeBurn::Type
+    QTest::newRow("dodge-shadows") << "dodge" << 0;
+    QTest::newRow("dodge-midtones") << "dodge" << 1;
+    QTest::newRow("dodge-highlights") << "dodge" << 2;
+    QTest::newRow("burn-shadows") << "burn" << 0;
+    QTest::newRow("burn-midtones") << "burn" << 1;
+    QTest::newRow("burn-highlights") << "burn" << 2;
+}
+
+void KisLevelFilterBenchmark::benchmarkDodgeBurn()
+{
+    QFETCH(QString, filterId);
+    QFETCH(int, type);
 
+    KisFilterSP filter = KisFilterRegistry::instance()->value(filterId);
+    QVERIFY(filter);
+
+    KisFilterConfigurationSP kfc =
+        new KisColorTransformationConfiguration(filterId, 1, KisGlobalResourcesInterface::instance());
+    kfc->setProperty("exposure", 0.5);
+    kfc->setProperty("type", type);
+
+    QSize size = KritaUtils::optimalPatchSize();
+    QVector<QRect> rects = KritaUtils::splitRectIntoPatches(QRect(0, 0, GMP_IMAGE_WIDTH,GMP_IMAGE_HEIGHT), size);
+
+    QBENCHMARK{
+        Q_FOREACH (const QRect &rc, rects) {
+            filter->process(m_device, rc, kfc);
+        }
+    }
+}
 
 SIMPLE_TEST_MAIN(KisLevelFilterBenchmark)
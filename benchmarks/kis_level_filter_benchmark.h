@@ -28,6 +28,9 @@ private Q_SLOTS:
     void cleanupTestCase();
 
     void benchmarkFilter();
+
+    void benchmarkDodgeBurn_data();
+    void benchmarkDodgeBurn();
 };
 
 #endif // KIS_LEVEL_FILTER_BENCHMARK_H
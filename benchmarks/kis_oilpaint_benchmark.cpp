@@ -0,0 +1,73 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <simpletest.h>
+
+#include "kis_oilpaint_benchmark.h"
+#include "kis_benchmark_values.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColor.h>
+
+#include "filter/kis_filter_registry.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter.h"
+
+#include <kis_iterator_ng.h>
+#include <kis_sequential_iterator.h>
+#include "krita_utils.h"
+#include <KisGlobalResourcesInterface.h>
+
+void KisOilPaintBenchmark::initTestCase()
+{
+    m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    m_device = new KisPaintDevice(m_colorSpace);
+    KoColor color(m_colorSpace);
+
+    srand(31524744);
+
+    KisSequentialIterator it(m_device, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), m_colorSpace->pixelSize());
+    }
+}
+
+void KisOilPaintBenchmark::benchmarkFilter_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("5") << 5;
+    QTest::newRow("10") << 10;
+    QTest::newRow("20") << 20;
+    QTest::newRow("50") << 50;
+}
+
+void KisOilPaintBenchmark::benchmarkFilter()
+{
+    QFETCH(int, radius);
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value("oilpaint");
+    QVERIFY(filter);
+
+    KisFilterConfigurationSP kfc = filter->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    kfc->setProperty("brushSize", radius);
+    kfc->setProperty("smooth", 30);
+
+    QSize size = KritaUtils::optimalPatchSize();
+    QVector<QRect> rects = KritaUtils::splitRectIntoPatches(QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT), size);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+
+    QBENCHMARK_ONCE {
+        Q_FOREACH (const QRect &rc, rects) {
+            filter->process(dev, dev, KisSelectionSP(), rc, kfc);
+        }
+    }
+}
+
+SIMPLE_TEST_MAIN(KisOilPaintBenchmark)
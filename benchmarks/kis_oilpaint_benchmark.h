@@ -0,0 +1,29 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_OILPAINT_BENCHMARK_H
+#define KIS_OILPAINT_BENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+#include <kis_paint_device.h>
+
+class KisOilPaintBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    const KoColorSpace * m_colorSpace;
+    KisPaintDeviceSP m_device;
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkFilter_data();
+    void benchmarkFilter();
+};
+
+#endif // KIS_OILPAINT_BENCHMARK_H
@@ -0,0 +1,150 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include <simpletest.h>
+#include <QtMath>
+#include <QTransform>
+
+#include "kis_transform_worker_benchmark.h"
+#include "kis_benchmark_values.h"
+
+#include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
+#include <KoColor.h>
+#include <KoUpdater.h>
+
+#include "kis_filter_strategy.h"
+#include "kis_transform_worker.h"
+#include "kis_perspectivetransform_worker.h"
+#include "kis_warptransform_worker.h"
+#include "kis_transaction.h"
+
+#include <kis_sequential_iterator.h>
+
+void KisTransformWorkerBenchmark::initTestCase()
+{
+    m_colorSpace = KoColorSpaceRegistry::instance()->rgb8();
+    m_device = new KisPaintDevice(m_colorSpace);
+    KoColor color(m_colorSpace);
+
+    srand(31524744);
+
+    KisSequentialIterator it(m_device, QRect(0, 0, GMP_IMAGE_WIDTH, GMP_IMAGE_HEIGHT));
+    while (it.nextPixel()) {
+        color.fromQColor(QColor(rand() % 255, rand() % 255, rand() % 255));
+        memcpy(it.rawData(), color.data(), m_colorSpace->pixelSize());
+    }
+}
+
+void KisTransformWorkerBenchmark::benchmarkScale_data()
+{
+    QTest::addColumn<QString>("filterId");
+    QTest::addColumn<qreal>("scale");
+
+    QTest::newRow("bilinear-0.5") << "Bilinear" << 0.5;
+    QTest::newRow("bilinear-2.0") << "Bilinear" << 2.0;
+    QTest::newRow("bicubic-0.5") << "Bicubic" << 0.5;
+    QTest::newRow("bicubic-2.0") << "Bicubic" << 2.0;
+    QTest::newRow("lanczos3-0.5") << "Lanczos3" << 0.5;
+    QTest::newRow("lanczos3-2.0") << "Lanczos3" << 2.0;
+}
+
+void KisTransformWorkerBenchmark::benchmarkScale()
+{
+    QFETCH(QString, filterId);
+    QFETCH(qreal, scale);
+
+    KisFilterStrategy *filter = KisFilterStrategyRegistry::instance()->value(filterId);
+    QVERIFY(filter);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+
+    QBENCHMARK_ONCE {
+        KisTransaction t(dev);
+        KisTransformWorker tw(dev, scale, scale,
+                              0.0, 0.0,
+                              0.0,
+                              0, 0, KoUpdaterPtr(), filter);
+        tw.run();
+        t.end();
+    }
+}
+
+void KisTransformWorkerBenchmark::benchmarkRotateShear_data()
+{
+    QTest::addColumn<qreal>("rotation");
+    QTest::addColumn<qreal>("shear");
+
+    QTest::newRow("rotate-30") << M_PI / 6 << 0.0;
+    QTest::newRow("shear-0.5") << 0.0 << 0.5;
+}
+
+void KisTransformWorkerBenchmark::benchmarkRotateShear()
+{
+    QFETCH(qreal, rotation);
+    QFETCH(qreal, shear);
+
+    KisFilterStrategy *filter = KisFilterStrategyRegistry::instance()->value("Bicubic");
+    QVERIFY(filter);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+
+    QBENCHMARK_ONCE {
+        KisTransaction t(dev);
+        KisTransformWorker tw(dev, 1.0, 1.0,
+                              shear, 0.0,
+                              rotation,
+                              0, 0, KoUpdaterPtr(), filter);
+        tw.run();
+        t.end();
+    }
+}
+
+void KisTransformWorkerBenchmark::benchmarkPerspective()
+{
+    QTransform transform = QTransform::fromScale(1.2, 0.9);
+    transform.rotateRadians(M_PI / 9);
+    transform = QTransform(transform.m11(), transform.m12(), 0.0001,
+                           transform.m21(), transform.m22(), 0.00005,
+                           transform.m31(), transform.m32(), 1.0);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(*m_device);
+
+    QBENCHMARK_ONCE {
+        KisPerspectiveTransformWorker worker(dev, transform, false, KoUpdaterPtr());
+        worker.run();
+    }
+}
+
+void KisTransformWorkerBenchmark::benchmarkWarp()
+{
+    const QRectF bounds = m_device->exactBounds();
+
+    QVector<QPointF> origPoints;
+    origPoints << bounds.topLeft();
+    origPoints << bounds.topRight();
+    origPoints << bounds.bottomRight();
+    origPoints << bounds.bottomLeft();
+    origPoints << bounds.center();
+
+    QVector<QPointF> transfPoints;
+    transfPoints << bounds.topLeft();
+    transfPoints << bounds.topRight() + QPointF(100, 50);
+    transfPoints << bounds.bottomRight();
+    transfPoints << bounds.bottomLeft() + QPointF(-50, 100);
+    transfPoints << bounds.center() + QPointF(200, 150);
+
+    KisPaintDeviceSP srcDev = new KisPaintDevice(*m_device);
+    KisPaintDeviceSP dstDev = new KisPaintDevice(m_colorSpace);
+
+    QBENCHMARK_ONCE {
+        KisWarpTransformWorker worker(KisWarpTransformWorker::RIGID_TRANSFORM,
+                                      origPoints, transfPoints, 1.0, 0);
+        worker.run(srcDev, dstDev);
+    }
+}
+
+SIMPLE_TEST_MAIN(KisTransformWorkerBenchmark)
@@ -0,0 +1,35 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KIS_TRANSFORM_WORKER_BENCHMARK_H
+#define KIS_TRANSFORM_WORKER_BENCHMARK_H
+
+#include <simpletest.h>
+#include <kis_types.h>
+#include <kis_paint_device.h>
+
+class KisTransformWorkerBenchmark : public QObject
+{
+    Q_OBJECT
+
+private:
+    const KoColorSpace * m_colorSpace;
+    KisPaintDeviceSP m_device;
+
+private Q_SLOTS:
+    void initTestCase();
+
+    void benchmarkScale_data();
+    void benchmarkScale();
+
+    void benchmarkRotateShear_data();
+    void benchmarkRotateShear();
+
+    void benchmarkPerspective();
+    void benchmarkWarp();
+};
+
+#endif // KIS_TRANSFORM_WORKER_BENCHMARK_H
@@ -0,0 +1,343 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTraceRecorder.h"
+
+#include <algorithm>
+
+#include <QGlobalStatic>
+#include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
+#include <QVector>
+#include <QSharedPointer>
+#include <QThread>
+#include <QSaveFile>
+#include <QJsonArray>
+#include <QJsonObject>
+#include <QJsonDocument>
+
+#include "kis_debug.h"
+
+Q_GLOBAL_STATIC(KisTraceRecorder, s_instance)
+
+std::atomic<bool> KisTraceRecorder::s_enabled {false};
+
+namespace {
+/**
+ * The number of events every thread can keep. With 32 bytes per event
+ * it gives us 1 MiB per thread, which is enough for about 10-20 seconds
+ * of painting with all the markers active.
+ */
+const int ringBufferSize = 32768;
+
+struct TraceEvent {
+    const char *category = nullptr;
+    const char *name = nullptr;
+    qint64 start = 0; // ns
+    qint64 duration = -1; // ns, -1 for instant events
+};
+}
+
+struct KisTraceRecorder::ThreadBuffer
+{
+    ThreadBuffer(int _threadId, const QString &_threadName)
+        : threadId(_threadId),
+          threadName(_threadName)
+    {
+    }
+
+    void addEvent(const TraceEvent &event) {
+        /**
+         * The lock is almost never contended: only the owner thread
+         * writes into the buffer and the readers access it only when
+         * saving the trace.
+         */
+        QMutexLocker l(&mutex);
+
+        // the memory is allocated only when the thread records something
+        if (events.isEmpty()) {
+            events.resize(ringBufferSize);
+        }
+
+        events[nextIndex] = event;
+        nextIndex = (nextIndex + 1) % events.size();
+        numEvents = qMin(numEvents + 1, events.size());
+    }
+
+    template <typename Func>
+    void forEachEvent(Func func) const {
+        QMutexLocker l(&mutex);
+        if (!numEvents) return;
+
+        const int firstIndex = (nextIndex - numEvents + events.size()) % events.size();
+        for (int i = 0; i < numEvents; i++) {
+            func(events[(firstIndex + i) % events.size()]);
+        }
+    }
+
+    /**
+     * Drop all the events and free the memory of the buffer
+     */
+    void clear() {
+        QMutexLocker l(&mutex);
+        events = QVector<TraceEvent>();
+        nextIndex = 0;
+        numEvents = 0;
+    }
+
+    int size() const {
+        QMutexLocker l(&mutex);
+        return numEvents;
+    }
+
+    qint64 memoryUsage() const {
+        QMutexLocker l(&mutex);
+        return qint64(events.size()) * sizeof(TraceEvent);
+    }
+
+    // the fields below are protected by KisTraceRecorder::Private::buffersLock
+    int threadId;
+    QString threadName;
+    bool threadExited = false;
+
+private:
+    mutable QMutex mutex;
+    QVector<TraceEvent> events;
+    int nextIndex = 0;
+    int numEvents = 0;
+};
+
+struct KisTraceRecorder::Private
+{
+    QElapsedTimer timer;
+
+    QMutex buffersLock;
+    QVector<QSharedPointer<ThreadBuffer>> buffers;
+    int nextThreadId = 0;
+};
+
+/**
+ * Releases the buffer of the thread when the thread exits
+ */
+struct KisTraceRecorder::ThreadBufferHandle
+{
+    ~ThreadBufferHandle() {
+        if (buffer && !s_instance.isDestroyed()) {
+            s_instance->releaseThreadBuffer(buffer);
+        }
+    }
+
+    ThreadBuffer *buffer = nullptr;
+};
+
+KisTraceRecorder::KisTraceRecorder()
+    : m_d(new Private)
+{
+    m_d->timer.start();
+}
+
+KisTraceRecorder::~KisTraceRecorder()
+{
+}
+
+KisTraceRecorder *KisTraceRecorder::instance()
+{
+    return s_instance;
+}
+
+void KisTraceRecorder::setEnabled(bool value)
+{
+    if (value && !isEnabled()) {
+        clear();
+    }
+
+    s_enabled.store(value, std::memory_order_relaxed);
+}
+
+qint64 KisTraceRecorder::timestamp() const
+{
+    return m_d->timer.nsecsElapsed();
+}
+
+KisTraceRecorder::ThreadBuffer *KisTraceRecorder::currentThreadBuffer()
+{
+    /**
+     * The buffers are owned by the recorder, so the events recorded
+     * by the threads that have already exited are still available
+     * for saving. Such buffers are either taken over by new threads
+     * or freed by clear().
+     */
+    static thread_local ThreadBufferHandle handle;
+
+    if (!handle.buffer) {
+        QMutexLocker l(&m_d->buffersLock);
+
+        const int threadId = m_d->nextThreadId++;
+
+        QString threadName = QThread::currentThread()->objectName();
+        if (threadName.isEmpty()) {
+            threadName = QString("Thread %1").arg(threadId);
+        }
+
+        auto it = std::find_if(m_d->buffers.begin(), m_d->buffers.end(),
+                               [] (QSharedPointer<ThreadBuffer> buffer) {
+                                   return buffer->threadExited;
+                               });
+
+        if (it != m_d->buffers.end()) {
+            handle.buffer = it->data();
+            handle.buffer->clear();
+            handle.buffer->threadId = threadId;
+            handle.buffer->threadName = threadName;
+            handle.buffer->threadExited = false;
+        } else {
+            QSharedPointer<ThreadBuffer> newBuffer(new ThreadBuffer(threadId, threadName));
+            m_d->buffers.append(newBuffer);
+            handle.buffer = newBuffer.data();
+        }
+    }
+
+    return handle.buffer;
+}
+
+void KisTraceRecorder::releaseThreadBuffer(ThreadBuffer *buffer)
+{
+    QMutexLocker l(&m_d->buffersLock);
+    buffer->threadExited = true;
+}
+
+void KisTraceRecorder::addCompleteEvent(const char *category, const char *name, qint64 start)
+{
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.start = start;
+    event.duration = timestamp() - start;
+
+    currentThreadBuffer()->addEvent(event);
+}
+
+void KisTraceRecorder::addInstantEvent(const char *category, const char *name)
+{
+    TraceEvent event;
+    event.category = category;
+    event.name = name;
+    event.start = timestamp();
+
+    currentThreadBuffer()->addEvent(event);
+}
+
+void KisTraceRecorder::clear()
+{
+    QMutexLocker l(&m_d->buffersLock);
+
+    /**
+     * The buffers of the running threads are referenced by the threads
+     * themselves, so only their memory is freed
+     */
+    for (auto it = m_d->buffers.begin(); it != m_d->buffers.end();) {
+        if ((*it)->threadExited) {
+            it = m_d->buffers.erase(it);
+        } else {
+            (*it)->clear();
+            ++it;
+        }
+    }
+}
+
+int KisTraceRecorder::numEvents() const
+{
+    QMutexLocker l(&m_d->buffersLock);
+
+    int result = 0;
+
+    Q_FOREACH (QSharedPointer<ThreadBuffer> buffer, m_d->buffers) {
+        result += buffer->size();
+    }
+
+    return result;
+}
+
+qint64 KisTraceRecorder::memoryUsage() const
+{
+    QMutexLocker l(&m_d->buffersLock);
+
+    qint64 result = 0;
+
+    Q_FOREACH (QSharedPointer<ThreadBuffer> buffer, m_d->buffers) {
+        result += buffer->memoryUsage();
+    }
+
+    return result;
+}
+
+bool KisTraceRecorder::writeChromeTrace(QIODevice *device) const
+{
+    QJsonArray traceEvents;
+
+    {
+        QMutexLocker l(&m_d->buffersLock);
+
+        Q_FOREACH (QSharedPointer<ThreadBuffer> buffer, m_d->buffers) {
+            QJsonObject threadNameEvent;
+            threadNameEvent["name"] = "thread_name";
+            threadNameEvent["ph"] = "M";
+            threadNameEvent["pid"] = 1;
+            threadNameEvent["tid"] = buffer->threadId;
+            threadNameEvent["args"] = QJsonObject({{"name", buffer->threadName}});
+            traceEvents.append(threadNameEvent);
+
+            buffer->forEachEvent([&traceEvents, buffer] (const TraceEvent &event) {
+                QJsonObject object;
+                object["name"] = QString::fromLatin1(event.name);
+                object["cat"] = QString::fromLatin1(event.category);
+                object["pid"] = 1;
+                object["tid"] = buffer->threadId;
+                object["ts"] = qreal(event.start) / 1000.0;
+
+                if (event.duration >= 0) {
+                    object["ph"] = "X";
+                    object["dur"] = qreal(event.duration) / 1000.0;
+                } else {
+                    object["ph"] = "i";
+                    object["s"] = "t";
+                }
+
+                traceEvents.append(object);
+            });
+        }
+    }
+
+    QJsonObject root;
+    root["traceEvents"] = traceEvents;
+    root["displayTimeUnit"] = "ms";
+
+    const QByteArray data = QJsonDocument(root).toJson(QJsonDocument::Compact);
+    return device->write(data) == data.size();
+}
+
+bool KisTraceRecorder::saveChromeTrace(const QString &fileName) const
+{
+    QSaveFile file(fileName);
+    if (!file.open(QFile::WriteOnly)) {
+        warnKrita << "KisTraceRecorder: failed to open trace file" << fileName << file.errorString();
+        return false;
+    }
+
+    if (!writeChromeTrace(&file)) {
+        warnKrita << "KisTraceRecorder: failed to write trace file" << fileName << file.errorString();
+        file.cancelWriting();
+        return false;
+    }
+
+    if (!file.commit()) {
+        warnKrita << "KisTraceRecorder: failed to save trace file" << fileName << file.errorString();
+        return false;
+    }
+
+    return true;
+}
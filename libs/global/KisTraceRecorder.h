@@ -0,0 +1,166 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTRACERECORDER_H
+#define KISTRACERECORDER_H
+
+#include "kritaglobal_export.h"
+
+#include <atomic>
+
+#include <QtGlobal>
+#include <QScopedPointer>
+
+class QIODevice;
+class QString;
+
+/**
+ * KisTraceRecorder is a low-overhead recorder of timed events that
+ * can be used for profiling the application in production, without
+ * attaching a debugger or a profiler.
+ *
+ * Every thread writes its events into its own ring buffer, so the
+ * recording itself never contends with other threads. When the buffer
+ * is full, the oldest events are overwritten. The recorded events can
+ * be saved in the Chrome Trace Event format, which can be opened in
+ * chrome://tracing or https://ui.perfetto.dev.
+ *
+ * When the recorder is disabled (which is the default), every marker
+ * costs just one relaxed atomic load.
+ *
+ * Usage:
+ *
+ * \code{.cpp}
+ * void KisSomeClass::someHeavyMethod()
+ * {
+ *     KIS_TRACE_SCOPE("image", "KisSomeClass::someHeavyMethod");
+ *     ...
+ * }
+ * \endcode
+ *
+ * NOTE: both \p category and \p name must be string literals (or any
+ *       other strings with static storage duration), the recorder
+ *       stores only the pointers to them.
+ */
+class KRITAGLOBAL_EXPORT KisTraceRecorder
+{
+public:
+    KisTraceRecorder();
+    ~KisTraceRecorder();
+
+    static KisTraceRecorder* instance();
+
+    static inline bool isEnabled() {
+        return s_enabled.load(std::memory_order_relaxed);
+    }
+
+    /**
+     * Start or stop recording. Starting the recording
+     * drops all the previously recorded events.
+     */
+    void setEnabled(bool value);
+
+    /**
+     * @return current time in nanoseconds in the recorder's time frame
+     */
+    qint64 timestamp() const;
+
+    /**
+     * Register an event that started at \p start and ends right now
+     */
+    void addCompleteEvent(const char *category, const char *name, qint64 start);
+
+    /**
+     * Register a zero-length event that happens right now
+     */
+    void addInstantEvent(const char *category, const char *name);
+
+    /**
+     * Remove all the recorded events and free the memory of the
+     * buffers. The buffers of the exited threads are deleted.
+     */
+    void clear();
+
+    /**
+     * @return the number of events currently stored in all the buffers
+     */
+    int numEvents() const;
+
+    /**
+     * @return the memory allocated for the buffers in bytes
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * Write all the recorded events into \p device in Chrome
+     * Trace Event JSON format
+     *
+     * @return false if the data could not be written completely
+     */
+    bool writeChromeTrace(QIODevice *device) const;
+
+    /**
+     * Save all the recorded events into \p fileName in Chrome Trace
+     * Event JSON format. The file is replaced only if the trace has
+     * been written successfully.
+     *
+     * @return false if the file could not be written
+     */
+    bool saveChromeTrace(const QString &fileName) const;
+
+private:
+    static std::atomic<bool> s_enabled;
+
+    struct ThreadBuffer;
+    struct ThreadBufferHandle;
+    ThreadBuffer* currentThreadBuffer();
+    void releaseThreadBuffer(ThreadBuffer *buffer);
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+/**
+ * A RAII marker that records the time spent in the current scope
+ */
+class KisTraceScope
+{
+public:
+    inline KisTraceScope(const char *category, const char *name)
+        : m_category(category),
+          m_name(name),
+          m_start(KisTraceRecorder::isEnabled() ? KisTraceRecorder::instance()->timestamp() : -1)
+    {
+    }
+
+    inline ~KisTraceScope() {
+        if (m_start >= 0) {
+            KisTraceRecorder::instance()->addCompleteEvent(m_category, m_name, m_start);
+        }
+    }
+
+private:
+    Q_DISABLE_COPY(KisTraceScope)
+
+    const char *m_category;
+    const char *m_name;
+    const qint64 m_start;
+};
+
+#define KIS_TRACE_CONCAT_IMPL(a, b) a##b
+#define KIS_TRACE_CONCAT(a, b) KIS_TRACE_CONCAT_IMPL(a, b)
+
+#define KIS_TRACE_SCOPE(category, name) \
+    KisTraceScope KIS_TRACE_CONCAT(kisTraceScope_, __LINE__)(category, name)
+
+#define KIS_TRACE_INSTANT(category, name) \
+    do { \
+        if (KisTraceRecorder::isEnabled()) { \
+            KisTraceRecorder::instance()->addInstantEvent(category, name); \
+        } \
+    } while (0)
+
+#endif // KISTRACERECORDER_H
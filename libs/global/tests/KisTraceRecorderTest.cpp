@@ -0,0 +1,136 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisTraceRecorderTest.h"
+
+#include "simpletest.h"
+
+#include <QBuffer>
+#include <QJsonArray>
+#include <QJsonDocument>
+#include <QJsonObject>
+
+#include <thread>
+
+#include "KisTraceRecorder.h"
+
+void KisTraceRecorderTest::testDisabled()
+{
+    KisTraceRecorder::instance()->setEnabled(false);
+    KisTraceRecorder::instance()->clear();
+
+    {
+        KIS_TRACE_SCOPE("test", "disabledScope");
+        KIS_TRACE_INSTANT("test", "disabledInstant");
+    }
+
+    QCOMPARE(KisTraceRecorder::instance()->numEvents(), 0);
+}
+
+void KisTraceRecorderTest::testScopedMarkers()
+{
+    KisTraceRecorder::instance()->setEnabled(true);
+
+    {
+        KIS_TRACE_SCOPE("test", "outerScope");
+        KIS_TRACE_SCOPE("test", "innerScope");
+        KIS_TRACE_INSTANT("test", "instant");
+    }
+
+    KisTraceRecorder::instance()->setEnabled(false);
+
+    QCOMPARE(KisTraceRecorder::instance()->numEvents(), 3);
+
+    QBuffer buffer;
+    buffer.open(QBuffer::WriteOnly);
+    KisTraceRecorder::instance()->writeChromeTrace(&buffer);
+
+    const QJsonDocument doc = QJsonDocument::fromJson(buffer.data());
+    QVERIFY(doc.isObject());
+
+    QStringList completeEvents;
+    QStringList instantEvents;
+
+    Q_FOREACH (const QJsonValue &value, doc.object()["traceEvents"].toArray()) {
+        const QJsonObject event = value.toObject();
+
+        if (event["ph"].toString() == "X") {
+            QCOMPARE(event["cat"].toString(), QString("test"));
+            QVERIFY(event["dur"].toDouble() >= 0.0);
+            completeEvents << event["name"].toString();
+        } else if (event["ph"].toString() == "i") {
+            instantEvents << event["name"].toString();
+        }
+    }
+
+    // scopes are recorded in the order they are closed
+    QCOMPARE(completeEvents, QStringList({"innerScope", "outerScope"}));
+    QCOMPARE(instantEvents, QStringList({"instant"}));
+}
+
+void KisTraceRecorderTest::testRingBufferOverflow()
+{
+    KisTraceRecorder::instance()->setEnabled(true);
+
+    for (int i = 0; i < 100000; i++) {
+        KIS_TRACE_INSTANT("test", "instant");
+    }
+
+    KisTraceRecorder::instance()->setEnabled(false);
+
+    const int numEvents = KisTraceRecorder::instance()->numEvents();
+    QVERIFY(numEvents > 0);
+    QVERIFY(numEvents < 100000);
+}
+
+void KisTraceRecorderTest::testExitedThreadBuffers()
+{
+    KisTraceRecorder *recorder = KisTraceRecorder::instance();
+
+    recorder->setEnabled(true);
+
+    // join() waits for the thread-local storage of the thread to be destroyed
+    auto recordInThread = [] () {
+        std::thread thread([] () {
+            KIS_TRACE_INSTANT("test", "threadInstant");
+        });
+        thread.join();
+    };
+
+    recordInThread();
+
+    // the events of the exited thread are still available for saving
+    QCOMPARE(recorder->numEvents(), 1);
+    const qint64 memoryUsage = recorder->memoryUsage();
+    QVERIFY(memoryUsage > 0);
+
+    // the buffer of the exited thread is reused by the next one
+    recordInThread();
+    QCOMPARE(recorder->numEvents(), 1);
+    QCOMPARE(recorder->memoryUsage(), memoryUsage);
+
+    recorder->setEnabled(false);
+    recorder->clear();
+
+    QCOMPARE(recorder->numEvents(), 0);
+    QCOMPARE(recorder->memoryUsage(), 0);
+}
+
+void KisTraceRecorderTest::testSaveFailure()
+{
+    KisTraceRecorder::instance()->setEnabled(true);
+    KIS_TRACE_INSTANT("test", "instant");
+    KisTraceRecorder::instance()->setEnabled(false);
+
+    QVERIFY(!KisTraceRecorder::instance()->saveChromeTrace("/nonexistent-directory/trace.json"));
+
+    QBuffer buffer;
+    QVERIFY(!KisTraceRecorder::instance()->writeChromeTrace(&buffer));
+
+    KisTraceRecorder::instance()->clear();
+}
+
+SIMPLE_TEST_MAIN(KisTraceRecorderTest)
@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISTRACERECORDERTEST_H
+#define KISTRACERECORDERTEST_H
+
+#include <QObject>
+
+class KisTraceRecorderTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testDisabled();
+    void testScopedMarkers();
+    void testRingBufferOverflow();
+    void testExitedThreadBuffers();
+    void testSaveFailure();
+};
+
+#endif // KISTRACERECORDERTEST_H
@@ -8,6 +8,7 @@
 #define KISCOLORSELECTIONPOLICIES
 
 #include <QStack>
+#include <QVector>
 
 #include <KoAlwaysInline.h>
 #include <KoColor.h>
@@ -28,6 +29,10 @@ public:
         , m_threshold(threshold)
     {}
 
+    SlowDifferencePolicy(const SlowDifferencePolicy &rhs)
+        : SlowDifferencePolicy(rhs.m_referenceColor, rhs.m_threshold)
+    {}
+
     ALWAYS_INLINE quint8 difference(const quint8 *colorPtr) const
     {
         if (m_threshold == 1) {
@@ -43,6 +48,24 @@ public:
         }
     }
 
+    /**
+     * Calculates the differences of \p numPixels consequent pixels
+     * in one go, which is much faster for the color spaces that have
+     * to convert the pixels to compare them
+     */
+    void differences(const quint8 *colorPtr, quint8 *differences, int numPixels) const
+    {
+        if (m_threshold == 1) {
+            const int pixelSize = m_colorSpace->pixelSize();
+
+            for (int i = 0; i < numPixels; i++) {
+                differences[i] = difference(colorPtr + i * pixelSize);
+            }
+        } else {
+            m_colorSpace->differencesA(m_referenceColorPtr, colorPtr, differences, numPixels);
+        }
+    }
+
 protected:
     const KoColorSpace *m_colorSpace;
     KoColor m_referenceColor;
@@ -77,11 +100,48 @@ public:
         return result;
     }
 
+    void differences(const quint8 *colorPtr, quint8 *differences, int numPixels) const
+    {
+        const HashKeyType *pixels = reinterpret_cast<const HashKeyType*>(colorPtr);
+
+        m_missingPixels.clear();
+        m_missingIndexes.clear();
+
+        for (int i = 0; i < numPixels; i++) {
+            typename HashType::const_iterator it = m_differences.constFind(pixels[i]);
+
+            if (it != m_differences.constEnd()) {
+                differences[i] = *it;
+            } else {
+                m_missingPixels.append(pixels[i]);
+                m_missingIndexes.append(i);
+            }
+        }
+
+        if (m_missingPixels.isEmpty()) return;
+
+        // the pixels missing in the cache are compared in one batch
+        m_missingDifferences.resize(m_missingPixels.size());
+        SlowDifferencePolicy::differences(reinterpret_cast<const quint8*>(m_missingPixels.constData()),
+                                          m_missingDifferences.data(),
+                                          m_missingPixels.size());
+
+        for (int i = 0; i < m_missingPixels.size(); i++) {
+            differences[m_missingIndexes[i]] = m_missingDifferences[i];
+            m_differences.insert(m_missingPixels[i], m_missingDifferences[i]);
+        }
+    }
+
 protected:
     using HashKeyType = SrcPixelType;
     using HashType = QHash<HashKeyType, quint8>;
 
     mutable HashType m_differences;
+
+private:
+    mutable QVector<HashKeyType> m_missingPixels;
+    mutable QVector<int> m_missingIndexes;
+    mutable QVector<quint8> m_missingDifferences;
 };
 
 class SlowColorOrTransparentDifferencePolicy : public SlowDifferencePolicy
@@ -106,6 +166,9 @@ public:
             return qMin(colorDifference, opacityDifference);
         }
     }
+
+    // the batched version would use the base class' difference
+    void differences(const quint8 *colorPtr, quint8 *differences, int numPixels) const = delete;
 };
 
 template <typename SrcPixelType>
@@ -136,6 +199,9 @@ public:
         return result;
     }
 
+    // the batched version would use the base class' difference
+    void differences(const quint8 *colorPtr, quint8 *differences, int numPixels) const = delete;
+
 protected:
     using HashKeyType = typename OptimizedDifferencePolicy<SrcPixelType>::HashKeyType;
     using HashType = typename OptimizedDifferencePolicy<SrcPixelType>::HashType;
@@ -989,6 +989,10 @@ void KisEncloseAndFillPainter::Private::selectRegionsFromContour(KisPixelSelecti
     const QRect inclusionRect = q->device()->defaultBounds()->wrapAroundMode()
                                 ? enclosingMaskRect
                                 : imageRect;
+    // The fills of all the contour points share the same reference device
+    // and boundary, so the regions found by one of them can be reused by
+    // the others
+    KisFillRegionLabelMapSP regionLabelMap = new KisFillRegionLabelMap;
     // Here we just fill all the areas from the border towards inside
     for (const QPoint &point : enclosingPoints) {
         if (!inclusionRect.contains(point)) {
@@ -1003,6 +1007,7 @@ void KisEncloseAndFillPainter::Private::selectRegionsFromContour(KisPixelSelecti
         gc.setThreshold(q->fillThreshold());
         gc.setOpacitySpread(q->opacitySpread());
         gc.setCloseGap(q->closeGap());
+        gc.setRegionLabelMap(regionLabelMap);
         // Use the enclosing mask as boundary so that we don't fill
         // potentially large regions on the outside
         gc.fillSelection(mask, enclosingMask);
@@ -1033,6 +1038,7 @@ void KisEncloseAndFillPainter::Private::selectRegionsFromContourUntilColor(KisPi
     const QRect inclusionRect = q->device()->defaultBounds()->wrapAroundMode()
                                 ? enclosingMaskRect
                                 : imageRect;
+    KisFillRegionLabelMapSP regionLabelMap = new KisFillRegionLabelMap;
     // Here we just fill all the areas from the border towards inside until the specific color
     for (const QPoint &point : enclosingPoints) {
         if (!inclusionRect.contains(point)) {
@@ -1047,6 +1053,7 @@ void KisEncloseAndFillPainter::Private::selectRegionsFromContourUntilColor(KisPi
         gc.setThreshold(q->fillThreshold());
         gc.setOpacitySpread(q->opacitySpread());
         gc.setCloseGap(q->closeGap());
+        gc.setRegionLabelMap(regionLabelMap);
         // Use the enclosing mask as boundary so that we don't fill
         // potentially large regions in the outside
         gc.fillSelectionUntilColor(mask, color, enclosingMask);
@@ -1077,6 +1084,7 @@ void KisEncloseAndFillPainter::Private::selectRegionsFromContourUntilColorOrTran
     const QRect inclusionRect = q->device()->defaultBounds()->wrapAroundMode()
                                 ? enclosingMaskRect
                                 : imageRect;
+    KisFillRegionLabelMapSP regionLabelMap = new KisFillRegionLabelMap;
     // Here we just fill all the areas from the border towards inside until the specific color
     for (const QPoint &point : enclosingPoints) {
         if (!inclusionRect.contains(point)) {
@@ -1091,6 +1099,7 @@ void KisEncloseAndFillPainter::Private::selectRegionsFromContourUntilColorOrTran
         gc.setThreshold(q->fillThreshold());
         gc.setOpacitySpread(q->opacitySpread());
         gc.setCloseGap(q->closeGap());
+        gc.setRegionLabelMap(regionLabelMap);
         // Use the enclosing mask as boundary so that we don't fill
         // potentially large regions in the outside
         gc.fillSelectionUntilColorOrTransparent(mask, color, enclosingMask);
@@ -0,0 +1,274 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisFilterResultCache.h"
+
+#include <atomic>
+
+#include <QGlobalStatic>
+#include <QRect>
+#include <QRegion>
+#include <QReadWriteLock>
+
+#include <KoColorSpace.h>
+
+#include "kis_image_config.h"
+#include "KisImageConfigNotifier.h"
+#include "kis_paint_device.h"
+#include "kis_painter.h"
+#include "kis_default_bounds_base.h"
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+
+namespace {
+
+/// the memory used by all the caches together
+std::atomic<qint64> s_totalMemoryUsage {0};
+
+/**
+ * The budget is read from the config only when it changes, not on
+ * every update of the filter nodes
+ */
+struct MemoryBudget
+{
+    MemoryBudget() {
+        load();
+        connection = QObject::connect(KisImageConfigNotifier::instance(),
+                                      &KisImageConfigNotifier::configChanged,
+                                      [this] () { load(); });
+    }
+
+    ~MemoryBudget() {
+        QObject::disconnect(connection);
+    }
+
+    void load() {
+        /**
+         * The cached devices are stored in the tiles engine, so the caches
+         * may take a quarter of the memory the images can use before the
+         * swapping starts
+         */
+        KisImageConfig cfg(true);
+        value = (qint64(cfg.tilesSoftLimit()) << 20) / 4;
+    }
+
+    std::atomic<qint64> value {0};
+    QMetaObject::Connection connection;
+};
+
+Q_GLOBAL_STATIC(MemoryBudget, s_memoryBudget)
+
+inline bool regionContains(const QRegion &region, const QRect &rect)
+{
+    return (QRegion(rect) - region).isEmpty();
+}
+
+inline qint64 regionArea(const QRegion &region)
+{
+    qint64 area = 0;
+
+    Q_FOREACH (const QRect &rc, region.rects()) {
+        area += qint64(rc.width()) * rc.height();
+    }
+
+    return area;
+}
+
+}
+
+struct KisFilterResultCache::Private
+{
+    mutable QReadWriteLock lock;
+
+    KisFilterConfigurationSP config;
+    const KoColorSpace *srcColorSpace = nullptr;
+    const KoColorSpace *dstColorSpace = nullptr;
+
+    /// the filters may depend on the image bounds, e.g. in the wrap-around mode
+    QRect bounds;
+    bool wrapAroundMode = false;
+
+    KisPaintDeviceSP result;
+    QRegion resultRegion;
+
+    /// the part of s_totalMemoryUsage accounted for this cache
+    qint64 accountedSize = 0;
+
+    std::atomic<int> numHits {0};
+    std::atomic<int> numMisses {0};
+
+    bool isCompatible(KisFilterConfigurationSP _config, KisPaintDeviceSP src, KisPaintDeviceSP dst) const {
+        return result &&
+            config == _config &&
+            *srcColorSpace == *src->colorSpace() &&
+            *dstColorSpace == *dst->colorSpace() &&
+            bounds == src->defaultBounds()->bounds() &&
+            wrapAroundMode == src->defaultBounds()->wrapAroundMode();
+    }
+
+    void reset(KisFilterConfigurationSP _config, KisPaintDeviceSP src, KisPaintDeviceSP dst) {
+        config = _config;
+        srcColorSpace = src->colorSpace();
+        dstColorSpace = dst->colorSpace();
+        bounds = src->defaultBounds()->bounds();
+        wrapAroundMode = src->defaultBounds()->wrapAroundMode();
+
+        result = new KisPaintDevice(dstColorSpace);
+        result->prepareClone(dst);
+        resultRegion = QRegion();
+
+        updateAccountedSize();
+    }
+
+    void clear() {
+        config = 0;
+        srcColorSpace = nullptr;
+        dstColorSpace = nullptr;
+        result = 0;
+        resultRegion = QRegion();
+
+        updateAccountedSize();
+    }
+
+    qint64 estimatedSize(const QRegion &_resultRegion) const {
+        return result ? regionArea(_resultRegion) * result->pixelSize() : 0;
+    }
+
+    /**
+     * @return true if the cache may grow to \p newSize without exceeding
+     *         the budget shared by all the caches
+     */
+    bool fitsIntoBudget(qint64 newSize) const {
+        return s_totalMemoryUsage - accountedSize + newSize <= KisFilterResultCache::memoryBudget();
+    }
+
+    void updateAccountedSize() {
+        const qint64 size = estimatedSize(resultRegion);
+        s_totalMemoryUsage += size - accountedSize;
+        accountedSize = size;
+    }
+};
+
+KisFilterResultCache::KisFilterResultCache()
+    : m_d(new Private)
+{
+}
+
+KisFilterResultCache::~KisFilterResultCache()
+{
+    m_d->clear();
+}
+
+void KisFilterResultCache::process(KisFilterSP filter,
+                                   KisFilterConfigurationSP config,
+                                   KisPaintDeviceSP src,
+                                   KisPaintDeviceSP dst,
+                                   const QRect &applyRect,
+                                   bool sourceChanged)
+{
+    KIS_SAFE_ASSERT_RECOVER_NOOP(src != dst);
+
+    const int lod = src->defaultBounds()->currentLevelOfDetail();
+    const QRect needRect = filter->neededRect(applyRect, config, lod);
+
+    /**
+     * Level-of-detail updates are short-living, caching them would
+     * only push the results of the normal updates out of the cache.
+     * And the filters that read only the pixels they write are
+     * cheaper to run than to copy their results around.
+     */
+    if (lod > 0 || needRect == applyRect) {
+        filter->process(src, dst, 0, applyRect, config, 0);
+        return;
+    }
+
+    if (sourceChanged) {
+        {
+            QWriteLocker l(&m_d->lock);
+
+            if (m_d->result) {
+                m_d->resultRegion -= filter->changedRect(needRect, config, lod);
+                m_d->updateAccountedSize();
+            }
+        }
+
+        /**
+         * The source is changing, e.g. the user paints under the
+         * filter, so the result will most probably be invalidated
+         * by the next update as well. Don't copy it into the cache.
+         */
+        m_d->numMisses++;
+        filter->process(src, dst, 0, applyRect, config, 0);
+        return;
+    }
+
+    {
+        QReadLocker l(&m_d->lock);
+
+        if (m_d->isCompatible(config, src, dst) &&
+            regionContains(m_d->resultRegion, applyRect)) {
+
+            KisPainter::copyAreaOptimized(applyRect.topLeft(), m_d->result, dst, applyRect);
+            m_d->numHits++;
+            return;
+        }
+    }
+
+    m_d->numMisses++;
+    filter->process(src, dst, 0, applyRect, config, 0);
+
+    QWriteLocker l(&m_d->lock);
+
+    if (!m_d->isCompatible(config, src, dst)) {
+        m_d->reset(config, src, dst);
+    }
+
+    if (!m_d->fitsIntoBudget(m_d->estimatedSize(m_d->resultRegion | applyRect))) {
+        m_d->reset(config, src, dst);
+
+        if (!m_d->fitsIntoBudget(m_d->estimatedSize(applyRect))) {
+            m_d->clear();
+            return;
+        }
+    }
+
+    KisPainter::copyAreaOptimized(applyRect.topLeft(), dst, m_d->result, applyRect);
+    m_d->resultRegion |= applyRect;
+
+    m_d->updateAccountedSize();
+}
+
+void KisFilterResultCache::invalidate()
+{
+    QWriteLocker l(&m_d->lock);
+    m_d->clear();
+}
+
+qint64 KisFilterResultCache::memoryUsage() const
+{
+    QReadLocker l(&m_d->lock);
+    return m_d->estimatedSize(m_d->resultRegion);
+}
+
+qint64 KisFilterResultCache::totalMemoryUsage()
+{
+    return s_totalMemoryUsage;
+}
+
+qint64 KisFilterResultCache::memoryBudget()
+{
+    return s_memoryBudget->value;
+}
+
+int KisFilterResultCache::numHits() const
+{
+    return m_d->numHits;
+}
+
+int KisFilterResultCache::numMisses() const
+{
+    return m_d->numMisses;
+}
@@ -0,0 +1,98 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISFILTERRESULTCACHE_H
+#define KISFILTERRESULTCACHE_H
+
+#include <QScopedPointer>
+
+#include "kritaimage_export.h"
+#include "kis_types.h"
+
+class QRect;
+
+/**
+ * A cache of the results of the filter of a filter mask or an
+ * adjustment layer.
+ *
+ * Projection updates often reach the filter node when its input has
+ * not changed at all: painting on the selection of the mask, changing
+ * masks above it or the opacity of the node. The cache keeps a copy
+ * of the filtered pixels, so such updates copy the result from the
+ * cache instead of running the filter again.
+ *
+ * The cache doesn't compare the source pixels, it relies on the update
+ * walkers instead: every update that may have changed the source of the
+ * filter should be passed with \p sourceChanged set. Changing the filter
+ * configuration or the color space must be reported with invalidate().
+ *
+ * Only the filters that read a bigger area than they write are cached.
+ * Per-pixel adjustments, like levels or curves, are cheaper to run again
+ * than to copy from the cache.
+ *
+ * The cache is also reset when the bounds of the image change. It is
+ * not used for level-of-detail updates, and it stops growing when the
+ * estimated size of all the caches together exceeds memoryBudget().
+ *
+ * The class is thread-safe: the filter node may be updated by several
+ * threads at once. The updates of the overlapping areas are serialized
+ * by the update scheduler.
+ */
+class KRITAIMAGE_EXPORT KisFilterResultCache
+{
+public:
+    KisFilterResultCache();
+    ~KisFilterResultCache();
+
+    /**
+     * Filter \p applyRect of \p src into \p dst using \p filter with
+     * \p config, or copy the result from the cache if possible. The
+     * devices must be different.
+     *
+     * If \p sourceChanged is true, the pixels of \p src the filter
+     * reads for \p applyRect may differ from the ones the cached
+     * results were calculated from. The affected results are dropped
+     * and the filter is run directly.
+     */
+    void process(KisFilterSP filter,
+                 KisFilterConfigurationSP config,
+                 KisPaintDeviceSP src,
+                 KisPaintDeviceSP dst,
+                 const QRect &applyRect,
+                 bool sourceChanged);
+
+    /**
+     * Drop all the cached data
+     */
+    void invalidate();
+
+    /**
+     * @return the estimated amount of memory used by the cache in bytes
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @return the estimated amount of memory used by all the caches in bytes
+     */
+    static qint64 totalMemoryUsage();
+
+    /**
+     * @return the maximum amount of memory all the caches may use
+     *         together, a part of the soft tiles memory limit
+     *         set in KisImageConfig. The value is updated when the
+     *         image config changes.
+     */
+    static qint64 memoryBudget();
+
+    int numHits() const;
+    int numMisses() const;
+
+private:
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISFILTERRESULTCACHE_H
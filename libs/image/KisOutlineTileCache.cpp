@@ -0,0 +1,457 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisOutlineTileCache.h"
+
+#include <QHash>
+
+#include <kis_global.h>
+#include <kis_algebra_2d.h>
+#include <kis_paint_device.h>
+#include <kis_random_accessor_ng.h>
+
+#include "krita_utils.h"
+
+namespace {
+
+/**
+ * The contours go along the borders of the pixels, from one pixel corner
+ * to another, with the selected pixels on the left side (in the image
+ * coordinates, where Y axis points downwards). The directions are ordered
+ * clockwise, so (direction + 1) % 4 is a right turn.
+ */
+enum Direction {
+    East = 0,
+    South,
+    West,
+    North
+};
+
+const QPoint directionOffsets[4] = {
+    QPoint(1, 0), QPoint(0, 1), QPoint(-1, 0), QPoint(0, -1)
+};
+
+/**
+ * The offset from the starting corner of an edge to the pixel on its
+ * left side. The pixel on the right side of the edge going in direction
+ * \p d is the one on the left side of the edge going in direction
+ * (d + 1) % 4.
+ */
+const QPoint leftPixelOffsets[4] = {
+    QPoint(0, -1), QPoint(0, 0), QPoint(-1, 0), QPoint(-1, -1)
+};
+
+struct EdgeKey {
+    QPoint vertex;
+    int direction = East;
+
+    bool operator==(const EdgeKey &rhs) const {
+        return vertex == rhs.vertex && direction == rhs.direction;
+    }
+};
+
+inline uint qHash(const EdgeKey &key, uint seed = 0)
+{
+    return ::qHash((quint64(quint32(key.vertex.x())) << 32) | quint32(key.vertex.y()), seed) ^
+        uint(key.direction);
+}
+
+/**
+ * A piece of a contour lying in a single tile (or, after linking,
+ * in several tiles). The fragment ends where the next edge of the
+ * contour belongs to another tile.
+ */
+struct Fragment {
+    /// the start and the end vertices of the fragment and the corners in between
+    QPolygon points;
+    /// the first edge of the fragment
+    EdgeKey first;
+    /// the edge following the last edge of the fragment
+    EdgeKey next;
+    int lastDirection = East;
+};
+
+struct Tile {
+    QVector<QPolygon> loops;
+    QVector<Fragment> fragments;
+};
+
+void appendFragment(Fragment *chain, const Fragment &fragment)
+{
+    // the junction vertex is present in both the fragments
+    chain->points.removeLast();
+
+    const bool isCollinear = chain->lastDirection == fragment.first.direction;
+    chain->points.reserve(chain->points.size() + fragment.points.size());
+
+    for (int i = isCollinear ? 1 : 0; i < fragment.points.size(); i++) {
+        chain->points << fragment.points[i];
+    }
+
+    chain->next = fragment.next;
+    chain->lastDirection = fragment.lastDirection;
+}
+
+QPolygon closeChain(Fragment chain)
+{
+    // the last vertex repeats the first one
+    chain.points.removeLast();
+
+    if (chain.lastDirection == chain.first.direction) {
+        chain.points.removeFirst();
+    }
+
+    return chain.points;
+}
+
+/**
+ * Links the fragments whose ends match each other. The fragments forming
+ * closed contours are written into \p loops, the rest of the fragments are
+ * merged into the longest possible chains and written into \p chains.
+ */
+void linkFragments(const QVector<Fragment> &fragments, QVector<QPolygon> *loops, QVector<Fragment> *chains)
+{
+    if (fragments.isEmpty()) return;
+
+    QHash<EdgeKey, int> fragmentByFirstEdge;
+    fragmentByFirstEdge.reserve(fragments.size());
+
+    for (int i = 0; i < fragments.size(); i++) {
+        fragmentByFirstEdge.insert(fragments[i].first, i);
+    }
+
+    QVector<int> successors(fragments.size(), -1);
+    QVector<bool> hasPredecessor(fragments.size(), false);
+    QVector<bool> isUsed(fragments.size(), false);
+
+    for (int i = 0; i < fragments.size(); i++) {
+        const int successor = fragmentByFirstEdge.value(fragments[i].next, -1);
+        successors[i] = successor;
+        if (successor >= 0) {
+            hasPredecessor[successor] = true;
+        }
+    }
+
+    auto buildChain = [&] (int head) {
+        Fragment chain = fragments[head];
+        isUsed[head] = true;
+
+        for (int i = successors[head]; i >= 0 && !isUsed[i]; i = successors[i]) {
+            appendFragment(&chain, fragments[i]);
+            isUsed[i] = true;
+        }
+
+        return chain;
+    };
+
+    for (int i = 0; i < fragments.size(); i++) {
+        if (!hasPredecessor[i]) {
+            chains->append(buildChain(i));
+        }
+    }
+
+    // all the rest fragments form closed loops
+    for (int i = 0; i < fragments.size(); i++) {
+        if (!isUsed[i]) {
+            loops->append(closeChain(buildChain(i)));
+        }
+    }
+}
+
+class TileTracer
+{
+public:
+    TileTracer(KisPaintDeviceSP device, const QRect &tileRect, const QRect &clipRect)
+        : m_tileRect(tileRect),
+          m_readRect(kisGrowRect(tileRect, 1)),
+          m_pixels(m_readRect.width() * m_readRect.height()),
+          m_visitedEdges((tileRect.width() + 1) * (tileRect.height() + 1), 0)
+    {
+        device->readBytes(m_pixels.data(), m_readRect);
+
+        const QRect validRect = m_readRect & clipRect;
+        if (validRect != m_readRect) {
+            for (int y = m_readRect.top(); y <= m_readRect.bottom(); y++) {
+                for (int x = m_readRect.left(); x <= m_readRect.right(); x++) {
+                    if (!validRect.contains(x, y)) {
+                        m_pixels[pixelIndex(QPoint(x, y))] = MIN_SELECTED;
+                    }
+                }
+            }
+        }
+    }
+
+    void trace(Tile *tile) {
+        QVector<Fragment> fragments;
+
+        for (int y = m_tileRect.top(); y <= m_tileRect.bottom(); y++) {
+            for (int x = m_tileRect.left(); x <= m_tileRect.right(); x++) {
+                const QPoint pt(x, y);
+                if (!isSelected(pt)) continue;
+
+                for (int direction = 0; direction < 4; direction++) {
+                    const QPoint vertex = pt - leftPixelOffsets[direction];
+
+                    if (hasEdge(vertex, direction) && !isVisited(vertex, direction)) {
+                        fragments.append(traceFragment(vertex, direction));
+                    }
+                }
+            }
+        }
+
+        linkFragments(fragments, &tile->loops, &tile->fragments);
+    }
+
+private:
+    inline int pixelIndex(const QPoint &pt) const {
+        return (pt.y() - m_readRect.y()) * m_readRect.width() + pt.x() - m_readRect.x();
+    }
+
+    inline int vertexIndex(const QPoint &pt) const {
+        return (pt.y() - m_tileRect.y()) * (m_tileRect.width() + 1) + pt.x() - m_tileRect.x();
+    }
+
+    inline bool isSelected(const QPoint &pt) const {
+        return m_pixels[pixelIndex(pt)] != MIN_SELECTED;
+    }
+
+    inline bool hasEdge(const QPoint &vertex, int direction) const {
+        return isSelected(vertex + leftPixelOffsets[direction]) &&
+            !isSelected(vertex + leftPixelOffsets[(direction + 1) & 3]);
+    }
+
+    inline bool isOwned(const QPoint &vertex, int direction) const {
+        return m_tileRect.contains(vertex + leftPixelOffsets[direction]);
+    }
+
+    inline bool isVisited(const QPoint &vertex, int direction) const {
+        return m_visitedEdges[vertexIndex(vertex)] & (1 << direction);
+    }
+
+    /**
+     * When two diagonally touching pixels meet in the vertex, the right
+     * turn keeps them in the same contour
+     */
+    inline int nextDirection(const QPoint &vertex, int direction) const {
+        const int rightTurn = (direction + 1) & 3;
+        const int leftTurn = (direction + 3) & 3;
+
+        return hasEdge(vertex, rightTurn) ? rightTurn :
+            hasEdge(vertex, direction) ? direction : leftTurn;
+    }
+
+    Fragment traceFragment(QPoint vertex, int direction) {
+        Fragment fragment;
+        fragment.first.vertex = vertex;
+        fragment.first.direction = direction;
+        fragment.points << vertex;
+
+        forever {
+            m_visitedEdges[vertexIndex(vertex)] |= 1 << direction;
+            vertex += directionOffsets[direction];
+
+            const int next = nextDirection(vertex, direction);
+
+            if (!isOwned(vertex, next) || isVisited(vertex, next)) {
+                fragment.points << vertex;
+                fragment.next.vertex = vertex;
+                fragment.next.direction = next;
+                fragment.lastDirection = direction;
+                break;
+            }
+
+            if (next != direction) {
+                fragment.points << vertex;
+            }
+
+            direction = next;
+        }
+
+        return fragment;
+    }
+
+private:
+    const QRect m_tileRect;
+    const QRect m_readRect;
+    QVector<quint8> m_pixels;
+    QVector<quint8> m_visitedEdges;
+};
+
+bool pixelsEqual(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rect)
+{
+    KisRandomConstAccessorSP it1 = dev1->createRandomConstAccessorNG();
+    KisRandomConstAccessorSP it2 = dev2->createRandomConstAccessorNG();
+
+    const int pixelSize = dev1->pixelSize();
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        int x = rect.left();
+
+        while (x <= rect.right()) {
+            it1->moveTo(x, y);
+            it2->moveTo(x, y);
+
+            const int numPixels = qMin(qMin(it1->numContiguousColumns(x),
+                                            it2->numContiguousColumns(x)),
+                                       rect.right() - x + 1);
+
+            // the untouched tiles are still shared with the copy
+            if (it1->rawDataConst() != it2->rawDataConst() &&
+                memcmp(it1->rawDataConst(), it2->rawDataConst(), numPixels * pixelSize) != 0) {
+
+                return false;
+            }
+
+            x += numPixels;
+        }
+    }
+
+    return true;
+}
+
+}
+
+struct KisOutlineTileCache::Private
+{
+    static constexpr int tileSize = 64;
+
+    QRect rect;
+    int firstCol = 0;
+    int firstRow = 0;
+    int numCols = 0;
+    int numRows = 0;
+    QVector<Tile> tiles;
+
+    /// a shallow copy of the pixels the tiles were traced from
+    KisPaintDeviceSP sourceCopy;
+
+    int numRecalculatedTiles = 0;
+
+    inline QRect fullTileRect(int col, int row) const {
+        return QRect(col * tileSize, row * tileSize, tileSize, tileSize);
+    }
+
+    /**
+     * @return true if the tile of the previous run at (\p col, \p row)
+     * can be reused for the pixels of \p device in \p newRect
+     */
+    bool canReuseTile(int col, int row, KisPaintDeviceSP device, const QRect &newRect) const;
+};
+
+bool KisOutlineTileCache::Private::canReuseTile(int col, int row, KisPaintDeviceSP device, const QRect &newRect) const
+{
+    if (!sourceCopy ||
+        col < firstCol || col >= firstCol + numCols ||
+        row < firstRow || row >= firstRow + numRows) {
+
+        return false;
+    }
+
+    /**
+     * The contours of the tile depend on the pixels of its one-pixel
+     * border as well, and the pixels outside the rect are unselected
+     */
+    const QRect sensitiveRect = kisGrowRect(fullTileRect(col, row), 1);
+
+    return (sensitiveRect & rect) == (sensitiveRect & newRect) &&
+        pixelsEqual(device, sourceCopy, sensitiveRect & newRect);
+}
+
+KisOutlineTileCache::KisOutlineTileCache()
+    : m_d(new Private)
+{
+}
+
+KisOutlineTileCache::~KisOutlineTileCache()
+{
+}
+
+QVector<QPolygon> KisOutlineTileCache::outline(KisPaintDeviceSP device, const QRect &rect)
+{
+    using KisAlgebra2D::divideFloor;
+
+    KIS_SAFE_ASSERT_RECOVER(device->pixelSize() == 1) {
+        clear();
+        return QVector<QPolygon>();
+    }
+
+    /**
+     * Trace a snapshot of the device, so the tiles stay consistent
+     * even if the device is changed in the meantime
+     */
+    KisPaintDeviceSP snapshot = new KisPaintDevice(*device);
+
+    const int tileSize = Private::tileSize;
+    const int firstCol = divideFloor(rect.left(), tileSize);
+    const int firstRow = divideFloor(rect.top(), tileSize);
+    const int numCols = rect.isEmpty() ? 0 : divideFloor(rect.right(), tileSize) - firstCol + 1;
+    const int numRows = rect.isEmpty() ? 0 : divideFloor(rect.bottom(), tileSize) - firstRow + 1;
+
+    QVector<Tile> tiles(numCols * numRows);
+    QVector<bool> isRecalculated(tiles.size(), false);
+
+    {
+        Tile *tilesPtr = tiles.data();
+        bool *isRecalculatedPtr = isRecalculated.data();
+
+        KritaUtils::processConcurrently(tiles.size(),
+            [&, tilesPtr, isRecalculatedPtr] (int i) {
+                const int col = i % numCols + firstCol;
+                const int row = i / numCols + firstRow;
+
+                if (m_d->canReuseTile(col, row, snapshot, rect)) {
+                    const int oldIndex = (row - m_d->firstRow) * m_d->numCols + col - m_d->firstCol;
+                    tilesPtr[i] = m_d->tiles.at(oldIndex);
+                } else {
+                    TileTracer tracer(snapshot, m_d->fullTileRect(col, row) & rect, rect);
+                    tracer.trace(&tilesPtr[i]);
+                    isRecalculatedPtr[i] = true;
+                }
+            });
+    }
+
+    m_d->numRecalculatedTiles = isRecalculated.count(true);
+
+    // stitch the contours crossing the borders of the tiles
+    QVector<QPolygon> polygons;
+    QVector<Fragment> fragments;
+
+    Q_FOREACH (const Tile &tile, tiles) {
+        polygons += tile.loops;
+        fragments += tile.fragments;
+    }
+
+    QVector<Fragment> openChains;
+    linkFragments(fragments, &polygons, &openChains);
+    KIS_SAFE_ASSERT_RECOVER_NOOP(openChains.isEmpty());
+
+    m_d->rect = rect;
+    m_d->firstCol = firstCol;
+    m_d->firstRow = firstRow;
+    m_d->numCols = numCols;
+    m_d->numRows = numRows;
+    m_d->tiles = tiles;
+    m_d->sourceCopy = snapshot;
+
+    return polygons;
+}
+
+void KisOutlineTileCache::clear()
+{
+    m_d->rect = QRect();
+    m_d->firstCol = 0;
+    m_d->firstRow = 0;
+    m_d->numCols = 0;
+    m_d->numRows = 0;
+    m_d->tiles.clear();
+    m_d->sourceCopy = 0;
+    m_d->numRecalculatedTiles = 0;
+}
+
+int KisOutlineTileCache::numRecalculatedTiles() const
+{
+    return m_d->numRecalculatedTiles;
+}
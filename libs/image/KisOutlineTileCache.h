@@ -0,0 +1,65 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISOUTLINETILECACHE_H
+#define KISOUTLINETILECACHE_H
+
+#include <QPolygon>
+#include <QRect>
+#include <QScopedPointer>
+#include <QVector>
+
+#include <kritaimage_export.h>
+#include <kis_types.h>
+
+/**
+ * An incremental generator of the outline of an 8-bit selection device.
+ *
+ * The area of the selection is split into tiles, aligned to the tiles of
+ * the device. For every tile the generator keeps the pieces of the contours
+ * lying in its pixels. When the outline is requested again, only the tiles
+ * whose pixels (or the pixels of their one-pixel border) have changed since
+ * the previous run are traced again, concurrently, and the pieces of all
+ * the tiles are stitched into closed polygons.
+ *
+ * The pixels are considered to be selected when their value differs from
+ * MIN_SELECTED. The diagonally touching pixels belong to the same contour,
+ * the same way as in KisOutlineGenerator.
+ *
+ * The generator is not thread-safe, the caller should guard it itself.
+ */
+class KRITAIMAGE_EXPORT KisOutlineTileCache
+{
+public:
+    KisOutlineTileCache();
+    ~KisOutlineTileCache();
+
+    /**
+     * @return the outline of the selected pixels of \p device lying
+     * inside \p rect. The pixels outside \p rect are considered to be
+     * unselected. The polygons are not closed explicitly, i.e. their last
+     * point doesn't repeat the first one.
+     */
+    QVector<QPolygon> outline(KisPaintDeviceSP device, const QRect &rect);
+
+    /**
+     * Drop all the cached data
+     */
+    void clear();
+
+    /**
+     * @return the number of tiles traced by the last call to outline()
+     */
+    int numRecalculatedTiles() const;
+
+private:
+    Q_DISABLE_COPY(KisOutlineTileCache)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+#endif // KISOUTLINETILECACHE_H
@@ -0,0 +1,299 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAM_H
+#define KISSLIDINGWINDOWHISTOGRAM_H
+
+#include <QVector>
+#include <QRect>
+
+#include <KoUpdater.h>
+
+#include "kis_paint_device.h"
+#include "kis_iterator_ng.h"
+#include "kis_assert.h"
+
+
+/**
+ * A histogram of the pixels covered by a square window. Every bin,
+ * besides the number of pixels, may keep the sum of an arbitrary
+ * per-pixel payload (e.g. normalized channel values), which allows
+ * calculating the average color of the pixels in the bin.
+ *
+ * The histogram is used by KritaUtils::processSlidingWindowHistogram()
+ * for implementing rank (median, min, max) and mode (oil paint) filters.
+ */
+class KisSlidingWindowHistogram
+{
+public:
+    KisSlidingWindowHistogram(int numBins = 0, int payloadSize = 0)
+        : m_counts(numBins, 0),
+          m_payload(numBins * payloadSize, 0.0),
+          m_payloadSize(payloadSize)
+    {
+    }
+
+    inline void clear() {
+        m_counts.fill(0);
+        m_payload.fill(0.0);
+        m_totalCount = 0;
+    }
+
+    inline void add(int bin, const float *payload) {
+        m_counts[bin]++;
+        m_totalCount++;
+
+        double *dst = m_payload.data() + bin * m_payloadSize;
+        for (int i = 0; i < m_payloadSize; i++) {
+            dst[i] += payload[i];
+        }
+    }
+
+    inline void remove(int bin, const float *payload) {
+        m_counts[bin]--;
+        m_totalCount--;
+
+        double *dst = m_payload.data() + bin * m_payloadSize;
+        for (int i = 0; i < m_payloadSize; i++) {
+            dst[i] -= payload[i];
+        }
+    }
+
+    inline void add(const KisSlidingWindowHistogram &rhs) {
+        merge<1>(rhs);
+    }
+
+    inline void subtract(const KisSlidingWindowHistogram &rhs) {
+        merge<-1>(rhs);
+    }
+
+    inline int numBins() const {
+        return m_counts.size();
+    }
+
+    inline int count(int bin) const {
+        return m_counts[bin];
+    }
+
+    inline int totalCount() const {
+        return m_totalCount;
+    }
+
+    /**
+     * The sum of the payloads of all the pixels in \p bin
+     */
+    inline const double* payload(int bin) const {
+        return m_payload.constData() + bin * m_payloadSize;
+    }
+
+    /**
+     * @return the bin with the biggest number of pixels (the first one
+     *         if there are several) or -1 if the histogram is empty
+     */
+    int mostFrequentBin() const {
+        int result = -1;
+        int maxCount = 0;
+
+        for (int i = 0; i < m_counts.size(); i++) {
+            if (m_counts[i] > maxCount) {
+                maxCount = m_counts[i];
+                result = i;
+            }
+        }
+
+        return result;
+    }
+
+    /**
+     * @return the bin of \p rank-th pixel in the sorted sequence of
+     *         the pixels or -1 if the rank is out of range. Rank 0 gives
+     *         the minimum, totalCount() / 2 gives the median and
+     *         totalCount() - 1 gives the maximum.
+     */
+    int rankBin(int rank) const {
+        if (rank < 0 || rank >= m_totalCount) return -1;
+
+        int accumulated = 0;
+        for (int i = 0; i < m_counts.size(); i++) {
+            accumulated += m_counts[i];
+            if (accumulated > rank) return i;
+        }
+
+        return -1;
+    }
+
+    inline int medianBin() const {
+        return rankBin(m_totalCount / 2);
+    }
+
+private:
+    template <int sign>
+    inline void merge(const KisSlidingWindowHistogram &rhs) {
+        const int numBins = m_counts.size();
+
+        int *counts = m_counts.data();
+        const int *rhsCounts = rhs.m_counts.constData();
+
+        for (int i = 0; i < numBins; i++) {
+            counts[i] += sign * rhsCounts[i];
+        }
+
+        double *payload = m_payload.data();
+        const double *rhsPayload = rhs.m_payload.constData();
+        const int payloadLength = m_payload.size();
+
+        for (int i = 0; i < payloadLength; i++) {
+            payload[i] += sign * rhsPayload[i];
+        }
+
+        m_totalCount += sign * rhs.m_totalCount;
+    }
+
+private:
+    QVector<int> m_counts;
+    QVector<double> m_payload;
+    int m_payloadSize = 0;
+    int m_totalCount = 0;
+};
+
+namespace KritaUtils {
+
+/**
+ * Runs a square window of size (2 * radius + 1) over \p rect of \p src
+ * and writes the results into \p dst. The cost per pixel doesn't depend
+ * on the radius: the histogram of the window is built from the
+ * histograms of the columns, which are updated incrementally when the
+ * window moves down (Perreault and Hébert, "Median Filtering in
+ * Constant Time", 2007).
+ *
+ * \p binFunc has signature int(const quint8 *pixel, float *payload).
+ *    It returns the bin of the pixel and fills \p payloadSize values
+ *    of its payload. Returning -1 excludes the pixel from the histogram.
+ *
+ * \p resultFunc has signature
+ *    void(const KisSlidingWindowHistogram &histogram,
+ *         const quint8 *srcPixel, quint8 *dstPixel).
+ *    It is called for every pixel of \p rect with the histogram of the
+ *    window around it.
+ *
+ * The source is read with oldRawData(), so \p src may be the same
+ * device as \p dst when there is a transaction open on it. The rect
+ * is processed in strips of rows, so the memory usage does not depend
+ * on its height.
+ */
+template <class BinFunc, class ResultFunc>
+void processSlidingWindowHistogram(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                                   const QRect &rect, int radius,
+                                   int numBins, int payloadSize,
+                                   BinFunc binFunc, ResultFunc resultFunc,
+                                   KoUpdater *progressUpdater = 0)
+{
+    if (rect.isEmpty()) return;
+
+    const int windowSize = 2 * radius + 1;
+    const int srcWidth = rect.width() + 2 * radius;
+    const int stripHeight = qMax(64, 2 * windowSize);
+
+    /**
+     * The cache of the binned source pixels of the strip
+     * with the margins of the window
+     */
+    const int maxCacheRows = stripHeight + 2 * radius;
+    QVector<int> binsCache(srcWidth * maxCacheRows);
+    QVector<float> payloadCache(srcWidth * maxCacheRows * payloadSize);
+
+    QVector<KisSlidingWindowHistogram> columns(srcWidth, KisSlidingWindowHistogram(numBins, payloadSize));
+    KisSlidingWindowHistogram window(numBins, payloadSize);
+
+    auto addToColumn = [&] (int column, int cacheRow) {
+        const int index = cacheRow * srcWidth + column;
+        const int bin = binsCache[index];
+        if (bin >= 0) {
+            columns[column].add(bin, payloadCache.constData() + index * payloadSize);
+        }
+    };
+
+    auto removeFromColumn = [&] (int column, int cacheRow) {
+        const int index = cacheRow * srcWidth + column;
+        const int bin = binsCache[index];
+        if (bin >= 0) {
+            columns[column].remove(bin, payloadCache.constData() + index * payloadSize);
+        }
+    };
+
+    for (int stripY = rect.y(); stripY <= rect.bottom(); stripY += stripHeight) {
+        const int numRows = qMin(stripHeight, rect.bottom() - stripY + 1);
+        const int numCacheRows = numRows + 2 * radius;
+
+        {
+            KisHLineConstIteratorSP srcIt =
+                src->createHLineConstIteratorNG(rect.x() - radius, stripY - radius, srcWidth);
+
+            int *binPtr = binsCache.data();
+            float *payloadPtr = payloadCache.data();
+
+            for (int y = 0; y < numCacheRows; y++) {
+                for (int x = 0; x < srcWidth; x++) {
+                    *binPtr = binFunc(srcIt->oldRawData(), payloadPtr);
+                    KIS_SAFE_ASSERT_RECOVER(*binPtr < numBins) { *binPtr = -1; }
+
+                    binPtr++;
+                    payloadPtr += payloadSize;
+                    srcIt->nextPixel();
+                }
+                srcIt->nextRow();
+            }
+        }
+
+        for (int x = 0; x < srcWidth; x++) {
+            columns[x].clear();
+            for (int y = 0; y < windowSize; y++) {
+                addToColumn(x, y);
+            }
+        }
+
+        KisHLineConstIteratorSP centerIt = src->createHLineConstIteratorNG(rect.x(), stripY, rect.width());
+        KisHLineIteratorSP dstIt = dst->createHLineIteratorNG(rect.x(), stripY, rect.width());
+
+        for (int y = 0; y < numRows; y++) {
+            window.clear();
+            for (int x = 0; x < windowSize; x++) {
+                window.add(columns[x]);
+            }
+
+            for (int x = 0; x < rect.width(); x++) {
+                resultFunc(window, centerIt->oldRawData(), dstIt->rawData());
+
+                if (x < rect.width() - 1) {
+                    window.add(columns[x + windowSize]);
+                    window.subtract(columns[x]);
+                }
+
+                centerIt->nextPixel();
+                dstIt->nextPixel();
+            }
+
+            centerIt->nextRow();
+            dstIt->nextRow();
+
+            if (y < numRows - 1) {
+                for (int x = 0; x < srcWidth; x++) {
+                    removeFromColumn(x, y);
+                    addToColumn(x, y + windowSize);
+                }
+            }
+        }
+
+        if (progressUpdater) {
+            progressUpdater->setProgress(100 * (stripY + numRows - rect.y()) / rect.height());
+            if (progressUpdater->interrupted()) return;
+        }
+    }
+}
+
+}
+
+#endif // KISSLIDINGWINDOWHISTOGRAM_H
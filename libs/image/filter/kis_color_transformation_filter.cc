@@ -22,6 +22,7 @@
 KisColorTransformationFilter::KisColorTransformationFilter(const KoID& id, const KoID & category, const QString & entry) : KisFilter(id, category, entry)
 {
     setSupportsLevelOfDetail(true);
+    setSupportsStreaming(true);
 }
 
 KisColorTransformationFilter::~KisColorTransformationFilter()
@@ -19,6 +19,15 @@
 #include <kis_painter.h>
 #include <KoUpdater.h>
 
+namespace {
+/**
+ * The minimal height of a strip in the streaming mode. The strips are
+ * also kept at least twice as high as the margin of the filter, so that
+ * the overhead of copying the margins stays reasonable.
+ */
+const int minStreamingStripHeight = 256;
+}
+
 KisFilter::KisFilter(const KoID& _id, const KoID & category, const QString & entry)
     : KisBaseProcessor(_id, category, entry),
       m_supportsLevelOfDetail(false)
@@ -57,7 +66,25 @@ void KisFilter::process(const KisPaintDeviceSP src,
         dst->colorSpace() != dst->compositionSourceColorSpace() &&
         *dst->colorSpace() != *dst->compositionSourceColorSpace();
 
-    if(src == dst && !selection && !weirdDstColorSpace) {
+    const bool inPlace = src == dst && !selection && !weirdDstColorSpace;
+
+    if (!inPlace && supportsStreaming()) {
+        const int margin = qMax(applyRect.top() - needRect.top(),
+                                needRect.bottom() - applyRect.bottom());
+        const int stripHeight = qMax(minStreamingStripHeight, 2 * margin);
+
+        if (applyRect.height() > 2 * stripHeight) {
+            try {
+                processStreaming(src, dst, selection, applyRect, stripHeight, config, progressUpdater);
+            }
+            catch (const std::bad_alloc&) {
+                warnKrita << "Filter" << name() << "failed to allocate enough memory to run.";
+            }
+            return;
+        }
+    }
+
+    if(inPlace) {
         temporary = src;
     }
     else {
@@ -88,6 +115,58 @@ void KisFilter::process(const KisPaintDeviceSP src,
     }
 }
 
+void KisFilter::processStreaming(const KisPaintDeviceSP src,
+                                 KisPaintDeviceSP dst,
+                                 KisSelectionSP selection,
+                                 const QRect& applyRect,
+                                 int stripHeight,
+                                 const KisFilterConfigurationSP config,
+                                 KoUpdater* progressUpdater) const
+{
+    const int lod = src->defaultBounds()->currentLevelOfDetail();
+
+    /**
+     * When \p src and \p dst are the same device, the result of a strip
+     * is written into \p dst only after the next strip has copied its
+     * source pixels, so that the next strip still reads the original
+     * data in its top margin. The strip is never lower than the margin,
+     * so the strips before the previous one are never read again.
+     */
+    KisPaintDeviceSP pendingResult;
+    QRect pendingRect;
+
+    KoDummyUpdaterHolder stripUpdaterHolder;
+
+    for (int y = applyRect.y(); y <= applyRect.bottom(); y += stripHeight) {
+        const QRect stripRect(applyRect.x(), y,
+                              applyRect.width(), qMin(stripHeight, applyRect.bottom() - y + 1));
+
+        KisPaintDeviceSP temporary =
+            dst->createCompositionSourceDevice(src, neededRect(stripRect, config, lod));
+
+        if (pendingResult) {
+            KisPainter::copyAreaOptimized(pendingRect.topLeft(), pendingResult, dst, pendingRect, selection);
+        }
+
+        {
+            KisTransaction transaction(temporary);
+            processImpl(temporary, stripRect, config, stripUpdaterHolder.updater());
+        }
+
+        pendingResult = temporary;
+        pendingRect = stripRect;
+
+        if (progressUpdater) {
+            progressUpdater->setProgress(100 * (stripRect.bottom() + 1 - applyRect.y()) / applyRect.height());
+            if (progressUpdater->interrupted()) break;
+        }
+    }
+
+    if (pendingResult) {
+        KisPainter::copyAreaOptimized(pendingRect.topLeft(), pendingResult, dst, pendingRect, selection);
+    }
+}
+
 QRect KisFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP c, int lod) const
 {
     Q_UNUSED(c);
@@ -108,6 +108,19 @@ protected:
     QString configEntryGroup() const;
     void setSupportsLevelOfDetail(bool value);
 
+private:
+    /**
+     * Filters \p applyRect in horizontal strips of \p stripHeight rows,
+     * keeping only one or two strips with their margins in memory. Used
+     * by process() for the filters that declare supportsStreaming().
+     */
+    void processStreaming(const KisPaintDeviceSP src,
+                          KisPaintDeviceSP dst,
+                          KisSelectionSP selection,
+                          const QRect& applyRect,
+                          int stripHeight,
+                          const KisFilterConfigurationSP config,
+                          KoUpdater* progressUpdater) const;
 
 private:
     bool m_supportsLevelOfDetail;
@@ -0,0 +1,322 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_fill_region_label_map.h"
+#include "kis_fill_region_label_map_p.h"
+
+#include <QSet>
+
+#include "kis_image_config.h"
+#include "kis_random_accessor_ng.h"
+#include "krita_utils.h"
+
+namespace {
+
+/// the memory used by all the maps together
+std::atomic<qint64> s_totalMemoryUsage {0};
+
+bool patchPixelsEqual(KisPaintDeviceSP dev1, KisPaintDeviceSP dev2, const QRect &rect)
+{
+    KisRandomConstAccessorSP it1 = dev1->createRandomConstAccessorNG();
+    KisRandomConstAccessorSP it2 = dev2->createRandomConstAccessorNG();
+
+    const int pixelSize = dev1->pixelSize();
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        int x = rect.left();
+
+        while (x <= rect.right()) {
+            it1->moveTo(x, y);
+            it2->moveTo(x, y);
+
+            const int numPixels = qMin(qMin(it1->numContiguousColumns(x),
+                                            it2->numContiguousColumns(x)),
+                                       rect.right() - x + 1);
+
+            if (memcmp(it1->rawDataConst(), it2->rawDataConst(), numPixels * pixelSize) != 0) {
+                return false;
+            }
+
+            x += numPixels;
+        }
+    }
+
+    return true;
+}
+
+}
+
+KisFillRegionLabelMap::Private::~Private()
+{
+    s_totalMemoryUsage -= accountedSize;
+}
+
+void KisFillRegionLabelMap::Private::reset(const Key &newKey)
+{
+    using KisAlgebra2D::divideFloor;
+
+    key = newKey;
+
+    const QRect &rc = key.boundingRect;
+    firstCol = divideFloor(rc.left(), patchSize);
+    firstRow = divideFloor(rc.top(), patchSize);
+    numCols = rc.isEmpty() ? 0 : divideFloor(rc.right(), patchSize) - firstCol + 1;
+    numRows = rc.isEmpty() ? 0 : divideFloor(rc.bottom(), patchSize) - firstRow + 1;
+
+    patches.clear();
+    patches.resize(numCols * numRows);
+    regions.clear();
+
+    sourceDevice = 0;
+    sourceSequenceNumber = -1;
+    sourceCopy = 0;
+
+    gapMap = 0;
+}
+
+void KisFillRegionLabelMap::Private::prepare(const Key &newKey, KisPaintDeviceSP device)
+{
+    if (newKey != key) {
+        reset(newKey);
+    } else if (device == sourceDevice && device->sequenceNumber() == sourceSequenceNumber) {
+        return;
+    } else if (sourceCopy && *sourceCopy->colorSpace() == *device->colorSpace()) {
+        QVector<int> labeledPatches;
+
+        for (int i = 0; i < int(patches.size()); i++) {
+            if (patches[i] && patches[i]->isLabeled) {
+                labeledPatches.append(i);
+            }
+        }
+
+        QVector<char> isChanged(labeledPatches.size(), false);
+        char *isChangedPtr = isChanged.data();
+
+        KritaUtils::processConcurrently(labeledPatches.size(),
+            [&] (int i) {
+                const QRect rect = patches[labeledPatches.at(i)]->rect;
+                isChangedPtr[i] = !patchPixelsEqual(device, sourceCopy, rect);
+            });
+
+        for (int i = 0; i < labeledPatches.size(); i++) {
+            if (isChanged[i]) {
+                dropPatch(labeledPatches[i]);
+            }
+        }
+
+        if (gapMap) {
+            const QVector<QRect> gapTiles = gapMap->loadedTileRects();
+            QVector<char> isGapTileChanged(gapTiles.size(), false);
+            char *isGapTileChangedPtr = isGapTileChanged.data();
+
+            KritaUtils::processConcurrently(gapTiles.size(),
+                [&] (int i) {
+                    isGapTileChangedPtr[i] = !patchPixelsEqual(device, sourceCopy, gapTiles[i]);
+                });
+
+            QVector<QRect> changedGapTiles;
+            for (int i = 0; i < gapTiles.size(); i++) {
+                if (isGapTileChanged[i]) {
+                    changedGapTiles.append(gapTiles[i]);
+                }
+            }
+
+            gapMap->invalidateTileRects(changedGapTiles);
+        }
+    } else {
+        reset(newKey);
+    }
+
+    sourceDevice = device;
+    sourceSequenceNumber = device->sequenceNumber();
+    sourceCopy = new KisPaintDevice(*device);
+}
+
+KisGapMapSP KisFillRegionLabelMap::Private::prepareGapMap(const Key &newKey, int gapSize,
+                                                          KisPaintDeviceSP device,
+                                                          const KisGapMap::FillOpacityFunc &fillOpacityFunc)
+{
+    prepare(newKey, device);
+
+    if (!gapMap || gapMap->gapSize() != gapSize) {
+        gapMap = new KisGapMap(gapSize, key.boundingRect, fillOpacityFunc);
+    } else {
+        gapMap->setFillOpacityFunc(fillOpacityFunc);
+    }
+
+    return gapMap;
+}
+
+void KisFillRegionLabelMap::Private::finishFill()
+{
+    /**
+     * The opacity callback refers to the policies on the stack of the
+     * finished fill, so make sure nobody can call it anymore
+     */
+    if (gapMap) {
+        gapMap->setFillOpacityFunc(KisGapMap::FillOpacityFunc());
+    }
+
+    updateAccountedSize();
+
+    if (s_totalMemoryUsage > KisFillRegionLabelMap::memoryBudget()) {
+        reset(Key());
+        updateAccountedSize();
+    }
+}
+
+qint64 KisFillRegionLabelMap::Private::estimateMemoryUsage() const
+{
+    qint64 size = qint64(patches.capacity()) * sizeof(std::unique_ptr<KisFillPatch>);
+    qint64 labeledArea = 0;
+
+    for (const std::unique_ptr<KisFillPatch> &patch : patches) {
+        if (!patch) continue;
+
+        size += sizeof(KisFillPatch) +
+            patch->opacity.capacity() * sizeof(quint8) +
+            patch->labels.capacity() * sizeof(quint16) +
+            patch->regionOfLabel.capacity() * sizeof(int) +
+            (patch->seeds.capacity() + patch->outgoingSeeds.capacity()) * sizeof(QPoint);
+
+        if (patch->isLabeled) {
+            labeledArea += qint64(patch->rect.width()) * patch->rect.height();
+        }
+    }
+
+    Q_FOREACH (const Region &region, regions) {
+        size += sizeof(Region) + region.patches.capacity() * sizeof(int);
+    }
+
+    /**
+     * The copy of the source device shares its tiles with the device
+     * until they are changed, so count the area the labeled patches
+     * compare with it as an upper bound
+     */
+    if (sourceCopy) {
+        size += labeledArea * sourceCopy->pixelSize();
+    }
+
+    if (gapMap) {
+        size += gapMap->memoryUsage();
+    }
+
+    return size;
+}
+
+void KisFillRegionLabelMap::Private::updateAccountedSize()
+{
+    const qint64 size = estimateMemoryUsage();
+    s_totalMemoryUsage += size - accountedSize;
+    accountedSize = size;
+}
+
+void KisFillRegionLabelMap::Private::dropPatch(int index)
+{
+    /**
+     * The changed pixels may join the regions of the patch with the
+     * regions of its neighbours, so all of them become invalid
+     */
+    QSet<int> invalidRegions;
+
+    const int col = index % numCols;
+    const int row = index / numCols;
+
+    auto collectRegions = [&] (int c, int r) {
+        if (c < 0 || c >= numCols || r < 0 || r >= numRows) return;
+
+        KisFillPatch *patch = patches[r * numCols + c].get();
+        if (!patch) return;
+
+        Q_FOREACH (int region, patch->regionOfLabel) {
+            if (region >= 0) {
+                invalidRegions.insert(region);
+            }
+        }
+    };
+
+    collectRegions(col, row);
+    collectRegions(col - 1, row);
+    collectRegions(col + 1, row);
+    collectRegions(col, row - 1);
+    collectRegions(col, row + 1);
+
+    Q_FOREACH (int region, invalidRegions) {
+        Q_FOREACH (int patchIndex, regions[region].patches) {
+            KisFillPatch *patch = patches[patchIndex].get();
+            if (!patch) continue;
+
+            for (int i = 0; i < patch->regionOfLabel.size(); i++) {
+                if (patch->regionOfLabel[i] == region) {
+                    patch->regionOfLabel[i] = -1;
+                    patch->numResolvedLabels--;
+                }
+            }
+        }
+
+        regions[region] = Region();
+    }
+
+    patches[index].reset();
+}
+
+KisFillRegionLabelMap::KisFillRegionLabelMap()
+    : m_d(new Private)
+{
+}
+
+KisFillRegionLabelMap::~KisFillRegionLabelMap()
+{
+}
+
+void KisFillRegionLabelMap::clear()
+{
+    QMutexLocker l(&m_d->mutex);
+    m_d->reset(Private::Key());
+    m_d->numHits = 0;
+    m_d->updateAccountedSize();
+}
+
+int KisFillRegionLabelMap::numRegions() const
+{
+    QMutexLocker l(&m_d->mutex);
+
+    int result = 0;
+    Q_FOREACH (const Private::Region &region, m_d->regions) {
+        if (!region.patches.isEmpty()) {
+            result++;
+        }
+    }
+
+    return result;
+}
+
+int KisFillRegionLabelMap::numHits() const
+{
+    QMutexLocker l(&m_d->mutex);
+    return m_d->numHits;
+}
+
+qint64 KisFillRegionLabelMap::memoryUsage() const
+{
+    return m_d->accountedSize;
+}
+
+qint64 KisFillRegionLabelMap::totalMemoryUsage()
+{
+    return s_totalMemoryUsage;
+}
+
+qint64 KisFillRegionLabelMap::memoryBudget()
+{
+    /**
+     * The budget is checked once per fill, so the config is not cached.
+     * The maps live in the heap, so they get a smaller part of the memory
+     * than the tile-based caches.
+     */
+    KisImageConfig cfg(true);
+    return (qint64(cfg.tilesSoftLimit()) << 20) / 8;
+}
@@ -0,0 +1,101 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_FILL_REGION_LABEL_MAP_H
+#define __KIS_FILL_REGION_LABEL_MAP_H
+
+#include <QScopedPointer>
+
+#include <kritaimage_export.h>
+#include <kis_types.h>
+#include <kis_shared.h>
+
+/**
+ * A cache of the connected regions found by the selection fills of
+ * KisScanlineFill, which can be shared by several fills of the same
+ * reference device.
+ *
+ * The map keeps the opacity and the labeled groups of pixels of every
+ * tile reached by a fill, and remembers which groups formed the region
+ * of every finished fill. When a fill starts in a region that is
+ * already known, the fill is reduced to writing the opacity of that
+ * region into the selection. Otherwise the fill reuses the labeled
+ * tiles and labels only the tiles it reaches for the first time.
+ *
+ * The map is valid for one combination of the fill settings (the
+ * reference color, threshold, opacity spread and boundary selection);
+ * a fill with different settings resets it. The map keeps a shallow
+ * copy of the reference device, so a fill with another device or with
+ * a changed one is checked against it: the tiles with different pixels
+ * are labeled again and the regions around them are forgotten.
+ *
+ * The fills with non-zero close gap size don't produce connected
+ * regions, so they don't use the labeled tiles. Instead, the map keeps
+ * the gap distance map of the last such fill, which is checked against
+ * the reference device the same way, and only the tiles around the
+ * changed pixels are calculated again.
+ *
+ * The estimated size of all the maps, including their gap maps, is reported to
+ * KisMemoryStatisticsServer. When it exceeds memoryBudget() after
+ * a fill, the data of the map used by that fill is dropped.
+ *
+ * The map can be used by several threads, the fills using it are
+ * serialized. A fill holds the map for its whole duration, so the
+ * GUI should release its reference to the map instead of calling
+ * clear() while a fill may be running.
+ */
+class KRITAIMAGE_EXPORT KisFillRegionLabelMap : public KisShared
+{
+public:
+    KisFillRegionLabelMap();
+    ~KisFillRegionLabelMap();
+
+    /**
+     * Drop all the cached data
+     */
+    void clear();
+
+    /**
+     * @return the number of the regions found by the fills since
+     *         the last reset of the map
+     */
+    int numRegions() const;
+
+    /**
+     * @return the number of the fills that were reduced to
+     *         writing an already known region
+     */
+    int numHits() const;
+
+    /**
+     * @return the estimated amount of memory used by the map in bytes,
+     *         as calculated by the end of the last fill
+     */
+    qint64 memoryUsage() const;
+
+    /**
+     * @return the estimated amount of memory used by all the maps in bytes
+     */
+    static qint64 totalMemoryUsage();
+
+    /**
+     * @return the maximum amount of memory all the maps may use
+     *         together, a part of the soft tiles memory limit
+     *         set in KisImageConfig
+     */
+    static qint64 memoryBudget();
+
+private:
+    friend class KisScanlineFill;
+    Q_DISABLE_COPY(KisFillRegionLabelMap)
+
+    struct Private;
+    const QScopedPointer<Private> m_d;
+};
+
+typedef KisSharedPtr<KisFillRegionLabelMap> KisFillRegionLabelMapSP;
+
+#endif /* __KIS_FILL_REGION_LABEL_MAP_H */
@@ -0,0 +1,196 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_FILL_REGION_LABEL_MAP_P_H
+#define __KIS_FILL_REGION_LABEL_MAP_P_H
+
+#include <atomic>
+#include <memory>
+#include <vector>
+
+#include <QByteArray>
+#include <QMutex>
+#include <QPoint>
+#include <QRect>
+#include <QVector>
+
+#include <kis_global.h>
+#include <kis_algebra_2d.h>
+#include <kis_paint_device.h>
+
+#include "kis_fill_region_label_map.h"
+#include "kis_gap_map.h"
+
+/**
+ * A tile-aligned patch of the area processed by the parallel fill
+ * engine. When a fill reaches the patch for the first time, the
+ * opacity of its pixels is calculated and the pixels are split into
+ * 4-connected groups, so every further visit only needs to look up
+ * the group of the incoming seed.
+ */
+struct KisFillPatch
+{
+    static constexpr quint16 NoLabel = 0xffff;
+
+    QRect rect;
+
+    bool isLabeled = false;
+    int numLabels = 0;
+    int numResolvedLabels = 0;
+
+    /**
+     * When all the pixels of the patch have the same non-zero opacity,
+     * the arrays are not allocated and the whole patch forms a single
+     * group with uniformOpacity
+     */
+    QVector<quint8> opacity;
+    QVector<quint16> labels;
+    quint8 uniformOpacity = MIN_SELECTED;
+
+    /// the region every group belongs to or -1 if no fill has reached it yet
+    QVector<int> regionOfLabel;
+
+    /// the seeds that reached the patch since its last visit
+    QVector<QPoint> seeds;
+    /// the seeds the last visit passed to the neighbouring patches
+    QVector<QPoint> outgoingSeeds;
+    /// the extent of the pixels filled by the last visit
+    QRect fillExtent;
+    /// the last region whose pixels were filled in the patch
+    int lastFilledRegion = -1;
+
+    inline bool isComplete() const {
+        return isLabeled && numResolvedLabels == numLabels;
+    }
+
+    inline int labelAt(const QPoint &pt) const {
+        if (labels.isEmpty()) {
+            return numLabels > 0 ? 0 : -1;
+        }
+
+        const quint16 label = labels[(pt.y() - rect.y()) * rect.width() + pt.x() - rect.x()];
+        return label != NoLabel ? label : -1;
+    }
+};
+
+struct KisFillRegionLabelMap::Private
+{
+    static constexpr int patchSize = 64;
+
+    /**
+     * The settings of the fill, which define the opacity of the pixels
+     */
+    struct Key {
+        int method = -1;
+        QByteArray referenceColor;
+        int threshold = 0;
+        int opacitySpread = 0;
+        QRect boundingRect;
+        KisPaintDeviceSP boundarySelection;
+        int boundarySelectionSequenceNumber = -1;
+
+        bool operator==(const Key &rhs) const {
+            return method == rhs.method &&
+                referenceColor == rhs.referenceColor &&
+                threshold == rhs.threshold &&
+                opacitySpread == rhs.opacitySpread &&
+                boundingRect == rhs.boundingRect &&
+                boundarySelection == rhs.boundarySelection &&
+                boundarySelectionSequenceNumber == rhs.boundarySelectionSequenceNumber;
+        }
+
+        bool operator!=(const Key &rhs) const {
+            return !(*this == rhs);
+        }
+    };
+
+    struct Region {
+        QVector<int> patches;
+        QRect extent;
+    };
+
+    /// held for the whole duration of a fill
+    QMutex mutex;
+
+    Key key;
+
+    /**
+     * The maps of single fills don't need to keep the data of
+     * the patches that cannot be reached by the fill anymore
+     */
+    bool isPersistent = true;
+
+    /// the device the map is synchronized with
+    KisPaintDeviceSP sourceDevice;
+    int sourceSequenceNumber = -1;
+    /// a shallow copy of the pixels the patches were calculated from
+    KisPaintDeviceSP sourceCopy;
+
+    int firstCol = 0;
+    int firstRow = 0;
+    int numCols = 0;
+    int numRows = 0;
+    std::vector<std::unique_ptr<KisFillPatch>> patches;
+
+    QVector<Region> regions;
+    int numHits = 0;
+
+    /// the distance map of the last fill with non-zero close gap size
+    KisGapMapSP gapMap;
+
+    /// the part of the total memory usage of the maps accounted for this map
+    std::atomic<qint64> accountedSize {0};
+
+    ~Private();
+
+    void reset(const Key &newKey);
+
+    /**
+     * Reset the map if \p newKey differs from the current one, otherwise
+     * drop the patches whose pixels in \p device differ from the ones the
+     * patches were calculated from
+     */
+    void prepare(const Key &newKey, KisPaintDeviceSP device);
+
+    /**
+     * Prepare the map with prepare() and return the gap map for a fill
+     * with \p gapSize. The gap map of the previous fill is reused when
+     * its gap size is the same, only the tiles with changed pixels are
+     * calculated again. The opacity callback of the map is replaced with
+     * \p fillOpacityFunc, which must stay valid while the fill is running.
+     * finishFill() resets the callback again.
+     */
+    KisGapMapSP prepareGapMap(const Key &newKey, int gapSize,
+                              KisPaintDeviceSP device,
+                              const KisGapMap::FillOpacityFunc &fillOpacityFunc);
+
+    /**
+     * Reset the opacity callback of the gap map, update the memory usage
+     * of the map and drop its data if all the maps together exceed the
+     * budget. Called by the fill, which has been using the map, while it
+     * still holds the mutex.
+     */
+    void finishFill();
+
+    inline int patchIndex(const QPoint &pt) const {
+        return (KisAlgebra2D::divideFloor(pt.y(), patchSize) - firstRow) * numCols +
+            KisAlgebra2D::divideFloor(pt.x(), patchSize) - firstCol;
+    }
+
+    inline QRect patchRect(int index) const {
+        const int col = index % numCols + firstCol;
+        const int row = index / numCols + firstRow;
+        return QRect(col * patchSize, row * patchSize, patchSize, patchSize) & key.boundingRect;
+    }
+
+    void updateAccountedSize();
+
+private:
+    void dropPatch(int index);
+    qint64 estimateMemoryUsage() const;
+};
+
+#endif /* __KIS_FILL_REGION_LABEL_MAP_P_H */
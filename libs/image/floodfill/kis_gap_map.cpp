@@ -26,6 +26,7 @@
 #include <QMutexLocker>
 #include <KoColor.h>
 #include <KoColorSpaceRegistry.h>
+#include <krita_utils.h>
 
 #if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
 #include <QElapsedTimer>
@@ -60,10 +61,10 @@ ALWAYS_INLINE QPoint TransformMirrorHorizontally(int x, int y, int xOffset, int
 } // anonymous namespace
 
 template<bool BoundsCheck>
-bool KisGapMap::isOpaque(int x, int y)
+bool KisGapMap::isOpaque(KisTileOptimizedAccessor& accessor, int x, int y)
 {
 #if KIS_GAP_MAP_DEBUG_LOGGING_AND_ASSERTS
-    const TileFlags flags = *tileFlagsPtr(x / TileSize, y / TileSize);
+    const TileFlags flags = *tileFlagsPtr(accessor, x / TileSize, y / TileSize);
     KIS_SAFE_ASSERT_RECOVER((flags & TILE_OPACITY_LOADED) != 0) {
         qDebug() << "ERROR: opacity at (" << x << "," << y << ") not loaded";
         return false;
@@ -71,19 +72,19 @@ bool KisGapMap::isOpaque(int x, int y)
 #endif
     if (BoundsCheck) {
         if ((x >= 0) && (x < m_size.width()) && (y >= 0) && (y < m_size.height())) {
-            return dataPtr(x, y)->opacity == MIN_SELECTED;
+            return dataPtr(accessor, x, y)->opacity == MIN_SELECTED;
         } else {
             return false;
         }
     } else {
-        return dataPtr(x, y)->opacity == MIN_SELECTED;
+        return dataPtr(accessor, x, y)->opacity == MIN_SELECTED;
     }
 }
 
 template<bool BoundsCheck>
-bool KisGapMap::isOpaque(const QPoint& p)
+bool KisGapMap::isOpaque(KisTileOptimizedAccessor& accessor, const QPoint& p)
 {
-    return isOpaque<BoundsCheck>(p.x(), p.y());
+    return isOpaque<BoundsCheck>(accessor, p.x(), p.y());
 }
 
 KisGapMap::KisGapMap(int gapSize,
@@ -110,6 +111,30 @@ KisGapMap::KisGapMap(int gapSize,
     m_deviceSp->fill(mapBounds, color);
 }
 
+void KisGapMap::setFillOpacityFunc(const FillOpacityFunc& fillOpacityFunc)
+{
+    m_fillOpacityFunc = fillOpacityFunc;
+}
+
+QRect KisGapMap::nearbyTilesRect(const QPoint& tile, int radius) const
+{
+    // Clamped tile neighborhood.
+    const QPoint topLeft(qMax(0, tile.x() - radius),
+                         qMax(0, tile.y() - radius));
+    const QPoint bottomRight(qMin(tile.x() + radius, m_numTiles.width() - 1),
+                             qMin(tile.y() + radius, m_numTiles.height() - 1));
+    return QRect(topLeft, bottomRight);
+}
+
+QRect KisGapMap::tileRect(const QPoint& tile) const
+{
+    // Resize and clamp to image bounds.
+    QRect rect(tile.x() * TileSize, tile.y() * TileSize, TileSize, TileSize);
+    rect.setRight(qMin(rect.right(), m_size.width() - 1));
+    rect.setBottom(qMin(rect.bottom(), m_size.height() - 1));
+    return rect;
+}
+
 void KisGapMap::loadOpacityTiles(const QRect& tileRect)
 {
 #if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
@@ -117,51 +142,166 @@ void KisGapMap::loadOpacityTiles(const QRect& tileRect)
     timer.start();
 #endif
 
+    QVector<QPoint> tiles;
+
     for (int ty = tileRect.top(); ty <= tileRect.bottom(); ++ty) {
         for (int tx = tileRect.left(); tx <= tileRect.right(); ++tx) {
-            TileFlags* const pFlags = tileFlagsPtr(tx, ty);
-            if ((*pFlags & TILE_OPACITY_LOADED) == 0) {
-                // Resize and clamp to image bounds.
-                QRect rect(tx * TileSize, ty * TileSize, TileSize, TileSize);
-                rect.setRight(qMin(rect.right(), m_size.width() - 1));
-                rect.setBottom(qMin(rect.bottom(), m_size.height() - 1));
+            if ((*tileFlagsPtr(*m_accessor, tx, ty) & TILE_OPACITY_LOADED) == 0) {
+                tiles.append(QPoint(tx, ty));
+            }
+        }
+    }
+
+    if (tiles.isEmpty()) {
+        return;
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(m_fillOpacityFunc);
+
+    QVector<char> hasOpaquePixels(tiles.size(), false);
+    char* const hasOpaquePixelsPtr = hasOpaquePixels.data();
+
+    // The callback writes the opacity of the pixels of its own tile only,
+    // so the tiles can be loaded concurrently.
+    KritaUtils::processConcurrently(tiles.size(),
+        [&](int i) {
+            const QRect rect = this->tileRect(tiles.at(i));
 
 #if KIS_GAP_MAP_DEBUG_LOGGING_AND_ASSERTS
-                qDebug() << "loadOpacityTiles()" << rect;
+            qDebug() << "loadOpacityTiles()" << rect;
+#endif
+            // It's not too elegant to pass the device, but this performs the best for now.
+            hasOpaquePixelsPtr[i] = m_fillOpacityFunc(m_deviceSp.data(), rect);
+        });
+
+    // The flags share the memory with the pixel data, so they are only
+    // updated after all the tiles have been processed.
+    for (int i = 0; i < tiles.size(); ++i) {
+        TileFlags* const pFlags = tileFlagsPtr(*m_accessor, tiles[i].x(), tiles[i].y());
+
+        // This tile is now loaded.
+        *pFlags |= TILE_OPACITY_LOADED | (hasOpaquePixels[i] ? TILE_HAS_OPAQUE_PIXELS : 0);
+    }
+
+#if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
+    m_opacityElapsedNanos += timer.nsecsElapsed();
+#endif
+}
+
+/** Calculate the distance data of all the tiles in tileRect, which are not loaded yet.
+ *  NOTE: Opacity data of the tiles and their neighbors must have been loaded already.
+ */
+void KisGapMap::loadDistanceTiles(const QRect& tileRect)
+{
+#if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
+    QElapsedTimer timer;
+    timer.start();
 #endif
-                // It's not too elegant to pass the device, but this performs the best for now.
-                const bool hasOpaquePixels = m_fillOpacityFunc(m_deviceSp.data(), rect);
 
-                // This tile is now loaded.
-                *pFlags |= TILE_OPACITY_LOADED | (hasOpaquePixels ? TILE_HAS_OPAQUE_PIXELS : 0);
+    QVector<QPoint> tiles;
+
+    for (int ty = tileRect.top(); ty <= tileRect.bottom(); ++ty) {
+        for (int tx = tileRect.left(); tx <= tileRect.right(); ++tx) {
+            if ((*tileFlagsPtr(*m_accessor, tx, ty) & TILE_DISTANCE_LOADED) == 0) {
+                tiles.append(QPoint(tx, ty));
             }
         }
     }
 
+    // Every tile writes the distances of its own pixels only and reads
+    // the opacity of the neighbors, which doesn't change at this stage.
+    KritaUtils::processConcurrently(tiles.size(),
+        [&](int i) {
+            TileContext context(m_deviceSp);
+            loadDistanceTile(context, tiles.at(i), nearbyTilesRect(tiles.at(i), 1), m_gapSize);
+        });
+
+    for (const QPoint& tile : tiles) {
+        // This tile is now considered loaded.
+        *tileFlagsPtr(*m_accessor, tile.x(), tile.y()) |= TILE_DISTANCE_LOADED;
+    }
+
 #if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
-    m_opacityElapsedNanos += timer.nsecsElapsed();
+    m_distanceElapsedNanos += timer.nsecsElapsed();
 #endif
 }
 
+QVector<QRect> KisGapMap::loadedTileRects()
+{
+    QVector<QRect> result;
+
+    for (int ty = 0; ty < m_numTiles.height(); ++ty) {
+        for (int tx = 0; tx < m_numTiles.width(); ++tx) {
+            if ((*tileFlagsPtr(*m_accessor, tx, ty) & TILE_OPACITY_LOADED) != 0) {
+                result.append(tileRect(QPoint(tx, ty)));
+            }
+        }
+    }
+
+    return result;
+}
+
+qint64 KisGapMap::memoryUsage()
+{
+    // Only the tiles that have been written to are allocated by the device.
+    return qint64(loadedTileRects().size()) * TileSize * TileSize * sizeof(Data);
+}
+
+void KisGapMap::invalidateTileRects(const QVector<QRect>& rects)
+{
+    Data defaultPixel {};
+    defaultPixel.distance = DISTANCE_INFINITE;
+    defaultPixel.opacity = MAX_SELECTED;    // here: max = transparent
+
+    for (const QRect& rect : rects) {
+        const QPoint tile(rect.x() / TileSize, rect.y() / TileSize);
+
+        Data* const ptr = reinterpret_cast<Data*>(m_accessor->tileRawData(tile.x(), tile.y()));
+        std::fill(ptr, ptr + TileSize * TileSize, defaultPixel);
+    }
+
+    for (const QRect& rect : rects) {
+        // The tiles whose distances were calculated from the opacity of the
+        // changed tile (see lazyDistance()).
+        const QRect nearbyTiles = QRect(rect.x() / TileSize - 1, rect.y() / TileSize - 1, 4, 3) &
+                                  QRect(QPoint(), m_numTiles);
+
+        for (int ty = nearbyTiles.top(); ty <= nearbyTiles.bottom(); ++ty) {
+            for (int tx = nearbyTiles.left(); tx <= nearbyTiles.right(); ++tx) {
+                TileFlags* const pFlags = tileFlagsPtr(*m_accessor, tx, ty);
+                if ((*pFlags & TILE_DISTANCE_LOADED) == 0) continue;
+
+                // Keep the opacity, it is still valid.
+                Data* const ptr = reinterpret_cast<Data*>(m_accessor->tileRawData(tx, ty));
+                for (int i = 0; i < TileSize * TileSize; ++i) {
+                    ptr[i].distance = DISTANCE_INFINITE;
+                }
+
+                *pFlags &= ~TILE_DISTANCE_LOADED;
+            }
+        }
+    }
+}
+
 /** This is a part of loadDistanceTile() implementation. */
-void KisGapMap::distanceSearchRowInnerLoop(bool boundsCheck, int y, int x1, int x2)
+void KisGapMap::distanceSearchRowInnerLoop(TileContext& context, bool boundsCheck, int y, int x1, int x2)
 {
     if (boundsCheck) {
         for (int x = x1; x <= x2; ++x) {
-            if (isOpaque<true>(x, y)) {
-                gapDistanceSearch<true>(x, y, TransformNone);
-                gapDistanceSearch<true>(x, y, TransformRotateClockwiseMirrorHorizontally);
-                gapDistanceSearch<true>(x, y, TransformRotateClockwise);
-                gapDistanceSearch<true>(x, y, TransformMirrorHorizontally);
+            if (isOpaque<true>(context.accessor, x, y)) {
+                gapDistanceSearch<true>(context, x, y, TransformNone);
+                gapDistanceSearch<true>(context, x, y, TransformRotateClockwiseMirrorHorizontally);
+                gapDistanceSearch<true>(context, x, y, TransformRotateClockwise);
+                gapDistanceSearch<true>(context, x, y, TransformMirrorHorizontally);
             }
         }
     } else {
         for (int x = x1; x <= x2; ++x) {
-            if (isOpaque<false>(x, y)) {
-                gapDistanceSearch<false>(x, y, TransformNone);
-                gapDistanceSearch<false>(x, y, TransformRotateClockwiseMirrorHorizontally);
-                gapDistanceSearch<false>(x, y, TransformRotateClockwise);
-                gapDistanceSearch<false>(x, y, TransformMirrorHorizontally);
+            if (isOpaque<false>(context.accessor, x, y)) {
+                gapDistanceSearch<false>(context, x, y, TransformNone);
+                gapDistanceSearch<false>(context, x, y, TransformRotateClockwiseMirrorHorizontally);
+                gapDistanceSearch<false>(context, x, y, TransformRotateClockwise);
+                gapDistanceSearch<false>(context, x, y, TransformMirrorHorizontally);
             }
         }
     }
@@ -177,43 +317,30 @@ void KisGapMap::distanceSearchRowInnerLoop(bool boundsCheck, int y, int x1, int
  *  and must be at least equal to the gap size. We need to do calculations in
  *  a larger region in order to compute correct distances within the requested rect.
  */
-void KisGapMap::loadDistanceTile(const QPoint& tile, const QRect& nearbyTilesRect, int guardBand)
+void KisGapMap::loadDistanceTile(TileContext& context, const QPoint& tile, const QRect& nearbyTilesRect, int guardBand)
 {
-#if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
-    QElapsedTimer timer;
-    timer.start();
-#endif
-
-    TileFlags* const pFlags = tileFlagsPtr(tile.x(), tile.y());
-
-    // This tile is now considered loaded.
-    *pFlags |= TILE_DISTANCE_LOADED;
+    KisTileOptimizedAccessor& accessor = context.accessor;
+    const TileFlags* const pFlags = tileFlagsPtr(accessor, tile.x(), tile.y());
 
     // Optimization: If a tile is completely transparent (TILE_HAS_OPAQUE_PIXELS == 0), then
     // we can skip the distance calculation for it. Unfortunately, with the guard bands we need
     // to check the flags of the neighboring tiles as well.
 
     const bool tileOpaque           = (*pFlags & TILE_HAS_OPAQUE_PIXELS) != 0;
-    const bool tileOpaqueLeft       = (nearbyTilesRect.left()   == tile.x()) ?                                           false : (*tileFlagsPtr(tile.x() - 1, tile.y())     & TILE_HAS_OPAQUE_PIXELS) != 0;
-    const bool tileOpaqueTopLeft    = (nearbyTilesRect.left()   == tile.x()) || (nearbyTilesRect.top()    == tile.y()) ? false : (*tileFlagsPtr(tile.x() - 1, tile.y() - 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
-    const bool tileOpaqueBottomLeft = (nearbyTilesRect.left()   == tile.x()) || (nearbyTilesRect.bottom() == tile.y()) ? false : (*tileFlagsPtr(tile.x() - 1, tile.y() + 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
-    const bool tileOpaqueTop        = (nearbyTilesRect.top()    == tile.y()) ?                                           false : (*tileFlagsPtr(tile.x(),     tile.y() - 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
-    const bool tileOpaqueBottom     = (nearbyTilesRect.bottom() == tile.y()) ?                                           false : (*tileFlagsPtr(tile.x(),     tile.y() + 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
+    const bool tileOpaqueLeft       = (nearbyTilesRect.left()   == tile.x()) ?                                           false : (*tileFlagsPtr(accessor, tile.x() - 1, tile.y())     & TILE_HAS_OPAQUE_PIXELS) != 0;
+    const bool tileOpaqueTopLeft    = (nearbyTilesRect.left()   == tile.x()) || (nearbyTilesRect.top()    == tile.y()) ? false : (*tileFlagsPtr(accessor, tile.x() - 1, tile.y() - 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
+    const bool tileOpaqueBottomLeft = (nearbyTilesRect.left()   == tile.x()) || (nearbyTilesRect.bottom() == tile.y()) ? false : (*tileFlagsPtr(accessor, tile.x() - 1, tile.y() + 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
+    const bool tileOpaqueTop        = (nearbyTilesRect.top()    == tile.y()) ?                                           false : (*tileFlagsPtr(accessor, tile.x(),     tile.y() - 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
+    const bool tileOpaqueBottom     = (nearbyTilesRect.bottom() == tile.y()) ?                                           false : (*tileFlagsPtr(accessor, tile.x(),     tile.y() + 1) & TILE_HAS_OPAQUE_PIXELS) != 0;
 
     if (! (tileOpaqueTopLeft || tileOpaqueTop || tileOpaqueLeft || tileOpaque || tileOpaqueBottomLeft || tileOpaqueBottom)) {
         // This tile as well as its surroundings are transparent.
         // We can simply exit without explicitly initializing the tile. The paint device's default pixel is DISTANCE_INFINITE.
-
-#if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
-        m_distanceElapsedNanos += timer.nsecsElapsed();
-#endif
         return;
     }
 
     // The area of the image covered only by this tile.
-    QRect rect(tile.x() * TileSize, tile.y() * TileSize, TileSize, TileSize);
-    rect.setRight(qMin(rect.right(), m_size.width() - 1));
-    rect.setBottom(qMin(rect.bottom(), m_size.height() - 1));
+    const QRect rect = tileRect(tile);
 
     // Compromise: At the tile size 64 px and the gap size 32 px, the guard band must be
     // 31 px at most, because opacity is sampled in gap size + 1 radius, which could be two tiles
@@ -235,26 +362,22 @@ void KisGapMap::loadDistanceTile(const QPoint& tile, const QRect& nearbyTilesRec
         (rect.right() + (m_gapSize + 1) >= m_size.width()) ||  // no risk of accessing x<0
         (y1 - (m_gapSize + 1) < 0) || (y2 + (m_gapSize + 1) >= m_size.height());
 
-    m_tilePosition = rect.topLeft();
-    m_tileDataPtr = reinterpret_cast<Data*>(m_accessor->tileRawData(tile.x(), tile.y()));
+    context.tilePosition = rect.topLeft();
+    context.tileDataPtr = reinterpret_cast<Data*>(accessor.tileRawData(tile.x(), tile.y()));
 
     // Process the tile and its neighborhood in three passes:
     // Top (the top guard bands)
     for (int y = y1; y <= rect.top() - 1; ++y) {
-        distanceSearchRowInnerLoop(boundsCheck, y, x1Top, x2Top);
+        distanceSearchRowInnerLoop(context, boundsCheck, y, x1Top, x2Top);
     }
     // Middle (the left guard band and the tile)
     for (int y = rect.top(); y <= rect.bottom(); ++y) {
-        distanceSearchRowInnerLoop(boundsCheck, y, x1Middle, x2Middle);
+        distanceSearchRowInnerLoop(context, boundsCheck, y, x1Middle, x2Middle);
     }
     // Bottom (the bottom guard bands)
     for (int y = rect.bottom() + 1; y <= y2; ++y) {
-        distanceSearchRowInnerLoop(boundsCheck, y, x1Bottom, x2Bottom);
+        distanceSearchRowInnerLoop(context, boundsCheck, y, x1Bottom, x2Bottom);
     }
-
-#if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
-    m_distanceElapsedNanos += timer.nsecsElapsed();
-#endif
 }
 
 /**
@@ -278,10 +401,10 @@ void KisGapMap::loadDistanceTile(const QPoint& tile, const QRect& nearbyTilesRec
  * - Lastly, only some points in the half circle will be modified, it depends on the opacity checks.
  */
 template<bool BoundsCheck, typename CoordinateTransform>
-void KisGapMap::gapDistanceSearch(int x, int y, CoordinateTransform op)
+void KisGapMap::gapDistanceSearch(TileContext& context, int x, int y, CoordinateTransform op)
 {
-    if (isOpaque<BoundsCheck>(op(x, y, 0, -1)) ||
-        isOpaque<BoundsCheck>(op(x, y, 1, -1))) {
+    if (isOpaque<BoundsCheck>(context.accessor, op(x, y, 0, -1)) ||
+        isOpaque<BoundsCheck>(context.accessor, op(x, y, 1, -1))) {
         return;
     }
 
@@ -295,36 +418,36 @@ void KisGapMap::gapDistanceSearch(int x, int y, CoordinateTransform op)
                 break;
             }
 
-            if (isOpaque<BoundsCheck>(op(x, y, xoffs, -yoffs))) {
+            if (isOpaque<BoundsCheck>(context.accessor, op(x, y, xoffs, -yoffs))) {
                 const float dx = static_cast<float>(xoffs) / (yoffs - 1);
                 float tx = 0;
                 int cx = 0;
 
                 for (int cy = 1; cy < yoffs; ++cy) {
-                    updateDistance(op(x, y, cx, -cy), offsetDistance);
+                    updateDistance(context, op(x, y, cx, -cy), offsetDistance);
 
                     tx += dx;
                     if (static_cast<int>(tx) > cx) {
                         cx++;
-                        updateDistance(op(x, y, cx, -cy), offsetDistance);
+                        updateDistance(context, op(x, y, cx, -cy), offsetDistance);
                     }
 
-                    updateDistance(op(x, y, cx + 1, -cy), offsetDistance);
+                    updateDistance(context, op(x, y, cx + 1, -cy), offsetDistance);
                 }
             }
         }
     }
 }
 
-void KisGapMap::updateDistance(const QPoint& globalPosition, quint16 newDistance)
+void KisGapMap::updateDistance(TileContext& context, const QPoint& globalPosition, quint16 newDistance)
 {
-    const QPoint p = globalPosition - m_tilePosition;
+    const QPoint p = globalPosition - context.tilePosition;
 
     if ((p.x() < 0) || (p.x() >= TileSize) || (p.y() < 0) || (p.y() >= TileSize)) {
         return;
     }
 
-    Data* ptr = m_tileDataPtr + p.x() + TileSize * p.y();
+    Data* ptr = context.tileDataPtr + p.x() + TileSize * p.y();
     if (ptr->distance > newDistance) {
         ptr->distance = newDistance;
     }
@@ -337,22 +460,21 @@ quint16 KisGapMap::lazyDistance(int x, int y)
     qDebug() << "lazyDistance() at (" << x << "," << y << ")";
 #endif
 
-    const int tx = x / TileSize;
-    const int ty = y / TileSize;
+    const QPoint tile(x / TileSize, y / TileSize);
 
-    // Clamped tile neighborhood.
-    const QPoint topLeft(qMax(0, tx - 1),
-                         qMax(0, ty - 1));
-    const QPoint bottomRight(qMin(tx + 1, m_numTiles.width() - 1),
-                             qMin(ty + 1, m_numTiles.height() - 1));
-    const QRect nearbyTiles = QRect(topLeft, bottomRight);
+    // The fill usually spreads to the neighboring tiles, so their distances
+    // are calculated together with the requested one, concurrently.
+    const QRect distanceTiles = nearbyTilesRect(tile, 1);
 
-    // For opacity data, we always load all the adjacent tiles (up to 9 tiles in total).
-    loadOpacityTiles(nearbyTiles);
+    // Each of them needs the opacity data of all its adjacent tiles. At the
+    // maximum gap size, the search also reaches one column of pixels two tiles
+    // to the left, it should be loaded too to make the result independent of
+    // the order the tiles are requested in.
+    const QRect opacityTiles = distanceTiles.adjusted(-2, -1, 1, 1) & QRect(QPoint(), m_numTiles);
 
-    // For distance data, we always load a single tile.
-    loadDistanceTile(QPoint(tx, ty), nearbyTiles, m_gapSize);
+    loadOpacityTiles(opacityTiles);
+    loadDistanceTiles(distanceTiles);
 
     // The data is now ready to be returned.
-    return dataPtr(x, y)->distance;
+    return dataPtr(*m_accessor, x, y)->distance;
 }
@@ -11,6 +11,7 @@
 #include <KoAlwaysInline.h>
 #include <kis_shared.h>
 #include <QRect>
+#include <QVector>
 #include <kis_paint_device.h>
 #include <kis_random_accessor_ng.h>
 
@@ -108,12 +109,15 @@ public:
     /** Query the gap distance at a pixel.
      *  (x, y) are the filled region's coordinates, always starting at (0, 0).
      *
+     *  When the distance is not available yet, the distances of the tile
+     *  and its neighbors are calculated concurrently.
+     *
      *  Important: This function is not thread-safe.
      */
     ALWAYS_INLINE quint16 distance(int x, int y)
     {
         if (isDistanceAvailable(x, y)) {
-            return dataPtr(x, y)->distance;
+            return dataPtr(*m_accessor, x, y)->distance;
         } else {
             return lazyDistance(x, y);
         }
@@ -124,6 +128,35 @@ public:
         return m_gapSize;
     }
 
+    ALWAYS_INLINE QSize size() const
+    {
+        return m_size;
+    }
+
+    /** Replace the opacity callback, e.g. when the map is reused by another fill.
+     *  The new callback must produce the same opacity as the previous one.
+     *
+     *  The callback may be called concurrently for different tiles.
+     *  An empty callback makes the map refuse to load new tiles.
+     */
+    void setFillOpacityFunc(const FillOpacityFunc& fillOpacityFunc);
+
+    /** @return the rects of the tiles whose opacity has been loaded,
+     *  in the filled region's coordinates.
+     */
+    QVector<QRect> loadedTileRects();
+
+    /** @return the amount of memory used by the loaded tiles in bytes.
+     */
+    qint64 memoryUsage();
+
+    /** Forget the data of the tiles, whose pixels have changed. The rects
+     *  must be the ones returned by loadedTileRects(). The distances of the
+     *  neighboring tiles depend on the opacity of these tiles, so they are
+     *  forgotten as well.
+     */
+    void invalidateTileRects(const QVector<QRect>& rects);
+
 #if KIS_GAP_MAP_MEASURE_ELAPSED_TIME
 public:
     quint64 opacityElapsedMillis() const
@@ -163,47 +196,65 @@ private:
     };
     static_assert(sizeof(Data) == sizeof(quint32));
 
+    /** The state of the distance calculation of a single tile, so that
+     *  several tiles can be calculated concurrently.
+     */
+    struct TileContext
+    {
+        TileContext(KisPaintDeviceSP& paintDevice)
+            : accessor(paintDevice)
+        {
+        }
+
+        KisTileOptimizedAccessor accessor;
+        QPoint tilePosition;    ///< The position of the computed tile compared to the whole region
+        Data* tileDataPtr {nullptr};  ///< The pointer to the computed tile data
+    };
+
     void loadOpacityTiles(const QRect& tileRect);
-    void loadDistanceTile(const QPoint& tile, const QRect& nearbyTilesRect, int guardBand);
-    void distanceSearchRowInnerLoop(bool boundsCheck, int y, int x1, int x2);
+    void loadDistanceTiles(const QRect& tileRect);
+    void loadDistanceTile(TileContext& context, const QPoint& tile, const QRect& nearbyTilesRect, int guardBand);
+    void distanceSearchRowInnerLoop(TileContext& context, bool boundsCheck, int y, int x1, int x2);
     quint16 lazyDistance(int x, int y);
 
+    QRect nearbyTilesRect(const QPoint& tile, int radius) const;
+    QRect tileRect(const QPoint& tile) const;
+
     // Templates are used to generate optimized versions of the same function
     // (i.e., the if conditions can be removed at compilation time).
 
     template<bool BoundsCheck, typename CoordinateTransform>
-    void gapDistanceSearch(int x, int y, CoordinateTransform op);
+    void gapDistanceSearch(TileContext& context, int x, int y, CoordinateTransform op);
 
-    template<bool BoundsCheck> ALWAYS_INLINE bool isOpaque(int x, int y);
-    template<bool BoundsCheck> ALWAYS_INLINE bool isOpaque(const QPoint& p);
-    void updateDistance(const QPoint& globalPosition, quint16 newDistance);
+    template<bool BoundsCheck> ALWAYS_INLINE bool isOpaque(KisTileOptimizedAccessor& accessor, int x, int y);
+    template<bool BoundsCheck> ALWAYS_INLINE bool isOpaque(KisTileOptimizedAccessor& accessor, const QPoint& p);
+    void updateDistance(TileContext& context, const QPoint& globalPosition, quint16 newDistance);
 
     ALWAYS_INLINE bool isDistanceAvailable(int x, int y)
     {
-        return (*tileFlagsPtr(x / TileSize, y / TileSize) & TILE_DISTANCE_LOADED) != 0;
+        return (*tileFlagsPtr(*m_accessor, x / TileSize, y / TileSize) & TILE_DISTANCE_LOADED) != 0;
     }
 
-    ALWAYS_INLINE Data* dataPtr(int x, int y)
+    ALWAYS_INLINE static Data* dataPtr(KisTileOptimizedAccessor& accessor, int x, int y)
     {
-        return reinterpret_cast<Data*>(m_accessor->rawData(x, y));
+        return reinterpret_cast<Data*>(accessor.rawData(x, y));
     }
 
-    ALWAYS_INLINE TileFlags* tileFlagsPtr(int tileX, int tileY)
+    ALWAYS_INLINE static TileFlags* tileFlagsPtr(KisTileOptimizedAccessor& accessor, int tileX, int tileY)
     {
         return reinterpret_cast<TileFlags*>(
-            m_accessor->tileRawData(tileX, tileY) + offsetof(Data, flags));
+            accessor.tileRawData(tileX, tileY) + offsetof(Data, flags));
     }
 
     const int m_gapSize;                      ///< Gap size in pixels for this map
     const QSize m_size;                       ///< Size in pixels of the opacity/gap map
     const QSize m_numTiles;                   ///< Map size in tiles
-    const FillOpacityFunc m_fillOpacityFunc;  ///< A callback to get the opacity data from the fill class
-
-    QPoint m_tilePosition;                    ///< The position of the currently computed tile compared to the whole region
-    Data* m_tileDataPtr;                      ///< The pointer to the currently computed tile data
+    FillOpacityFunc m_fillOpacityFunc;        ///< A callback to get the opacity data from the fill class
 
     KisPaintDeviceSP m_deviceSp;                            ///< A 32-bit per pixel paint device that holds the distance and other data
-    std::unique_ptr<KisTileOptimizedAccessor> m_accessor;   ///< An accessor for the paint device
+    std::unique_ptr<KisTileOptimizedAccessor> m_accessor;   ///< An accessor for the paint device used by the calling thread
 };
 
+typedef KisSharedPtr<KisGapMap> KisGapMapSP;
+
 #endif /* __KIS_GAP_MAP_H */
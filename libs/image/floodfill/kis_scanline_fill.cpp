@@ -19,7 +19,14 @@
 #include "kis_fill_sanity_checks.h"
 #include <KisColorSelectionPolicies.h>
 #include "kis_gap_map.h"
+#include "kis_fill_region_label_map_p.h"
+#include "kis_algebra_2d.h"
+#include "krita_utils.h"
+#include <KisMpl.h>
+#include <algorithm>
+#include <memory>
 #include <queue>
+#include <vector>
 
 #define MEASURE_FILL_TIME 0
 #if MEASURE_FILL_TIME
@@ -28,8 +35,6 @@
 
 namespace {
 
-typedef KisSharedPtr<KisGapMap> KisGapMapSP;
-
 /**
  * A work item for the gap closing fill.
  * Can work as a seed point and as a next queued pixel to continue the fill.
@@ -60,7 +65,19 @@ public:
 
     BasePixelAccessPolicy(KisPaintDeviceSP sourceDevice)
         : m_srcIt(sourceDevice->createRandomAccessorNG())
+        , m_sourceDevice(sourceDevice)
+    {}
+
+    /**
+     * Every copy of a policy creates its own accessors, so
+     * the copies can be used by different threads
+     */
+    BasePixelAccessPolicy(const BasePixelAccessPolicy &rhs)
+        : BasePixelAccessPolicy(rhs.m_sourceDevice)
     {}
+
+protected:
+    KisPaintDeviceSP m_sourceDevice;
 };
 
 class ConstBasePixelAccessPolicy
@@ -72,7 +89,15 @@ public:
 
     ConstBasePixelAccessPolicy(KisPaintDeviceSP sourceDevice)
         : m_srcIt(sourceDevice->createRandomConstAccessorNG())
+        , m_sourceDevice(sourceDevice)
+    {}
+
+    ConstBasePixelAccessPolicy(const ConstBasePixelAccessPolicy &rhs)
+        : ConstBasePixelAccessPolicy(rhs.m_sourceDevice)
     {}
+
+protected:
+    KisPaintDeviceSP m_sourceDevice;
 };
 
 class CopyToSelectionPixelAccessPolicy : public ConstBasePixelAccessPolicy
@@ -84,6 +109,10 @@ public:
         , m_selectionIterator(m_pixelSelection->createRandomAccessorNG())
     {}
 
+    CopyToSelectionPixelAccessPolicy(const CopyToSelectionPixelAccessPolicy &rhs)
+        : CopyToSelectionPixelAccessPolicy(rhs.m_sourceDevice, rhs.m_pixelSelection)
+    {}
+
     ALWAYS_INLINE void fillPixel(quint8 *dstPtr, quint8 opacity, int x, int y)
     {
         Q_UNUSED(dstPtr);
@@ -106,6 +135,10 @@ public:
         , m_pixelSize(m_fillColor.colorSpace()->pixelSize())
     {}
 
+    FillWithColorPixelAccessPolicy(const FillWithColorPixelAccessPolicy &rhs)
+        : FillWithColorPixelAccessPolicy(rhs.m_sourceDevice, rhs.m_fillColor)
+    {}
+
     ALWAYS_INLINE void fillPixel(quint8 *dstPtr, quint8 opacity, int x, int y)
     {
         Q_UNUSED(x);
@@ -136,6 +169,10 @@ public:
         , m_pixelSize(m_fillColor.colorSpace()->pixelSize())
     {}
 
+    FillWithColorExternalPixelAccessPolicy(const FillWithColorExternalPixelAccessPolicy &rhs)
+        : FillWithColorExternalPixelAccessPolicy(rhs.m_sourceDevice, rhs.m_fillColor, rhs.m_externalDevice)
+    {}
+
     ALWAYS_INLINE void fillPixel(quint8 *dstPtr, quint8 opacity, int x, int y)
     {
         Q_UNUSED(dstPtr);
@@ -181,9 +218,14 @@ public:
     MaskedSelectionPolicy(BaseSelectionPolicy baseSelectionPolicy,
                           KisPaintDeviceSP maskDevice)
         : m_baseSelectionPolicy(baseSelectionPolicy)
+        , m_maskDevice(maskDevice)
         , m_maskIterator(maskDevice->createRandomConstAccessorNG())
     {}
 
+    MaskedSelectionPolicy(const MaskedSelectionPolicy &rhs)
+        : MaskedSelectionPolicy(rhs.m_baseSelectionPolicy, rhs.m_maskDevice)
+    {}
+
     ALWAYS_INLINE quint8 opacityFromDifference(quint8 difference, int x, int y)
     {
         m_maskIterator->moveTo(x, y);
@@ -198,6 +240,7 @@ public:
 
 private:
     BaseSelectionPolicy m_baseSelectionPolicy;
+    KisPaintDeviceSP m_maskDevice;
     KisRandomConstAccessorSP m_maskIterator;
 };
 
@@ -242,11 +285,16 @@ public:
                                 qint32 groupIndex)
         : BasePixelAccessPolicy(scribbleDevice)
         , m_groupIndex(groupIndex)
+        , m_groupMapDevice(groupMapDevice)
         , m_groupMapIt(groupMapDevice->createRandomAccessorNG())
     {
         KIS_SAFE_ASSERT_RECOVER_NOOP(m_groupIndex > 0);
     }
 
+    GroupSplitPixelAccessPolicy(const GroupSplitPixelAccessPolicy &rhs)
+        : GroupSplitPixelAccessPolicy(rhs.m_sourceDevice, rhs.m_groupMapDevice, rhs.m_groupIndex)
+    {}
+
     ALWAYS_INLINE void fillPixel(quint8 *dstPtr, quint8 opacity, int x, int y)
     {
         Q_UNUSED(opacity);
@@ -269,9 +317,204 @@ public:
 
 private:
     qint32 m_groupIndex;
+    KisPaintDeviceSP m_groupMapDevice;
     KisRandomAccessorSP m_groupMapIt;
 };
 
+/**
+ * Split the pixels with non-zero \p opacity into 4-connected groups
+ * and write the indexes of the groups into \p labels
+ *
+ * @return the number of the groups
+ */
+int labelFillPatch(const quint8 *opacity, quint16 *labels, int width, int height)
+{
+    const int numPixels = width * height;
+    std::fill(labels, labels + numPixels, KisFillPatch::NoLabel);
+
+    QVector<int> stack;
+    int numLabels = 0;
+
+    for (int i = 0; i < numPixels; i++) {
+        if (!opacity[i] || labels[i] != KisFillPatch::NoLabel) continue;
+
+        const quint16 label = numLabels++;
+
+        auto tryPush = [&] (int index) {
+            if (opacity[index] && labels[index] == KisFillPatch::NoLabel) {
+                labels[index] = label;
+                stack.append(index);
+            }
+        };
+
+        tryPush(i);
+
+        while (!stack.isEmpty()) {
+            const int index = stack.takeLast();
+            const int x = index % width;
+
+            if (x > 0) tryPush(index - 1);
+            if (x < width - 1) tryPush(index + 1);
+            if (index >= width) tryPush(index - width);
+            if (index < numPixels - width) tryPush(index + width);
+        }
+    }
+
+    return numLabels;
+}
+
+template <typename PixelAccessPolicy, typename Func>
+void forEachPatchPixel(const QRect &rect, int pixelSize,
+                       PixelAccessPolicy &pixelAccessPolicy, Func func)
+{
+    int index = 0;
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        int numPixelsLeft = 0;
+        quint8 *dataPtr = 0;
+
+        for (int x = rect.left(); x <= rect.right(); ++x) {
+            if (numPixelsLeft <= 0) {
+                pixelAccessPolicy.m_srcIt->moveTo(x, y);
+                numPixelsLeft = pixelAccessPolicy.m_srcIt->numContiguousColumns(x) - 1;
+                dataPtr = const_cast<quint8*>(pixelAccessPolicy.m_srcIt->rawDataConst());
+            } else {
+                numPixelsLeft--;
+                dataPtr += pixelSize;
+            }
+
+            func(dataPtr, x, y, index++);
+        }
+    }
+}
+
+/**
+ * Fill the pixels of the groups of \p patch marked in \p labelMask
+ *
+ * @return the extent of the filled pixels
+ */
+template <typename PixelAccessPolicy>
+QRect fillPatchPixels(const KisFillPatch *patch, const QVector<bool> &labelMask,
+                      int pixelSize, PixelAccessPolicy &pixelAccessPolicy)
+{
+    const QRect &rect = patch->rect;
+
+    int left = rect.right();
+    int right = rect.left();
+    int top = rect.bottom();
+    int bottom = rect.top();
+
+    const quint16 *labels = patch->labels.constData();
+    const quint8 *opacity = patch->opacity.constData();
+    const bool isUniform = patch->labels.isEmpty();
+
+    forEachPatchPixel(rect, pixelSize, pixelAccessPolicy,
+        [&] (quint8 *pixelPtr, int x, int y, int index) {
+            if (isUniform) {
+                pixelAccessPolicy.fillPixel(pixelPtr, patch->uniformOpacity, x, y);
+            } else if (labels[index] != KisFillPatch::NoLabel && labelMask[labels[index]]) {
+                pixelAccessPolicy.fillPixel(pixelPtr, opacity[index], x, y);
+            } else {
+                return;
+            }
+
+            left = qMin(left, x);
+            right = qMax(right, x);
+            top = qMin(top, y);
+            bottom = qMax(bottom, y);
+        });
+
+    return left <= right ? QRect(QPoint(left, top), QPoint(right, bottom)) : QRect();
+}
+
+/**
+ * Add the groups of \p patch reached by its seeds to \p region, fill
+ * them and pass the seeds over to the neighbouring patches. The policies
+ * are passed by value, so every call has its own copies with their own
+ * accessors.
+ */
+template <typename DifferencePolicy, typename SelectionPolicy, typename PixelAccessPolicy>
+void processFillPatch(KisFillPatch *patch, int region, const QRect &boundingRect,
+                      int pixelSize, bool keepCompletePatches,
+                      DifferencePolicy differencePolicy,
+                      SelectionPolicy selectionPolicy,
+                      PixelAccessPolicy pixelAccessPolicy)
+{
+    const QRect &rect = patch->rect;
+
+    if (!patch->isLabeled) {
+        patch->opacity.resize(rect.width() * rect.height());
+        quint8 *opacity = patch->opacity.data();
+
+        forEachPatchPixel(rect, pixelSize, pixelAccessPolicy,
+            [&] (quint8 *pixelPtr, int x, int y, int index) {
+                const quint8 difference = differencePolicy.difference(pixelPtr);
+                opacity[index] = selectionPolicy.opacityFromDifference(difference, x, y);
+            });
+
+        const quint8 firstOpacity = opacity[0];
+        const bool isUniform =
+            std::all_of(opacity, opacity + patch->opacity.size(),
+                        [firstOpacity] (quint8 value) { return value == firstOpacity; });
+
+        if (isUniform) {
+            patch->numLabels = firstOpacity ? 1 : 0;
+            patch->uniformOpacity = firstOpacity;
+            patch->opacity.clear();
+        } else {
+            patch->labels.resize(patch->opacity.size());
+            patch->numLabels = labelFillPatch(opacity, patch->labels.data(), rect.width(), rect.height());
+        }
+
+        patch->regionOfLabel.fill(-1, patch->numLabels);
+        patch->isLabeled = true;
+    }
+
+    QVector<bool> isNewLabel(patch->numLabels, false);
+    bool hasNewLabels = false;
+
+    Q_FOREACH (const QPoint &pt, patch->seeds) {
+        const int label = patch->labelAt(pt);
+        if (label >= 0 && patch->regionOfLabel[label] < 0) {
+            patch->regionOfLabel[label] = region;
+            patch->numResolvedLabels++;
+            isNewLabel[label] = true;
+            hasNewLabels = true;
+        }
+    }
+    patch->seeds.clear();
+    patch->fillExtent = QRect();
+
+    if (!hasNewLabels) return;
+
+    patch->fillExtent = fillPatchPixels(patch, isNewLabel, pixelSize, pixelAccessPolicy);
+
+    auto passSeed = [&] (const QPoint &pt, const QPoint &offset) {
+        const QPoint neighbour = pt + offset;
+        if (!boundingRect.contains(neighbour)) return;
+
+        const int label = patch->labelAt(pt);
+        if (label >= 0 && isNewLabel[label]) {
+            patch->outgoingSeeds.append(neighbour);
+        }
+    };
+
+    for (int x = rect.left(); x <= rect.right(); ++x) {
+        passSeed(QPoint(x, rect.top()), QPoint(0, -1));
+        passSeed(QPoint(x, rect.bottom()), QPoint(0, 1));
+    }
+
+    for (int y = rect.top(); y <= rect.bottom(); ++y) {
+        passSeed(QPoint(rect.left(), y), QPoint(-1, 0));
+        passSeed(QPoint(rect.right(), y), QPoint(1, 0));
+    }
+
+    if (!keepCompletePatches && patch->isComplete()) {
+        patch->opacity.clear();
+        patch->labels.clear();
+    }
+}
+
 } // anonymous namespace
 
 struct Q_DECL_HIDDEN KisScanlineFill::Private
@@ -291,6 +534,17 @@ struct Q_DECL_HIDDEN KisScanlineFill::Private
 
     QRect fillExtent;
 
+    bool useParallelEngine;
+
+    enum RegionLabelMapMethod {
+        SimilarColorRegion = 0,
+        UntilColorRegion,
+        UntilColorOrTransparentRegion
+    };
+
+    KisFillRegionLabelMapSP regionLabelMap;
+    KisFillRegionLabelMap::Private::Key regionLabelMapKey;
+
     // The priority queue is required to correctly handle the fill "expansion" case
     // (starting in a corner and filling towards open areas, where distance is DISTANCE_INFINITE).
     // Holds the next pixel to consider for filling, among with the contextual information.
@@ -326,6 +580,8 @@ KisScanlineFill::KisScanlineFill(KisPaintDeviceSP device, const QPoint &startPoi
     m_d->threshold = 0;
     m_d->opacitySpread = 0;
     m_d->closeGap = 0;
+
+    m_d->useParallelEngine = true;
 }
 
 KisScanlineFill::~KisScanlineFill()
@@ -347,6 +603,32 @@ void KisScanlineFill::setCloseGap(int closeGap)
     m_d->closeGap = closeGap;
 }
 
+void KisScanlineFill::setUseParallelEngine(bool value)
+{
+    m_d->useParallelEngine = value;
+}
+
+void KisScanlineFill::setRegionLabelMap(KisFillRegionLabelMapSP map)
+{
+    m_d->regionLabelMap = map;
+}
+
+void KisScanlineFill::prepareRegionLabelMapKey(int method, const KoColor &referenceColor,
+                                               KisPaintDeviceSP boundarySelection)
+{
+    KisFillRegionLabelMap::Private::Key &key = m_d->regionLabelMapKey;
+
+    key.method = method;
+    key.referenceColor = QByteArray(reinterpret_cast<const char*>(referenceColor.data()),
+                                    referenceColor.colorSpace()->pixelSize());
+    key.threshold = m_d->threshold;
+    key.opacitySpread = m_d->opacitySpread;
+    key.boundingRect = m_d->boundingRect;
+    key.boundarySelection = boundarySelection;
+    key.boundarySelectionSequenceNumber =
+        boundarySelection ? boundarySelection->sequenceNumber() : -1;
+}
+
 QRect KisScanlineFill::fillExtent() const
 {
     return m_d->fillExtent;
@@ -630,6 +912,17 @@ void KisScanlineFill::runImpl(DifferencePolicy &differencePolicy,
         gapSize = 0;
     }
 
+    /**
+     * The gap closing fill depends on the order the pixels are
+     * reached in, so it is done by the sequential algorithm only
+     */
+    if (m_d->useParallelEngine && gapSize == 0 &&
+        m_d->boundingRect.contains(m_d->startPoint)) {
+
+        runParallelImpl(differencePolicy, selectionPolicy, pixelAccessPolicy);
+        return;
+    }
+
 #if MEASURE_FILL_TIME
     QElapsedTimer timerTotal;
     QElapsedTimer timerScanlineFill;
@@ -640,16 +933,39 @@ void KisScanlineFill::runImpl(DifferencePolicy &differencePolicy,
     timerTotal.start();
 #endif
 
+    const bool useSharedGapMap =
+        gapSize > 0 && m_d->regionLabelMap && m_d->regionLabelMapKey.method >= 0;
+
+    // The shared gap map is used by this fill until the very end
+    QMutexLocker gapMapLocker(useSharedGapMap ? &m_d->regionLabelMap->m_d->mutex : nullptr);
+
+    auto finishSharedMap = kismpl::finally([&] () {
+        if (useSharedGapMap) {
+            m_d->regionLabelMap->m_d->finishFill();
+        }
+    });
+
     if (gapSize > 0) {
         // We need to reuse the complex policies used by this class and only provide the final
-        // "projection" of opacity for the distance map calculation.
+        // "projection" of opacity for the distance map calculation. The tiles of the map are
+        // loaded concurrently, so every call gets its own copy of the policies.
         auto opacityFunc = [&](KisPaintDevice* devicePtr, const QRect& rect) {
-            return fillOpacity(differencePolicy, selectionPolicy, pixelAccessPolicy, devicePtr, rect);
+            DifferencePolicy localDifferencePolicy(differencePolicy);
+            SelectionPolicy localSelectionPolicy(selectionPolicy);
+            PixelAccessPolicy localPixelAccessPolicy(pixelAccessPolicy);
+            return fillOpacity(localDifferencePolicy, localSelectionPolicy, localPixelAccessPolicy, devicePtr, rect);
         };
 
         // Prime the resources. The computations are made lazily, when distance at a pixel is requested.
-        // Resources are freed automatically when the object is destroyed, that is together with the KisScanlineFill object.
-        m_d->gapMapSp = KisGapMapSP(new KisGapMap(gapSize, m_d->boundingRect, opacityFunc));
+        if (useSharedGapMap) {
+            // The distances calculated by the previous fills of the same device are reused
+            m_d->regionLabelMapKey.boundingRect = m_d->boundingRect;
+            m_d->gapMapSp = m_d->regionLabelMap->m_d->prepareGapMap(m_d->regionLabelMapKey, gapSize,
+                                                                    m_d->device, opacityFunc);
+        } else {
+            // Resources are freed automatically when the object is destroyed, that is together with the KisScanlineFill object.
+            m_d->gapMapSp = KisGapMapSP(new KisGapMap(gapSize, m_d->boundingRect, opacityFunc));
+        }
     }
 
     m_d->fillExtent = QRect();
@@ -743,6 +1059,150 @@ void KisScanlineFill::runImpl(DifferencePolicy &differencePolicy,
 #endif
 }
 
+/**
+ * The parallel fill engine. The area is split into tile-aligned patches,
+ * which are labeled into connected groups of pixels when the fill reaches
+ * them. The fill spreads in waves: every wave processes the patches
+ * reached by the previous one concurrently, fills the groups of the
+ * incoming seeds and passes the seeds over the patch borders.
+ *
+ * Only the patches touched by the filled area are processed, and the
+ * filled pixels and their opacity are exactly the same as the ones
+ * of the scanline algorithm.
+ *
+ * The selection fills may keep the patches and the found regions in
+ * a KisFillRegionLabelMap shared with other fills. Then a fill that
+ * starts in an already known region only writes its pixels.
+ */
+template <typename DifferencePolicy, typename SelectionPolicy, typename PixelAccessPolicy>
+void KisScanlineFill::runParallelImpl(DifferencePolicy &differencePolicy,
+                                      SelectionPolicy &selectionPolicy,
+                                      PixelAccessPolicy &pixelAccessPolicy)
+{
+    const QRect &boundingRect = m_d->boundingRect;
+    const int pixelSize = m_d->device->pixelSize();
+
+    m_d->regionLabelMapKey.boundingRect = boundingRect;
+
+    const bool useSharedMap =
+        m_d->regionLabelMap && m_d->regionLabelMapKey.method >= 0;
+
+    KisFillRegionLabelMap::Private localMap;
+    KisFillRegionLabelMap::Private *map =
+        useSharedMap ? m_d->regionLabelMap->m_d.data() : &localMap;
+
+    QMutexLocker locker(useSharedMap ? &map->mutex : nullptr);
+
+    auto finishSharedMap = kismpl::finally([&] () {
+        if (useSharedMap) {
+            map->finishFill();
+        }
+    });
+
+    if (useSharedMap) {
+        map->prepare(m_d->regionLabelMapKey, m_d->device);
+    } else {
+        map->isPersistent = false;
+        map->reset(m_d->regionLabelMapKey);
+    }
+
+    m_d->fillExtent = QRect();
+
+    const int startIndex = map->patchIndex(m_d->startPoint);
+    KisFillPatch *startPatch = map->patches[startIndex].get();
+
+    if (startPatch && startPatch->isLabeled) {
+        const int label = startPatch->labelAt(m_d->startPoint);
+        if (label < 0) return;
+
+        const int knownRegion = startPatch->regionOfLabel[label];
+
+        if (knownRegion >= 0) {
+            const KisFillRegionLabelMap::Private::Region &region = map->regions[knownRegion];
+
+            KritaUtils::processConcurrently(region.patches.size(),
+                [&] (int i) {
+                    const KisFillPatch *patch = map->patches[region.patches.at(i)].get();
+
+                    QVector<bool> labelMask(patch->numLabels);
+                    for (int j = 0; j < patch->numLabels; j++) {
+                        labelMask[j] = patch->regionOfLabel.at(j) == knownRegion;
+                    }
+
+                    PixelAccessPolicy pap(pixelAccessPolicy);
+                    fillPatchPixels(patch, labelMask, pixelSize, pap);
+                });
+
+            m_d->fillExtent = region.extent;
+            map->numHits++;
+            return;
+        }
+    }
+
+    const int regionIndex = map->regions.size();
+    map->regions.append(KisFillRegionLabelMap::Private::Region());
+
+    QVector<int> regionPatches;
+    QVector<int> wave;
+
+    auto addSeed = [&] (const QPoint &pt) {
+        const int index = map->patchIndex(pt);
+        std::unique_ptr<KisFillPatch> &patch = map->patches[index];
+
+        if (!patch) {
+            patch.reset(new KisFillPatch());
+            patch->rect = map->patchRect(index);
+        } else if (patch->isLabeled) {
+            if (patch->isComplete()) return;
+
+            const int label = patch->labelAt(pt);
+            if (label < 0 || patch->regionOfLabel[label] >= 0) return;
+        }
+
+        if (patch->seeds.isEmpty()) {
+            wave.append(index);
+        }
+        patch->seeds.append(pt);
+    };
+
+    addSeed(m_d->startPoint);
+
+    while (!wave.isEmpty()) {
+        QVector<int> currentWave;
+        std::swap(currentWave, wave);
+
+        KritaUtils::processConcurrently(currentWave.size(),
+            [&] (int i) {
+                processFillPatch(map->patches[currentWave.at(i)].get(), regionIndex,
+                                 boundingRect, pixelSize, map->isPersistent,
+                                 differencePolicy, selectionPolicy, pixelAccessPolicy);
+            });
+
+        Q_FOREACH (int index, currentWave) {
+            KisFillPatch *patch = map->patches[index].get();
+
+            if (!patch->fillExtent.isEmpty()) {
+                m_d->fillExtent |= patch->fillExtent;
+
+                if (patch->lastFilledRegion != regionIndex) {
+                    patch->lastFilledRegion = regionIndex;
+                    regionPatches.append(index);
+                }
+            }
+
+            Q_FOREACH (const QPoint &pt, patch->outgoingSeeds) {
+                addSeed(pt);
+            }
+            patch->outgoingSeeds.clear();
+        }
+    }
+
+    if (!regionPatches.isEmpty()) {
+        map->regions[regionIndex].patches = regionPatches;
+        map->regions[regionIndex].extent = m_d->fillExtent;
+    }
+}
+
 template <template <typename SrcPixelType> typename OptimizedDifferencePolicy,
           typename SlowDifferencePolicy,
           typename SelectionPolicy, typename PixelAccessPolicy>
@@ -841,6 +1301,7 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection, KisPaint
     using namespace KisColorSelectionPolicies;
 
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
+    prepareRegionLabelMapKey(Private::SimilarColorRegion, srcColor, boundarySelection);
 
     if (m_d->closeGap > 0) {
         m_d->filledSelectionIterator = pixelSelection->createRandomAccessorNG();
@@ -868,6 +1329,7 @@ void KisScanlineFill::fillSelection(KisPixelSelectionSP pixelSelection)
     using namespace KisColorSelectionPolicies;
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
+    prepareRegionLabelMapKey(Private::SimilarColorRegion, srcColor, 0);
 
     if (m_d->closeGap > 0) {
         m_d->filledSelectionIterator = pixelSelection->createRandomAccessorNG();
@@ -894,6 +1356,7 @@ void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection
     using namespace KisColorSelectionPolicies;
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
+    prepareRegionLabelMapKey(Private::UntilColorRegion, srcColor, boundarySelection);
 
     if (m_d->closeGap > 0) {
         m_d->filledSelectionIterator = pixelSelection->createRandomAccessorNG();
@@ -922,6 +1385,7 @@ void KisScanlineFill::fillSelectionUntilColor(KisPixelSelectionSP pixelSelection
     using namespace KisColorSelectionPolicies;
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
+    prepareRegionLabelMapKey(Private::UntilColorRegion, srcColor, 0);
 
     if (m_d->closeGap > 0) {
         m_d->filledSelectionIterator = pixelSelection->createRandomAccessorNG();
@@ -950,6 +1414,7 @@ void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP p
     using namespace KisColorSelectionPolicies;
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
+    prepareRegionLabelMapKey(Private::UntilColorOrTransparentRegion, srcColor, boundarySelection);
 
     if (m_d->closeGap > 0) {
         m_d->filledSelectionIterator = pixelSelection->createRandomAccessorNG();
@@ -980,6 +1445,7 @@ void KisScanlineFill::fillSelectionUntilColorOrTransparent(KisPixelSelectionSP p
     using namespace KisColorSelectionPolicies;
     
     CopyToSelectionPixelAccessPolicy pap(m_d->device, pixelSelection);
+    prepareRegionLabelMapKey(Private::UntilColorOrTransparentRegion, srcColor, 0);
 
     if (m_d->closeGap > 0) {
         m_d->filledSelectionIterator = pixelSelection->createRandomAccessorNG();
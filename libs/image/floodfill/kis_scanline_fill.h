@@ -12,6 +12,7 @@
 #include <kritaimage_export.h>
 #include <kis_types.h>
 #include <kis_paint_device.h>
+#include "kis_fill_region_label_map.h"
 
 class KisFillInterval;
 class KisFillIntervalMap;
@@ -132,6 +133,27 @@ public:
      */
     void setCloseGap(int closeGap);
 
+    /**
+     * Set if the tile-parallel fill engine should be used. It is enabled
+     * by default. The engine splits the filled area into tiles, labels
+     * connected groups of pixels in the tiles concurrently and joins
+     * them across the tile borders, so the result is the same as the
+     * one of the scanline algorithm.
+     *
+     * The fills with non-zero close gap size always use the scanline
+     * algorithm.
+     */
+    void setUseParallelEngine(bool value);
+
+    /**
+     * Set the map that caches the regions found by the selection fills
+     * of the parallel engine. The map can be shared by several fills of
+     * the same device, e.g. by the consecutive clicks of the fill tool,
+     * so that a fill starting in an already known region doesn't need
+     * to look at the pixels again. See KisFillRegionLabelMap.
+     */
+    void setRegionLabelMap(KisFillRegionLabelMapSP map);
+
     /**
      * Returns the extent of the last filled region
      */
@@ -158,6 +180,11 @@ private:
                  SelectionPolicy &selectionPolicy,
                  PixelAccessPolicy &pixelAccessPolicy);
 
+    template <typename DifferencePolicy, typename SelectionPolicy, typename PixelAccessPolicy>
+    void runParallelImpl(DifferencePolicy &differencePolicy,
+                         SelectionPolicy &selectionPolicy,
+                         PixelAccessPolicy &pixelAccessPolicy);
+
     template <template <typename SrcPixelType> typename OptimizedDifferencePolicy,
               typename SlowDifferencePolicy,
               typename SelectionPolicy, typename PixelAccessPolicy>
@@ -179,6 +206,9 @@ private:
 
     inline bool tryPushingCloseGapSeed(int x, int y, bool allowExpand);
 
+    void prepareRegionLabelMapKey(int method, const KoColor &referenceColor,
+                                  KisPaintDeviceSP boundarySelection);
+
 private:
     void testingProcessLine(const KisFillInterval &processInterval);
     QVector<KisFillInterval> testingGetForwardIntervals() const;
@@ -132,7 +132,22 @@ void KisAdjustmentLayer::setChannelFlags(const QBitArray & channelFlags)
 
     if (filterConfig) {
         filterConfig->setChannelFlags(channelFlags);
+        filterResultCache()->invalidate();
     }
     KisLayer::setChannelFlags(channelFlags);
 }
 
+void KisAdjustmentLayer::setVisible(bool visible, bool loading)
+{
+    /**
+     * The hidden layer is skipped by the update walkers, so the
+     * filter result cache doesn't know about the changes of the
+     * layers below it
+     */
+    if (visible != this->visible(false)) {
+        filterResultCache()->invalidate();
+    }
+
+    KisSelectionBasedLayer::setVisible(visible, loading);
+}
+
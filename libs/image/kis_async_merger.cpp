@@ -27,6 +27,7 @@
 #include "kis_clone_layer.h"
 #include "kis_processing_information.h"
 #include "kis_busy_progress_indicator.h"
+#include "KisFilterResultCache.h"
 
 
 #include "kis_merge_walker.h"
@@ -48,9 +49,10 @@
 class KisUpdateOriginalVisitor : public KisNodeVisitor
 {
 public:
-    KisUpdateOriginalVisitor(const QRect &updateRect, KisPaintDeviceSP projection)
+    KisUpdateOriginalVisitor(const QRect &updateRect, KisPaintDeviceSP projection, bool sourceChanged)
         : m_updateRect(updateRect),
-          m_projection(projection)
+          m_projection(projection),
+          m_sourceChanged(sourceChanged)
         {
         }
 
@@ -110,7 +112,7 @@ public:
             layer->busyProgressIndicator()->update();
 
             // We do not create a transaction here, as srcDevice != dstDevice
-            filter->process(m_projection, dstDevice, 0, filterRect, filterConfig.data(), 0);
+            layer->filterResultCache()->process(filter, filterConfig, m_projection, dstDevice, filterRect, m_sourceChanged);
         }
 
         if (selection) {
@@ -163,8 +165,28 @@ public:
 private:
     QRect m_updateRect;
     KisPaintDeviceSP m_projection;
+    bool m_sourceChanged;
 };
 
+/**
+ * @return true if the layers below \p node might have changed
+ *         in the current walk, that is, if the projection it is
+ *         given as the source is not the same as the last time
+ */
+inline bool lowerNodesMightHaveChanged(KisNodeSP node, KisBaseRectsWalker &walker, qint32 position)
+{
+    if (!(position & KisMergeWalker::N_FILTHY)) return true;
+
+    /**
+     * The node is filthy itself, the walker has been started either
+     * on the node or on one of its masks. Full refresh walkers
+     * started on a parent make all the nodes filthy, so the source
+     * could have changed then.
+     */
+    KisNodeSP startNode = walker.startNode();
+    return !startNode || (startNode != node && startNode->parent() != node);
+}
+
 
 /*********************************************************************/
 /*                     KisAsyncMerger                                */
@@ -202,7 +224,8 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
 
             DEBUG_NODE_ACTION("Updating", "N_EXTRA", currentLeaf, applyRect);
             KisUpdateOriginalVisitor originalVisitor(applyRect,
-                                                     m_currentProjection);
+                                                     m_currentProjection,
+                                                     true);
             currentLeaf->accept(originalVisitor);
             currentLeaf->projectionPlane()->recalculate(applyRect, currentLeaf->node(), item.m_renderFlags);
 
@@ -215,7 +238,10 @@ void KisAsyncMerger::startMerge(KisBaseRectsWalker &walker, bool notifyClones) {
         }
 
         KisUpdateOriginalVisitor originalVisitor(applyRect,
-                                                 m_currentProjection);
+                                                 m_currentProjection,
+                                                 lowerNodesMightHaveChanged(currentLeaf->node(),
+                                                                            walker,
+                                                                            item.m_position));
 
         if(item.m_position & KisMergeWalker::N_FILTHY) {
             DEBUG_NODE_ACTION("Updating", "N_FILTHY", currentLeaf, applyRect);
@@ -39,6 +39,7 @@ struct Q_DECL_HIDDEN KisBaseProcessor::Private {
             , supportsPainting(false)
             , supportsAdjustmentLayers(true)
             , supportsThreading(true)
+            , supportsStreaming(false)
             , showConfigurationWidget(true)
             , colorSpaceIndependence(FULLY_INDEPENDENT) {
     }
@@ -52,6 +53,7 @@ struct Q_DECL_HIDDEN KisBaseProcessor::Private {
     bool supportsPainting;
     bool supportsAdjustmentLayers;
     bool supportsThreading;
+    bool supportsStreaming;
     bool showConfigurationWidget;
     ColorSpaceIndependence colorSpaceIndependence;
 };
@@ -145,6 +147,11 @@ bool KisBaseProcessor::supportsThreading() const
     return d->supportsThreading;
 }
 
+bool KisBaseProcessor::supportsStreaming() const
+{
+    return d->supportsStreaming;
+}
+
 ColorSpaceIndependence KisBaseProcessor::colorSpaceIndependence() const
 {
     return d->colorSpaceIndependence;
@@ -165,6 +172,11 @@ void KisBaseProcessor::setSupportsThreading(bool v)
     d->supportsThreading = v;
 }
 
+void KisBaseProcessor::setSupportsStreaming(bool v)
+{
+    d->supportsStreaming = v;
+}
+
 void KisBaseProcessor::setColorSpaceIndependence(ColorSpaceIndependence v)
 {
     d->colorSpaceIndependence = v;
@@ -122,6 +122,14 @@ public:
      */
     bool supportsThreading() const;
 
+    /**
+     * This filter can process any rect having only the pixels of
+     * neededRect() of it available. KisFilter::process() will then
+     * filter big areas in strips, keeping in memory only the current
+     * strip and its margins instead of a copy of the whole area.
+     */
+    bool supportsStreaming() const;
+
     /// If true, the filter wants to show a configuration widget
     bool showConfigurationWidget();
 
@@ -142,6 +150,7 @@ protected:
     void setSupportsPainting(bool v);
     void setSupportsAdjustmentLayers(bool v);
     void setSupportsThreading(bool v);
+    void setSupportsStreaming(bool v);
     void setColorSpaceIndependence(ColorSpaceIndependence v);
     void setShowConfigurationWidget(bool v);
 
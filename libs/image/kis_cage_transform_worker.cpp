@@ -354,14 +354,24 @@ void KisCageTransformWorker::run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP ds
         dstDevice->clearSelection(selection);
     }
 
-    GridIterationTools::PaintDevicePolygonOp polygonOp(srcDevice, tempDevice);
+    /**
+     * The polygons of the cells are collected first, since generating
+     * them for the incomplete cells needs the neighbouring points, and
+     * then the cells are painted concurrently
+     */
+    GridIterationTools::RecordingPolygonOp recordingOp;
     Private::MapIndexesOp indexesOp(m_d.data());
     GridIterationTools::iterateThroughGrid
-        <GridIterationTools::IncompletePolygonPolicy>(polygonOp, indexesOp,
+        <GridIterationTools::IncompletePolygonPolicy>(recordingOp, indexesOp,
                                                       m_d->gridSize,
                                                       m_d->validPoints,
                                                       transformedPoints);
 
+    GridIterationTools::processCellsConcurrently(srcDevice, tempDevice, recordingOp.cells.size(),
+        [&recordingOp] (int cellIndex, QPolygonF *srcPolygon, QPolygonF *dstPolygon, QPolygonF *clipDstPolygon) {
+            recordingOp.fetchCell(cellIndex, srcPolygon, dstPolygon, clipDstPolygon);
+        });
+
     QRect rect = tempDevice->extent();
     KisPainter gc(dstDevice);
     gc.bitBlt(rect.topLeft(), tempDevice, rect);
@@ -14,8 +14,13 @@
 
 #include "kis_convolution_worker.h"
 #include "kis_math_toolbox.h"
+#include "kis_datamanager.h"
 
 #include <QMutex>
+#include <QMutexLocker>
+#include <QHash>
+#include <QPair>
+#include <QSharedPointer>
 #include <QVector>
 #include <QTextStream>
 #include <QFile>
@@ -29,10 +34,85 @@ class KisConvolutionWorkerFFTLock
 private:
     static QMutex fftwMutex;
     template<class _IteratorFactory_> friend class KisConvolutionWorkerFFT;
+    friend class KisConvolutionWorkerFFTPlanCache;
 };
 
 QMutex KisConvolutionWorkerFFTLock::fftwMutex;
 
+/**
+ * FFTW planner is not thread-safe, but execution of the plans is. So
+ * we create the plans once for every block size and share them between
+ * all the workers, which then never need to take the planner lock.
+ */
+class KisConvolutionWorkerFFTPlanCache
+{
+public:
+    struct Plans {
+        Plans(quint32 height, quint32 width) {
+            const quint32 length = height * (width / 2 + 1);
+
+            /**
+             * The plans are applied to other arrays with fftw_execute_dft_*(),
+             * which requires the arrays to be in-place and have the same
+             * alignment as the one used for planning. fftw_malloc()
+             * guarantees the alignment.
+             */
+            fftw_complex *buffer = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * length);
+
+            QMutexLocker l(&KisConvolutionWorkerFFTLock::fftwMutex);
+            forward = fftw_plan_dft_r2c_2d(height, width, (double*)buffer, buffer, FFTW_ESTIMATE);
+            backward = fftw_plan_dft_c2r_2d(height, width, buffer, (double*)buffer, FFTW_ESTIMATE);
+            fftw_free(buffer);
+        }
+
+        ~Plans() {
+            QMutexLocker l(&KisConvolutionWorkerFFTLock::fftwMutex);
+            fftw_destroy_plan(forward);
+            fftw_destroy_plan(backward);
+        }
+
+        fftw_plan forward;
+        fftw_plan backward;
+    };
+
+    typedef QSharedPointer<Plans> PlansSP;
+
+    static PlansSP plans(quint32 height, quint32 width) {
+        const QPair<quint32, quint32> key(height, width);
+
+        QMutexLocker l(&s_cacheMutex);
+
+        PlansSP result = s_cache.value(key);
+
+        if (!result) {
+            /**
+             * The plans that are still in use by other workers are
+             * destroyed only when the last worker releases them.
+             */
+            if (s_cacheOrder.size() >= maxCachedPlans) {
+                s_cache.remove(s_cacheOrder.takeFirst());
+            }
+
+            result = PlansSP(new Plans(height, width));
+            s_cache.insert(key, result);
+            s_cacheOrder.append(key);
+        }
+
+        return result;
+    }
+
+private:
+    static const int maxCachedPlans = 32;
+
+    static QMutex s_cacheMutex;
+    static QHash<QPair<quint32, quint32>, PlansSP> s_cache;
+    static QList<QPair<quint32, quint32>> s_cacheOrder;
+};
+
+QMutex KisConvolutionWorkerFFTPlanCache::s_cacheMutex;
+QHash<QPair<quint32, quint32>, KisConvolutionWorkerFFTPlanCache::PlansSP> KisConvolutionWorkerFFTPlanCache::s_cache;
+QList<QPair<quint32, quint32>> KisConvolutionWorkerFFTPlanCache::s_cacheOrder;
+
 
 template<class _IteratorFactory_>
 class KisConvolutionWorkerFFT : public KisConvolutionWorker<_IteratorFactory_>
@@ -72,19 +152,25 @@ public:
         const quint32 halfKernelWidth = (kernel->width() - 1) / 2;
         const quint32 halfKernelHeight = (kernel->height() - 1) / 2;
 
-        m_fftWidth = areaSize.width() + 4 * halfKernelWidth;
-        m_fftHeight = areaSize.height() + 2 * halfKernelHeight;
-
         /**
-         * FIXME: check whether this "optimization" is needed to
-         * be uncommented. My tests showed about 30% better performance
-         * when the line is commented out (DK).
+         * The area is processed in blocks using overlap-save method:
+         * every block is read with the margins of the kernel size and
+         * only its inner part is written back. It keeps the memory
+         * usage bounded by the block size, whatever the size of the
+         * area is.
          */
-        //optimumDimensions(m_fftWidth, m_fftHeight);
+        m_fftWidth = fftBlockSize(areaSize.width(), 2 * halfKernelWidth);
+        m_fftHeight = fftBlockSize(areaSize.height(), 2 * halfKernelHeight);
+
+        const int blockWidth = m_fftWidth - 2 * halfKernelWidth;
+        const int blockHeight = m_fftHeight - 2 * halfKernelHeight;
 
         m_fftLength = m_fftHeight * (m_fftWidth / 2 + 1);
         m_extraMem = (m_fftWidth % 2) ? 1 : 2;
 
+        KisConvolutionWorkerFFTPlanCache::PlansSP plans =
+            KisConvolutionWorkerFFTPlanCache::plans(m_fftHeight, m_fftWidth);
+
         // create and fill kernel
         m_kernelFFT = (fftw_complex *)fftw_malloc(sizeof(fftw_complex) * m_fftLength);
         memset(m_kernelFFT, 0, sizeof(fftw_complex) * m_fftLength);
@@ -104,56 +190,59 @@ public:
         FFTInfo info (fftScale, convChannelList, kernel, this->m_painter->device()->colorSpace());
         int cacheRowStride = m_fftWidth + m_extraMem;
 
-        fillCacheFromDevice(src,
-                            QRect(srcPos.x() - halfKernelWidth,
-                                  srcPos.y() - halfKernelHeight,
-                                  m_fftWidth,
-                                  m_fftHeight),
-                            cacheRowStride,
-                            info, dataRect);
-
+        fftw_execute_dft_r2c(plans->forward, (double*)m_kernelFFT, m_kernelFFT);
         addToProgress(10);
         if (isInterrupted()) return;
 
-        // calculate number off fft operations required for progress reporting
-        const float progressPerFFT = (100 - 30) / (double)(convChannelList.count() * 2 + 1);
+        const int numBlocks =
+            ((areaSize.width() + blockWidth - 1) / blockWidth) *
+            ((areaSize.height() + blockHeight - 1) / blockHeight);
 
-        // perform FFT
-        fftw_plan fftwPlanForward, fftwPlanBackward;
-
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftwPlanForward = fftw_plan_dft_r2c_2d(m_fftHeight, m_fftWidth, (double*)m_kernelFFT, m_kernelFFT, FFTW_ESTIMATE);
-        fftwPlanBackward = fftw_plan_dft_c2r_2d(m_fftHeight, m_fftWidth, m_kernelFFT, (double*)m_kernelFFT, FFTW_ESTIMATE);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
-
-        fftw_execute(fftwPlanForward);
-        addToProgress(progressPerFFT);
-        if (isInterrupted()) return;
+        const float progressPerBlock = (100 - 10) / (double)numBlocks;
 
-        for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k)
-        {
-            fftw_execute_dft_r2c(fftwPlanForward, (double*)(*k), *k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
-
-            fftMultiply(*k, m_kernelFFT);
-
-            fftw_execute_dft_c2r(fftwPlanBackward, *k, (double*)*k);
-            addToProgress(progressPerFFT);
-            if (isInterrupted()) return;
+        /**
+         * The margins of the blocks overlap with the results of the
+         * neighbouring blocks, so when convolving the device in-place
+         * we should read from a copy of it (unless there is a transaction
+         * open, then oldRawData() gives us the original pixels anyway).
+         * The copy shares the tiles with the original device, so it is
+         * cheap.
+         */
+        KisPaintDeviceSP srcDevice = src;
+        if (numBlocks > 1 &&
+            src.data() == this->m_painter->device().data() &&
+            !src->dataManager()->hasCurrentMemento()) {
+            srcDevice = new KisPaintDevice(*src);
         }
 
-        KisConvolutionWorkerFFTLock::fftwMutex.lock();
-        fftw_destroy_plan(fftwPlanForward);
-        fftw_destroy_plan(fftwPlanBackward);
-        KisConvolutionWorkerFFTLock::fftwMutex.unlock();
+        for (int blockY = 0; blockY < areaSize.height(); blockY += blockHeight) {
+            for (int blockX = 0; blockX < areaSize.width(); blockX += blockWidth) {
+
+                fillCacheFromDevice(srcDevice,
+                                    QRect(srcPos.x() + blockX - halfKernelWidth,
+                                          srcPos.y() + blockY - halfKernelHeight,
+                                          m_fftWidth,
+                                          m_fftHeight),
+                                    cacheRowStride,
+                                    info, dataRect);
+
+                for (auto k = m_channelFFT.begin(); k != m_channelFFT.end(); ++k) {
+                    fftw_execute_dft_r2c(plans->forward, (double*)(*k), *k);
+                    fftMultiply(*k, m_kernelFFT);
+                    fftw_execute_dft_c2r(plans->backward, *k, (double*)*k);
+                }
 
+                writeResultToDevice(QRect(dstPos.x() + blockX, dstPos.y() + blockY,
+                                          qMin(blockWidth, areaSize.width() - blockX),
+                                          qMin(blockHeight, areaSize.height() - blockY)),
+                                    cacheRowStride, halfKernelWidth, halfKernelHeight,
+                                    info, dataRect);
 
-        writeResultToDevice(QRect(dstPos.x(), dstPos.y(), areaSize.width(), areaSize.height()),
-                            cacheRowStride, halfKernelWidth, halfKernelHeight,
-                            info, dataRect);
+                addToProgress(progressPerBlock);
+                if (isInterrupted()) return;
+            }
+        }
 
-        addToProgress(20);
         cleanUp();
     }
 
@@ -458,6 +547,30 @@ private:
         }
     }
 
+    /**
+     * Returns the size of the FFT block for the area of \p areaSize
+     * and a kernel that needs \p margin extra pixels. Small areas
+     * are processed in a single block, bigger ones are split into blocks
+     * that are a few times bigger than the kernel, which is the most
+     * efficient size for overlap-save convolution.
+     */
+    static quint32 fftBlockSize(quint32 areaSize, quint32 margin)
+    {
+        quint32 preferredSize = 512;
+        while (preferredSize < 4 * margin) {
+            preferredSize *= 2;
+        }
+
+        /**
+         * Round the size up to make the number of different
+         * plans in the cache smaller
+         */
+        const quint32 alignment = 32;
+        const quint32 fullSize = (areaSize + margin + alignment - 1) / alignment * alignment;
+
+        return qMin(fullSize, preferredSize);
+    }
+
     void optimumDimensions(quint32& w, quint32& h)
     {
         // FFTW is most efficient when array size is a factor of 2, 3, 5 or 7
@@ -534,6 +647,7 @@ private:
         // free kernel fft data
         if (m_kernelFFT) {
             fftw_free(m_kernelFFT);
+            m_kernelFFT = 0;
         }
 
         Q_FOREACH (fftw_complex *channel, m_channelFFT) {
@@ -374,6 +374,7 @@ KisPixelSelectionSP KisFillPainter::createFloodSelection(KisPixelSelectionSP pix
     gc.setThreshold(m_threshold);
     gc.setOpacitySpread(m_useCompositing ? m_opacitySpread : 100);
     gc.setCloseGap(m_closeGap);
+    gc.setRegionLabelMap(m_regionLabelMap);
 
     if (m_regionFillingMode == RegionFillingMode_FloodFill) {
         if (m_useSelectionAsBoundary && !pixelSelection.isNull()) {
@@ -435,39 +436,59 @@ void createSimilarColorsSelectionImpl(KisPixelSelectionSP outSelection,
     const int progressIncrement = 100 / numberOfUpdates;
     int numberOfPixelsProcessed = 0;
 
-    if (mask) {
-        KisSequentialConstIterator maskIterator(mask, rect);
-        while (referenceDeviceIterator.nextPixel() &&
-               outSelectionIterator.nextPixel() &&
-               maskIterator.nextPixel()) {
-            if (*maskIterator.rawDataConst() != MIN_SELECTED) {
-                *outSelectionIterator.rawData() =
-                    selectionPolicy.opacityFromDifference(
-                        differencePolicy.difference(referenceDeviceIterator.rawDataConst())
-                    );
+    /**
+     * The differences are calculated for whole runs of consequent pixels,
+     * so the color space can convert them in one go
+     */
+    QVector<quint8> differences(rect.width());
+
+    auto processRun = [&] (int numPixels, const quint8 *maskPtr) {
+        differencePolicy.differences(referenceDeviceIterator.rawDataConst(), differences.data(), numPixels);
+
+        quint8 *outPtr = outSelectionIterator.rawData();
+        for (int i = 0; i < numPixels; i++) {
+            if (!maskPtr || maskPtr[i] != MIN_SELECTED) {
+                outPtr[i] = selectionPolicy.opacityFromDifference(differences[i]);
             }
-            if (updater) {
-                ++numberOfPixelsProcessed;
-                if (numberOfPixelsProcessed > numberOfPixelsPerUpdate) {
-                    numberOfPixelsProcessed = 0;
-                    updater->setProgress(updater->progress() + progressIncrement);
-                }
+        }
+
+        if (updater) {
+            numberOfPixelsProcessed += numPixels;
+            if (numberOfPixelsProcessed > numberOfPixelsPerUpdate) {
+                numberOfPixelsProcessed = 0;
+                updater->setProgress(updater->progress() + progressIncrement);
             }
         }
+    };
+
+    if (mask) {
+        KisSequentialConstIterator maskIterator(mask, rect);
+
+        int numConseqPixels = qMin(qMin(referenceDeviceIterator.nConseqPixels(),
+                                        outSelectionIterator.nConseqPixels()),
+                                   maskIterator.nConseqPixels());
+
+        while (referenceDeviceIterator.nextPixels(numConseqPixels) &&
+               outSelectionIterator.nextPixels(numConseqPixels) &&
+               maskIterator.nextPixels(numConseqPixels)) {
+
+            numConseqPixels = qMin(qMin(referenceDeviceIterator.nConseqPixels(),
+                                        outSelectionIterator.nConseqPixels()),
+                                   maskIterator.nConseqPixels());
+
+            processRun(numConseqPixels, maskIterator.rawDataConst());
+        }
     } else {
-        while (referenceDeviceIterator.nextPixel() &&
-               outSelectionIterator.nextPixel()) {
-            *outSelectionIterator.rawData() =
-                selectionPolicy.opacityFromDifference(
-                    differencePolicy.difference(referenceDeviceIterator.rawDataConst())
-                );
-            if (updater) {
-                ++numberOfPixelsProcessed;
-                if (numberOfPixelsProcessed > numberOfPixelsPerUpdate) {
-                    numberOfPixelsProcessed = 0;
-                    updater->setProgress(updater->progress() + progressIncrement);
-                }
-            }
+        int numConseqPixels = qMin(referenceDeviceIterator.nConseqPixels(),
+                                   outSelectionIterator.nConseqPixels());
+
+        while (referenceDeviceIterator.nextPixels(numConseqPixels) &&
+               outSelectionIterator.nextPixels(numConseqPixels)) {
+
+            numConseqPixels = qMin(referenceDeviceIterator.nConseqPixels(),
+                                   outSelectionIterator.nConseqPixels());
+
+            processRun(numConseqPixels, nullptr);
         }
     }
     if (updater) {
@@ -16,6 +16,7 @@
 #include "kis_painter.h"
 #include "kis_types.h"
 #include "kis_selection.h"
+#include "floodfill/kis_fill_region_label_map.h"
 
 #include <KisRunnableStrokeJobUtils.h>
 #include <kis_processing_visitor.h>
@@ -426,6 +427,20 @@ public:
         return m_stopGrowingAtDarkestPixel;
     }
 
+    /**
+     * Sets the map that caches the regions found by the contiguous
+     * selection and fill operations, so that consecutive fills of the
+     * same reference device can reuse them. See KisFillRegionLabelMap.
+     */
+    void setRegionLabelMap(KisFillRegionLabelMapSP regionLabelMap) {
+        m_regionLabelMap = regionLabelMap;
+    }
+
+    /** Gets the map that caches the regions found by the fills */
+    KisFillRegionLabelMapSP regionLabelMap() const {
+        return m_regionLabelMap;
+    }
+
 protected:
     void setCurrentFillSelection(KisSelectionSP fillSelection)
     {
@@ -458,6 +473,7 @@ private:
     RegionFillingMode m_regionFillingMode;
     KoColor m_regionFillingBoundaryColor;
     bool m_stopGrowingAtDarkestPixel;
+    KisFillRegionLabelMapSP m_regionLabelMap;
 };
 
 #endif //KIS_FILL_PAINTER_H_
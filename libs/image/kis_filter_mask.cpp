@@ -21,6 +21,7 @@
 #include "kis_busy_progress_indicator.h"
 #include "kis_transaction.h"
 #include "kis_painter.h"
+#include "KisFilterResultCache.h"
 
 KisFilterMask::KisFilterMask(KisImageWSP image, const QString &name)
     : KisEffectMask(image, name),
@@ -49,13 +50,25 @@ void KisFilterMask::setFilter(KisFilterConfigurationSP  filterConfig, bool check
     KisNodeFilterInterface::setFilter(filterConfig, checkCompareConfig);
 }
 
+void KisFilterMask::setVisible(bool visible, bool loading)
+{
+    /**
+     * The hidden mask is not applied, so the filter result cache
+     * doesn't know about the changes of its source
+     */
+    if (visible != this->visible(false)) {
+        filterResultCache()->invalidate();
+    }
+
+    KisEffectMask::setVisible(visible, loading);
+}
+
 QRect KisFilterMask::decorateRect(KisPaintDeviceSP &src,
                                   KisPaintDeviceSP &dst,
                                   const QRect & rc,
                                   PositionToFilthy maskPos,
                                   KisRenderPassFlags flags) const
 {
-    Q_UNUSED(maskPos);
     Q_UNUSED(flags);
 
     KisFilterConfigurationSP filterConfig = filter();
@@ -83,7 +96,13 @@ QRect KisFilterMask::decorateRect(KisPaintDeviceSP &src,
     KIS_ASSERT_RECOVER_NOOP(this->busyProgressIndicator());
     this->busyProgressIndicator()->update();
 
-    filter->process(src, dst, 0, rc, filterConfig.data(), 0);
+    /**
+     * The source of the mask doesn't change when the mask itself or
+     * a mask above it is dirty
+     */
+    const bool sourceChanged = maskPos != N_FILTHY && maskPos != N_BELOW_FILTHY;
+
+    filterResultCache()->process(filter, filterConfig, src, dst, rc, sourceChanged);
 
     QRect r = filter->changedRect(rc, filterConfig.data(), dst->defaultBounds()->currentLevelOfDetail());
     return r;
@@ -46,6 +46,8 @@ public:
 
     void setFilter(KisFilterConfigurationSP filterConfig, bool checkCompareConfig = true) override;
 
+    void setVisible(bool visible, bool loading = false) override;
+
     QRect decorateRect(KisPaintDeviceSP &src,
                        KisPaintDeviceSP &dst,
                        const QRect & rc,
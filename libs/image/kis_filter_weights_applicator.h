@@ -15,6 +15,8 @@
 #include <KoColorSpace.h>
 #include <KoMixColorsOp.h>
 
+#include <QVector>
+
 
 namespace tmp {
     template <class iter> iter createIterator(KisPaintDeviceSP dev, qint32 start, qint32 lineNum, qint32 len);
@@ -234,7 +236,9 @@ public:
         const KoColor defaultPixelObject = m_src->defaultPixel();
         const quint8 *defaultPixel = defaultPixelObject.data();
         const quint8 *borderPixel = defaultPixel;
-        quint8 *srcLineBuf = new quint8[pixelSize * (rightSrcBorder - leftSrcBorder)];
+
+        m_srcLineBuf.resize(pixelSize * (rightSrcBorder - leftSrcBorder));
+        quint8 *srcLineBuf = m_srcLineBuf.data();
 
         int i = leftSrcBorder;
         quint8 *bufPtr = srcLineBuf;
@@ -264,7 +268,8 @@ public:
             memcpy(bufPtr, borderPixel, pixelSize);
         }
 
-        const quint8 **colors = new const quint8* [buffer->maxSpan()];
+        m_colors.resize(buffer->maxSpan());
+        const quint8 **colors = m_colors.data();
 
         T dstIt = tmp::createIterator<T>(m_dst, dstStart, line, dstEnd - dstStart);
         for (int i = dstStart; i < dstEnd; i++) {
@@ -282,9 +287,6 @@ public:
             dstIt->nextPixel();
         }
 
-        delete[] colors;
-        delete[] srcLineBuf;
-
         return LinePos(dstStart, qMax(0, dstEnd - dstStart));
     }
 
@@ -334,6 +336,13 @@ private:
     qreal m_shear;
     qreal m_dx;
     bool m_clampToEdge;
+
+    /**
+     * The scratch buffers are reused for all the lines processed by the
+     * applicator, so every thread should use its own copy of it.
+     */
+    QVector<quint8> m_srcLineBuf;
+    QVector<const quint8*> m_colors;
 };
 
 #endif /* __KIS_FILTER_WEIGHTS_APPLICATOR_H */
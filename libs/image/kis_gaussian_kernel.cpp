@@ -10,7 +10,17 @@
 #include "kis_convolution_kernel.h"
 #include <kis_convolution_painter.h>
 #include <kis_transaction.h>
+#include "kis_convolution_worker.h"
+#include "kis_math_toolbox.h"
+#include "kis_assert.h"
+#include "kis_default_bounds.h"
+#include <KoColorSpace.h>
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
 #include <QRect>
+#include <QtMath>
+
+#include <limits>
 
 
 qreal KisGaussianKernel::sigmaFromRadius(qreal radius)
@@ -109,8 +119,24 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
 {
     QPoint srcTopLeft = rect.topLeft();
 
+    const qreal xSigma = xRadius > 0.0 ? sigmaFromRadius(xRadius) : 0.0;
+    const qreal ySigma = yRadius > 0.0 ? sigmaFromRadius(yRadius) : 0.0;
+
+    /**
+     * For huge radii both FIR engines become too slow: the spatial one
+     * is linear to the kernel size and the FFT one needs a lot of memory
+     * and serializes all the blurs in the application on a global lock.
+     * The recursive filter has constant cost per pixel.
+     */
+    if (qMax(xSigma, ySigma) >= recursiveGaussianMinSigma()) {
+        QScopedPointer<KisTransaction> transaction;
+        if (createTransaction) {
+            transaction.reset(new KisTransaction(device));
+        }
+
+        applyRecursiveGaussian(device, rect, xSigma, ySigma, channelFlags, progressUpdater, borderOp);
 
-    if (KisConvolutionPainter::supportsFFTW()) {
+    } else if (KisConvolutionPainter::supportsFFTW()) {
         KisConvolutionPainter painter(device, KisConvolutionPainter::FFTW);
         painter.setChannelFlags(channelFlags);
         painter.setProgress(progressUpdater);
@@ -177,6 +203,410 @@ void KisGaussianKernel::applyGaussian(KisPaintDeviceSP device,
     }
 }
 
+namespace {
+
+/**
+ * Coefficients of the recursive Gaussian filter from
+ *
+ * I. T. Young, L. J. van Vliet, "Recursive implementation of the
+ * Gaussian filter", Signal Processing 44 (1995) 139-151
+ *
+ * The coefficients are already normalized by b0.
+ */
+struct RecursiveGaussianCoeffs
+{
+    RecursiveGaussianCoeffs(qreal sigma)
+    {
+        // the approximation is valid for sigma >= 0.5 only
+        sigma = qMax(0.5, sigma);
+
+        const qreal q = sigma >= 2.5 ?
+            0.98711 * sigma - 0.96330 :
+            3.97156 - 4.14554 * std::sqrt(1.0 - 0.26891 * sigma);
+
+        const qreal q2 = pow2(q);
+        const qreal q3 = q2 * q;
+
+        const qreal b0 = 1.57825 + 2.44413 * q + 1.4281 * q2 + 0.422205 * q3;
+
+        b1 = (2.44413 * q + 2.85619 * q2 + 1.26661 * q3) / b0;
+        b2 = -(1.4281 * q2 + 1.26661 * q3) / b0;
+        b3 = 0.422205 * q3 / b0;
+        B = 1.0 - (b1 + b2 + b3);
+    }
+
+    /**
+     * Filters \p size values of \p line in place. The line should
+     * already contain the margins, the values outside the line are
+     * considered to be equal to the ones on the edges.
+     */
+    void filterLine(double *line, int size) const
+    {
+        double w1 = line[0];
+        double w2 = w1;
+        double w3 = w1;
+
+        for (int i = 0; i < size; i++) {
+            const double w0 = B * line[i] + b1 * w1 + b2 * w2 + b3 * w3;
+            line[i] = w0;
+            w3 = w2; w2 = w1; w1 = w0;
+        }
+
+        w1 = line[size - 1];
+        w2 = w1;
+        w3 = w1;
+
+        for (int i = size - 1; i >= 0; i--) {
+            const double w0 = B * line[i] + b1 * w1 + b2 * w2 + b3 * w3;
+            line[i] = w0;
+            w3 = w2; w2 = w1; w1 = w0;
+        }
+    }
+
+    double B;
+    double b1;
+    double b2;
+    double b3;
+};
+
+/**
+ * Converts pixels to premultiplied doubles and back. The conversion
+ * is exactly the same as the one used by the convolution workers.
+ */
+struct RecursiveGaussianChannels
+{
+    RecursiveGaussianChannels(const KoColorSpace *colorSpace, const QBitArray &channelFlags)
+    {
+        const QList<KoChannelInfo *> channelInfo = colorSpace->channels();
+
+        for (int c = 0; c < channelInfo.count(); ++c) {
+            if (channelFlags.isEmpty() || channelFlags.testBit(c)) {
+                convChannelList.append(channelInfo[c]);
+            }
+        }
+
+        KisMathToolbox mathToolbox;
+
+        for (int i = 0; i < convChannelList.count(); ++i) {
+            minClamp.append(mathToolbox.minChannelValue(convChannelList[i]));
+            maxClamp.append(mathToolbox.maxChannelValue(convChannelList[i]));
+
+            if (convChannelList[i]->channelType() == KoChannelInfo::ALPHA) {
+                alphaCachePos = i;
+                alphaRealPos = convChannelList[i]->pos();
+            }
+        }
+
+        toDoubleFuncPtr.resize(convChannelList.count());
+        fromDoubleFuncPtr.resize(convChannelList.count());
+        fromDoubleCheckNullFuncPtr.resize(convChannelList.count());
+
+        bool result = mathToolbox.getToDoubleChannelPtr(convChannelList, toDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleChannelPtr(convChannelList, fromDoubleFuncPtr);
+        result &= mathToolbox.getFromDoubleCheckNullChannelPtr(convChannelList, fromDoubleCheckNullFuncPtr);
+
+        KIS_ASSERT(result);
+    }
+
+    inline int numChannels() const {
+        return convChannelList.size();
+    }
+
+    inline void readPixel(const quint8 *data, double *dst, int channelStride) const {
+        const double alphaValue = alphaRealPos >= 0 ?
+            toDoubleFuncPtr[alphaCachePos](data, alphaRealPos) : 1.0;
+
+        for (int k = 0; k < convChannelList.size(); ++k) {
+            dst[k * channelStride] = k != alphaCachePos ?
+                toDoubleFuncPtr[k](data, convChannelList[k]->pos()) * alphaValue :
+                alphaValue;
+        }
+    }
+
+    inline void writePixel(const double *src, int channelStride, quint8 *data) const {
+        double alphaMultiplier = 1.0;
+
+        if (alphaCachePos >= 0) {
+            bool alphaIsNullInDstSpace = false;
+            const double alphaValue = clampChannel(alphaCachePos, src[alphaCachePos * channelStride]);
+            fromDoubleCheckNullFuncPtr[alphaCachePos](data, alphaRealPos, alphaValue, &alphaIsNullInDstSpace);
+
+            alphaMultiplier =
+                !alphaIsNullInDstSpace && alphaValue > std::numeric_limits<qreal>::epsilon() ?
+                1.0 / alphaValue : 0.0;
+        }
+
+        for (int k = 0; k < convChannelList.size(); ++k) {
+            if (k == alphaCachePos) continue;
+
+            const double value = clampChannel(k, src[k * channelStride] * alphaMultiplier);
+            fromDoubleFuncPtr[k](data, convChannelList[k]->pos(), value);
+        }
+    }
+
+    inline double clampChannel(int channel, double value) const {
+        // the second comparison also catches NaN values
+        return value > maxClamp[channel] ? maxClamp[channel] :
+               !(value >= minClamp[channel]) ? minClamp[channel] : value;
+    }
+
+    QList<KoChannelInfo*> convChannelList;
+
+    QVector<qreal> minClamp;
+    QVector<qreal> maxClamp;
+
+    QVector<PtrToDouble> toDoubleFuncPtr;
+    QVector<PtrFromDouble> fromDoubleFuncPtr;
+    QVector<PtrFromDoubleCheckNull> fromDoubleCheckNullFuncPtr;
+
+    int alphaCachePos {-1};
+    int alphaRealPos {-1};
+};
+
+struct RecursiveGaussianProgress
+{
+    RecursiveGaussianProgress(KoUpdater *updater, int totalSteps)
+        : m_updater(updater),
+          m_totalSteps(qMax(1, totalSteps))
+    {
+    }
+
+    bool step() {
+        m_currentStep++;
+
+        if (m_updater) {
+            m_updater->setProgress(100 * m_currentStep / m_totalSteps);
+            return !m_updater->interrupted();
+        }
+
+        return true;
+    }
+
+private:
+    KoUpdater *m_updater;
+    int m_totalSteps;
+    int m_currentStep {0};
+};
+
+/**
+ * Blurs \p src horizontally and writes \p dstRect into \p dst. The
+ * source is read with \p margin pixels on both sides of every row.
+ */
+template <class IteratorFactory>
+bool recursiveGaussianHorizontalPass(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                                     const QRect &dstRect, int margin,
+                                     const RecursiveGaussianCoeffs &coeffs,
+                                     const RecursiveGaussianChannels &channels,
+                                     const QRect &dataRect,
+                                     RecursiveGaussianProgress &progress)
+{
+    const int srcWidth = dstRect.width() + 2 * margin;
+    const int dstPixelSize = dst->pixelSize();
+
+    QVector<double> line(srcWidth * channels.numChannels());
+
+    typename IteratorFactory::HLineConstIterator srcIt =
+        IteratorFactory::createHLineConstIterator(src,
+                                                  dstRect.x() - margin, dstRect.y(), srcWidth,
+                                                  dataRect);
+    KisHLineIteratorSP dstIt = dst->createHLineIteratorNG(dstRect.x(), dstRect.y(), dstRect.width());
+
+    for (int y = 0; y < dstRect.height(); y++) {
+        for (int x = 0; x < srcWidth; x++) {
+            channels.readPixel(srcIt->oldRawData(), line.data() + x, srcWidth);
+            srcIt->nextPixel();
+        }
+
+        for (int k = 0; k < channels.numChannels(); k++) {
+            coeffs.filterLine(line.data() + k * srcWidth, srcWidth);
+        }
+
+        for (int x = 0; x < dstRect.width();) {
+            const int numPixels = dstIt->nConseqPixels();
+            quint8 *dstPtr = dstIt->rawData();
+
+            for (int i = 0; i < numPixels; i++, x++, dstPtr += dstPixelSize) {
+                channels.writePixel(line.constData() + margin + x, srcWidth, dstPtr);
+            }
+
+            dstIt->nextPixels(numPixels);
+        }
+
+        srcIt->nextRow();
+        dstIt->nextRow();
+
+        if (!progress.step()) return false;
+    }
+
+    return true;
+}
+
+/**
+ * Blurs \p src vertically and writes \p dstRect into \p dst. To keep the
+ * memory access cache-friendly, the columns are processed in strips of
+ * the tile width, reading the image row-by-row.
+ */
+template <class IteratorFactory>
+bool recursiveGaussianVerticalPass(KisPaintDeviceSP src, KisPaintDeviceSP dst,
+                                   const QRect &dstRect, int margin,
+                                   const RecursiveGaussianCoeffs &coeffs,
+                                   const RecursiveGaussianChannels &channels,
+                                   const QRect &dataRect,
+                                   RecursiveGaussianProgress &progress)
+{
+    const int stripWidth = 64;
+
+    const int srcHeight = dstRect.height() + 2 * margin;
+    const int dstPixelSize = dst->pixelSize();
+
+    QVector<double> strip(stripWidth * srcHeight * channels.numChannels());
+
+    for (int stripX = dstRect.x(); stripX <= dstRect.right(); stripX += stripWidth) {
+        const int width = qMin(stripWidth, dstRect.right() - stripX + 1);
+
+        // every column is stored as a contiguous line for each channel
+        const int channelStride = width * srcHeight;
+
+        typename IteratorFactory::HLineConstIterator srcIt =
+            IteratorFactory::createHLineConstIterator(src,
+                                                      stripX, dstRect.y() - margin, width,
+                                                      dataRect);
+
+        for (int y = 0; y < srcHeight; y++) {
+            for (int x = 0; x < width; x++) {
+                channels.readPixel(srcIt->oldRawData(), strip.data() + x * srcHeight + y, channelStride);
+                srcIt->nextPixel();
+            }
+            srcIt->nextRow();
+        }
+
+        for (int k = 0; k < channels.numChannels(); k++) {
+            for (int x = 0; x < width; x++) {
+                coeffs.filterLine(strip.data() + k * channelStride + x * srcHeight, srcHeight);
+            }
+        }
+
+        KisHLineIteratorSP dstIt = dst->createHLineIteratorNG(stripX, dstRect.y(), width);
+
+        for (int y = 0; y < dstRect.height(); y++) {
+            for (int x = 0; x < width;) {
+                const int numPixels = dstIt->nConseqPixels();
+                quint8 *dstPtr = dstIt->rawData();
+
+                for (int i = 0; i < numPixels; i++, x++, dstPtr += dstPixelSize) {
+                    channels.writePixel(strip.constData() + x * srcHeight + margin + y, channelStride, dstPtr);
+                }
+
+                dstIt->nextPixels(numPixels);
+            }
+            dstIt->nextRow();
+        }
+
+        if (!progress.step()) return false;
+    }
+
+    return true;
+}
+
+template <class IteratorFactory>
+void applyRecursiveGaussianImpl(KisPaintDeviceSP device,
+                                const QRect& rect,
+                                qreal xSigma, qreal ySigma,
+                                const QBitArray &channelFlags,
+                                KoUpdater *progressUpdater,
+                                const QRect &dataRect)
+{
+    /**
+     * The impulse response of the filter is infinite, but its tail
+     * beyond 3 * sigma is negligible, so we use the same margins as
+     * the FIR kernel of the same sigma would need.
+     */
+    const int xMargin = xSigma > 0.0 ? qCeil(3.0 * xSigma) : 0;
+    const int yMargin = ySigma > 0.0 ? qCeil(3.0 * ySigma) : 0;
+
+    const RecursiveGaussianChannels channels(device->colorSpace(), channelFlags);
+    if (!channels.numChannels()) return;
+
+    const int numStrips = (rect.width() + 63) / 64;
+
+    RecursiveGaussianProgress progress(progressUpdater,
+                                       (xSigma > 0.0 ? rect.height() + 2 * yMargin : 0) +
+                                       (ySigma > 0.0 ? numStrips : 0));
+
+    if (xSigma > 0.0 && ySigma > 0.0) {
+        KisPaintDeviceSP interm = new KisPaintDevice(device->colorSpace());
+        interm->prepareClone(device);
+
+        const QRect intermRect = rect.adjusted(0, -yMargin, 0, yMargin);
+
+        if (!recursiveGaussianHorizontalPass<IteratorFactory>(device, interm, intermRect, xMargin,
+                                                              RecursiveGaussianCoeffs(xSigma),
+                                                              channels, dataRect, progress)) {
+            return;
+        }
+
+        recursiveGaussianVerticalPass<IteratorFactory>(interm, device, rect, yMargin,
+                                                       RecursiveGaussianCoeffs(ySigma),
+                                                       channels, dataRect, progress);
+
+    } else if (xSigma > 0.0) {
+        recursiveGaussianHorizontalPass<IteratorFactory>(device, device, rect, xMargin,
+                                                         RecursiveGaussianCoeffs(xSigma),
+                                                         channels, dataRect, progress);
+    } else if (ySigma > 0.0) {
+        recursiveGaussianVerticalPass<IteratorFactory>(device, device, rect, yMargin,
+                                                       RecursiveGaussianCoeffs(ySigma),
+                                                       channels, dataRect, progress);
+    }
+}
+
+}
+
+qreal KisGaussianKernel::recursiveGaussianMinSigma()
+{
+    /**
+     * Below this value the FIR kernel is small enough to be faster
+     * than the recursive filter and gives slightly more precise
+     * results.
+     */
+    return 16.0;
+}
+
+void KisGaussianKernel::applyRecursiveGaussian(KisPaintDeviceSP device,
+                                               const QRect& rect,
+                                               qreal xSigma, qreal ySigma,
+                                               const QBitArray &channelFlags,
+                                               KoUpdater *progressUpdater,
+                                               KisConvolutionBorderOp borderOp)
+{
+    if (rect.isEmpty()) return;
+
+    /**
+     * The same logic as in KisConvolutionPainter::applyMatrix(): the
+     * wraparound mode is handled by the iterators themselves.
+     */
+    if (device->defaultBounds()->wrapAroundMode()) {
+        borderOp = BORDER_IGNORE;
+    }
+
+    if (borderOp == BORDER_REPEAT) {
+        const QRect boundsRect = device->defaultBounds()->bounds();
+        QRect dataRect = rect | boundsRect;
+
+        KIS_SAFE_ASSERT_RECOVER(boundsRect != KisDefaultBounds().bounds()) {
+            dataRect = rect | device->exactBounds();
+        }
+
+        applyRecursiveGaussianImpl<RepeatIteratorFactory>(device, rect, xSigma, ySigma,
+                                                          channelFlags, progressUpdater,
+                                                          dataRect);
+    } else {
+        applyRecursiveGaussianImpl<StandardIteratorFactory>(device, rect, xSigma, ySigma,
+                                                            channelFlags, progressUpdater,
+                                                            QRect());
+    }
+}
+
 Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic>
 KisGaussianKernel::createLoGMatrix(qreal radius, qreal coeff, bool zeroCentered, bool includeWrappedArea)
 {
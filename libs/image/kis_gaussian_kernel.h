@@ -44,6 +44,30 @@ public:
                               bool createTransaction = false,
                               KisConvolutionBorderOp borderOp = BORDER_REPEAT);
 
+    /**
+     * Applies Gaussian blur using a recursive (IIR) filter by Young and
+     * van Vliet. The cost per pixel doesn't depend on sigma, and the
+     * filter needs only one line of the image in memory, so it is
+     * used by applyGaussian() for huge radii instead of the FFT engine.
+     *
+     * Passing zero sigma disables blurring in that direction.
+     *
+     * NOTE: the function doesn't create any transactions, it is a
+     *       responsibility of the caller.
+     */
+    static void applyRecursiveGaussian(KisPaintDeviceSP device,
+                                       const QRect& rect,
+                                       qreal xSigma, qreal ySigma,
+                                       const QBitArray &channelFlags,
+                                       KoUpdater *progressUpdater,
+                                       KisConvolutionBorderOp borderOp = BORDER_REPEAT);
+
+    /**
+     * The minimal sigma starting from which applyGaussian() switches
+     * to the recursive implementation
+     */
+    static qreal recursiveGaussianMinSigma();
+
     static Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> createLoGMatrix(qreal radius, qreal coeff, bool zeroCentered, bool includeWrappedArea);
 
     static void applyLoG(KisPaintDeviceSP device,
@@ -17,6 +17,7 @@
 #include "kis_four_point_interpolator_backward.h"
 #include "kis_iterator_ng.h"
 #include "kis_random_sub_accessor.h"
+#include "krita_utils.h"
 
 //#define DEBUG_PAINTING_POLYGONS
 
@@ -164,8 +165,13 @@ void processGrid(ProcessPolygon &polygonOp, ForwardTransform &transformOp,
 
 struct PaintDevicePolygonOp
 {
-    PaintDevicePolygonOp(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDev)
-        : m_srcDev(srcDev), m_dstDev(dstDev) {}
+    /**
+     * If \p dstClipRect is not empty, only the pixels inside it are
+     * written into \p dstDev
+     */
+    PaintDevicePolygonOp(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDev,
+                         const QRect &dstClipRect = QRect())
+        : m_srcDev(srcDev), m_dstDev(dstDev), m_dstClipRect(dstClipRect) {}
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon) {
         this->operator() (srcPolygon, dstPolygon, dstPolygon);
@@ -173,6 +179,9 @@ struct PaintDevicePolygonOp
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
         QRect boundRect = clipDstPolygon.boundingRect().toAlignedRect();
+        if (!m_dstClipRect.isEmpty()) {
+            boundRect &= m_dstClipRect;
+        }
         if (boundRect.isEmpty()) return;
 
         KisSequentialIterator dstIt(m_dstDev, boundRect);
@@ -232,18 +241,26 @@ struct PaintDevicePolygonOp
 
     KisPaintDeviceSP m_srcDev;
     KisPaintDeviceSP m_dstDev;
+    QRect m_dstClipRect;
 };
 
 struct QImagePolygonOp
 {
+    /**
+     * If \p dstClipRect is not empty, only the pixels inside it are
+     * written into \p dstImage. The rect is in the same coordinate
+     * system as the polygons.
+     */
     QImagePolygonOp(const QImage &srcImage, QImage &dstImage,
                     const QPointF &srcImageOffset,
-                    const QPointF &dstImageOffset)
+                    const QPointF &dstImageOffset,
+                    const QRect &dstClipRect = QRect())
         : m_srcImage(srcImage), m_dstImage(dstImage),
           m_srcImageOffset(srcImageOffset),
           m_dstImageOffset(dstImageOffset),
           m_srcImageRect(m_srcImage.rect()),
-          m_dstImageRect(m_dstImage.rect())
+          m_dstImageRect(m_dstImage.rect()),
+          m_dstClipRect(dstClipRect)
     {
     }
 
@@ -253,6 +270,9 @@ struct QImagePolygonOp
 
     void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
         QRect boundRect = clipDstPolygon.boundingRect().toAlignedRect();
+        if (!m_dstClipRect.isEmpty()) {
+            boundRect &= m_dstClipRect;
+        }
         KisFourPointInterpolatorBackward interp(srcPolygon, dstPolygon);
 
         for (int y = boundRect.top(); y <= boundRect.bottom(); y++) {
@@ -304,6 +324,7 @@ struct QImagePolygonOp
 
     QRect m_srcImageRect;
     QRect m_dstImageRect;
+    QRect m_dstClipRect;
 };
 
 /*************************************************************/
@@ -639,6 +660,148 @@ void iterateThroughGrid(PolygonOp &polygonOp,
     }
 }
 
+/*************************************************************/
+/*      Concurrent processing of the grid cells              */
+/*************************************************************/
+
+/**
+ * @return all the points of the grid built by processGrid() for
+ *         \p srcBounds in row-major order
+ */
+inline QVector<QPointF> calcGridPoints(const QRect &srcBounds, const int pixelPrecision)
+{
+    struct PointsFetcherOp {
+        inline void processPoint(int col, int row, int, int, int, int) {
+            points << QPointF(col, row);
+        }
+
+        inline void nextLine() {
+        }
+
+        QVector<QPointF> points;
+    };
+
+    PointsFetcherOp pointsOp;
+    processGrid(pointsOp, srcBounds, pixelPrecision);
+    return pointsOp.points;
+}
+
+/**
+ * A polygon op that only records the polygons passed to it. It is used
+ * for processing the cells of the grids with complex iteration rules
+ * (like the ones of the cage transform) with processCellsConcurrently().
+ */
+struct RecordingPolygonOp
+{
+    struct Cell {
+        QPolygonF srcPolygon;
+        QPolygonF dstPolygon;
+        QPolygonF clipDstPolygon;
+    };
+
+    void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon) {
+        this->operator() (srcPolygon, dstPolygon, dstPolygon);
+    }
+
+    void operator() (const QPolygonF &srcPolygon, const QPolygonF &dstPolygon, const QPolygonF &clipDstPolygon) {
+        cells.append({srcPolygon, dstPolygon, clipDstPolygon});
+    }
+
+    void fetchCell(int cellIndex, QPolygonF *srcPolygon, QPolygonF *dstPolygon, QPolygonF *clipDstPolygon) const {
+        const Cell &cell = cells.at(cellIndex);
+        *srcPolygon = cell.srcPolygon;
+        *dstPolygon = cell.dstPolygon;
+        *clipDstPolygon = cell.clipDstPolygon;
+    }
+
+    QVector<Cell> cells;
+};
+
+/**
+ * Transforms the pixels of \p numCells cells from \p srcDev into
+ * \p dstDev. \p cellOp has signature
+ * void(int cellIndex, QPolygonF *srcPolygon, QPolygonF *dstPolygon,
+ *      QPolygonF *clipDstPolygon)
+ * and returns the polygons of the cell in the format accepted by
+ * PaintDevicePolygonOp.
+ *
+ * The destination is split into tile-aligned patches, which are
+ * processed concurrently. Each patch paints all the cells that
+ * overlap it in the order of their indexes, so the result is exactly
+ * the same as if the cells were painted one by one, even when the
+ * transformed cells overlap.
+ *
+ * \p cellOp is called concurrently, so it should be thread-safe.
+ */
+template <class CellPolygonsOp>
+void processCellsConcurrently(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDev,
+                              int numCells, CellPolygonsOp cellOp)
+{
+    using KisAlgebra2D::divideFloor;
+
+    if (numCells <= 0) return;
+
+    const int patchSize = 256;
+
+    QVector<QRect> cellBounds(numCells);
+    QRect dstBounds;
+
+    for (int i = 0; i < numCells; i++) {
+        QPolygonF srcPolygon;
+        QPolygonF dstPolygon;
+        QPolygonF clipDstPolygon;
+        cellOp(i, &srcPolygon, &dstPolygon, &clipDstPolygon);
+
+        cellBounds[i] = clipDstPolygon.boundingRect().toAlignedRect();
+        dstBounds |= cellBounds[i];
+    }
+
+    if (dstBounds.isEmpty()) return;
+
+    const int firstCol = divideFloor(dstBounds.left(), patchSize);
+    const int firstRow = divideFloor(dstBounds.top(), patchSize);
+    const int numCols = divideFloor(dstBounds.right(), patchSize) - firstCol + 1;
+    const int numRows = divideFloor(dstBounds.bottom(), patchSize) - firstRow + 1;
+
+    QVector<QVector<int>> patchCells(numCols * numRows);
+
+    for (int i = 0; i < numCells; i++) {
+        const QRect &rc = cellBounds[i];
+        if (rc.isEmpty()) continue;
+
+        const int left = divideFloor(rc.left(), patchSize) - firstCol;
+        const int right = divideFloor(rc.right(), patchSize) - firstCol;
+        const int top = divideFloor(rc.top(), patchSize) - firstRow;
+        const int bottom = divideFloor(rc.bottom(), patchSize) - firstRow;
+
+        for (int row = top; row <= bottom; row++) {
+            for (int col = left; col <= right; col++) {
+                patchCells[row * numCols + col] << i;
+            }
+        }
+    }
+
+    KritaUtils::processConcurrently(patchCells.size(), [&] (int patchIndex) {
+        const QVector<int> &cells = patchCells.at(patchIndex);
+        if (cells.isEmpty()) return;
+
+        const QRect patchRect((firstCol + patchIndex % numCols) * patchSize,
+                              (firstRow + patchIndex / numCols) * patchSize,
+                              patchSize, patchSize);
+
+        PaintDevicePolygonOp polygonOp(srcDev, dstDev, patchRect);
+
+        Q_FOREACH (int cellIndex, cells) {
+            QPolygonF srcPolygon;
+            QPolygonF dstPolygon;
+            QPolygonF clipDstPolygon;
+            cellOp(cellIndex, &srcPolygon, &dstPolygon, &clipDstPolygon);
+
+            polygonOp(srcPolygon, dstPolygon, clipDstPolygon);
+        }
+    });
+}
+
 }
 
 #endif /* __KIS_GRID_INTERPOLATION_TOOLS_H */
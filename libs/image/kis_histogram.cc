@@ -73,9 +73,6 @@ void KisHistogram::updateHistogram()
         return;
     }
 
-    KisSequentialConstIterator srcIt(m_paintDevice, m_bounds);
-    const KoColorSpace* cs = m_paintDevice->colorSpace();
-
     // Let the producer do it's work
     m_producer->clear();
 
@@ -85,12 +82,10 @@ void KisHistogram::updateHistogram()
     //      explicit selection to the createRectIterator call, that broke because
     //      paint devices didn't know about their selections anymore.
     //      updateHistogram should get a selection parameter.
-    int numConseqPixels = srcIt.nConseqPixels();
-    while (srcIt.nextPixels(numConseqPixels)) {
 
-        numConseqPixels = srcIt.nConseqPixels();
-        m_producer->addRegionToBin(srcIt.oldRawData(), 0, numConseqPixels, cs);
-    }
+    // The bins are counted concurrently and are kept by the device until
+    // it is changed, so reopening the levels dialog doesn't count them again
+    m_paintDevice->calculateHistogramCached(m_producer, m_bounds);
 
     computeHistogram();
 }
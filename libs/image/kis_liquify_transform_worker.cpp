@@ -6,6 +6,8 @@
 
 #include "kis_liquify_transform_worker.h"
 
+#include <QPainter>
+
 #include <KoColorSpace.h>
 #include "kis_grid_interpolation_tools.h"
 #include "kis_dom_utils.h"
@@ -32,6 +34,22 @@ struct Q_DECL_HIDDEN KisLiquifyTransformWorker::Private
     int pixelPrecision;
     QSize gridSize;
 
+    /**
+     * The result of the last runOnQImage() call. If only some of the
+     * grid points have moved since then, only the area covered by the
+     * cells around them is rasterized again.
+     */
+    struct PreviewCache {
+        qint64 srcImageKey = 0;
+        QPointF srcImageOffset;
+        QPointF dstImageOffset;
+        QVector<QPointF> originalPoints;
+        QVector<QPointF> transformedPoints;
+        QImage dstImage;
+    };
+
+    PreviewCache previewCache;
+
     void preparePoints();
 
     struct MapIndexesOp;
@@ -389,20 +407,45 @@ void KisLiquifyTransformWorker::rotatePoints(const QPointF &base,
     m_d->processTransformedPixels(op, base, sigma, useWashMode, flow);
 }
 
+namespace {
+
+void fetchCellPolygons(int col, int row, const QSize &gridSize,
+                       const QVector<QPointF> &originalPoints,
+                       const QVector<QPointF> &transformedPoints,
+                       QPolygonF *srcPolygon, QPolygonF *dstPolygon)
+{
+    Q_FOREACH (int index, GridIterationTools::calculateCellIndexes(col, row, gridSize)) {
+        *srcPolygon << originalPoints[index];
+        *dstPolygon << transformedPoints[index];
+    }
+
+    GridIterationTools::adjustAlignedPolygon(*srcPolygon);
+    GridIterationTools::adjustAlignedPolygon(*dstPolygon);
+}
+
+}
+
 void KisLiquifyTransformWorker::run(KisPaintDeviceSP srcDevice, KisPaintDeviceSP dstDevice)
 {
     KIS_SAFE_ASSERT_RECOVER_RETURN(*srcDevice->colorSpace() == *dstDevice->colorSpace());
 
     dstDevice->clear();
 
-    using namespace GridIterationTools;
-
-    PaintDevicePolygonOp polygonOp(srcDevice, dstDevice);
-    RegularGridIndexesOp indexesOp(m_d->gridSize);
-    iterateThroughGrid<AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
-                                                    m_d->gridSize,
-                                                    m_d->originalPoints,
-                                                    m_d->transformedPoints);
+    const QSize gridSize = m_d->gridSize;
+    const QVector<QPointF> &originalPoints = m_d->originalPoints;
+    const QVector<QPointF> &transformedPoints = m_d->transformedPoints;
+
+    const int numCellCols = gridSize.width() - 1;
+    const int numCellRows = gridSize.height() - 1;
+    if (numCellCols <= 0 || numCellRows <= 0) return;
+
+    GridIterationTools::processCellsConcurrently(srcDevice, dstDevice, numCellCols * numCellRows,
+        [&] (int cellIndex, QPolygonF *srcPolygon, QPolygonF *dstPolygon, QPolygonF *clipDstPolygon) {
+            fetchCellPolygons(cellIndex % numCellCols, cellIndex / numCellCols, gridSize,
+                              originalPoints, transformedPoints,
+                              srcPolygon, dstPolygon);
+            *clipDstPolygon = *dstPolygon;
+        });
 }
 
 QRect KisLiquifyTransformWorker::approxChangeRect(const QRect &rc)
@@ -501,16 +544,105 @@ QImage KisLiquifyTransformWorker::runOnQImage(const QImage &srcImage,
 
     QRect dstBoundsI = dstBounds.toAlignedRect();
 
-    QImage dstImage(dstBoundsI.size(), srcImage.format());
-    dstImage.fill(0);
+    Private::PreviewCache &cache = m_d->previewCache;
+
+    const bool canUpdateIncrementally =
+        !cache.dstImage.isNull() &&
+        cache.srcImageKey == srcImage.cacheKey() &&
+        cache.srcImageOffset == srcImageOffset &&
+        cache.dstImageOffset == dstQImageOffset &&
+        cache.dstImage.size() == dstBoundsI.size() &&
+        cache.originalPoints == originalPointsLocal &&
+        cache.transformedPoints.size() == transformedPointsLocal.size();
+
+    const QSize gridSize = m_d->gridSize;
+    QImage dstImage;
+
+    if (canUpdateIncrementally) {
+        /**
+         * Only the cells with moved corners have changed. All the cells
+         * overlapping their old and new positions are painted again in
+         * the original order, so the result is exactly the same as
+         * painting the whole grid from scratch.
+         */
+        QRect dirtyRect;
+
+        QVector<bool> pointChanged(transformedPointsLocal.size());
+        for (int i = 0; i < transformedPointsLocal.size(); i++) {
+            pointChanged[i] = transformedPointsLocal[i] != cache.transformedPoints[i];
+        }
+
+        for (int row = 0; row < gridSize.height() - 1; row++) {
+            for (int col = 0; col < gridSize.width() - 1; col++) {
+                const int tl = GridIterationTools::pointToIndex(QPoint(col, row), gridSize);
+                const int bl = tl + gridSize.width();
+
+                if (!pointChanged[tl] && !pointChanged[tl + 1] &&
+                    !pointChanged[bl] && !pointChanged[bl + 1]) {
+
+                    continue;
+                }
+
+                QPolygonF srcPolygon;
+                QPolygonF oldDstPolygon;
+                fetchCellPolygons(col, row, gridSize, originalPointsLocal, cache.transformedPoints, &srcPolygon, &oldDstPolygon);
+
+                srcPolygon.clear();
+                QPolygonF newDstPolygon;
+                fetchCellPolygons(col, row, gridSize, originalPointsLocal, transformedPointsLocal, &srcPolygon, &newDstPolygon);
+
+                dirtyRect |= oldDstPolygon.boundingRect().toAlignedRect();
+                dirtyRect |= newDstPolygon.boundingRect().toAlignedRect();
+            }
+        }
+
+        dstImage = cache.dstImage;
+
+        if (!dirtyRect.isEmpty()) {
+            // same rounding as in QImagePolygonOp
+            const QRect dirtyImageRect((QPointF(dirtyRect.topLeft()) - dstQImageOffset).toPoint(),
+                                       (QPointF(dirtyRect.bottomRight()) - dstQImageOffset).toPoint());
+
+            {
+                QPainter gc(&dstImage);
+                gc.setCompositionMode(QPainter::CompositionMode_Clear);
+                gc.fillRect(dirtyImageRect, Qt::black);
+            }
+
+            GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcImageOffset, dstQImageOffset, dirtyRect);
+
+            for (int row = 0; row < gridSize.height() - 1; row++) {
+                for (int col = 0; col < gridSize.width() - 1; col++) {
+                    QPolygonF srcPolygon;
+                    QPolygonF dstPolygon;
+                    fetchCellPolygons(col, row, gridSize, originalPointsLocal, transformedPointsLocal, &srcPolygon, &dstPolygon);
+
+                    if (dstPolygon.boundingRect().toAlignedRect().intersects(dirtyRect)) {
+                        polygonOp(srcPolygon, dstPolygon);
+                    }
+                }
+            }
+        }
+    } else {
+        dstImage = QImage(dstBoundsI.size(), srcImage.format());
+        dstImage.fill(0);
+
+        GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcImageOffset, dstQImageOffset);
+        GridIterationTools::RegularGridIndexesOp indexesOp(gridSize);
+        GridIterationTools::iterateThroughGrid
+            <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
+                                                              gridSize,
+                                                              originalPointsLocal,
+                                                              transformedPointsLocal);
+    }
+
+    cache.srcImageKey = srcImage.cacheKey();
+    cache.srcImageOffset = srcImageOffset;
+    cache.dstImageOffset = dstQImageOffset;
+    cache.originalPoints = originalPointsLocal;
+    cache.transformedPoints = transformedPointsLocal;
+    cache.dstImage = dstImage;
 
-    GridIterationTools::QImagePolygonOp polygonOp(srcImage, dstImage, srcImageOffset, dstQImageOffset);
-    GridIterationTools::RegularGridIndexesOp indexesOp(m_d->gridSize);
-    GridIterationTools::iterateThroughGrid
-        <GridIterationTools::AlwaysCompletePolygonPolicy>(polygonOp, indexesOp,
-                                                          m_d->gridSize,
-                                                          originalPointsLocal,
-                                                          transformedPointsLocal);
     return dstImage;
 }
 
@@ -12,6 +12,9 @@
 #include "kis_image.h"
 #include "kis_image_config.h"
 #include "kis_signal_compressor.h"
+#include "kis_node_filter_interface.h"
+#include "KisFilterResultCache.h"
+#include "floodfill/kis_fill_region_label_map.h"
 
 #include "tiles3/kis_tile_data_store.h"
 
@@ -83,7 +86,8 @@ qint64 calculateNodeMemoryHiBoundStep(KisNodeSP node,
                                       QSet<KisPaintDevice*> &devices,
                                       qint64 &layersSize,
                                       qint64 &projectionsSize,
-                                      qint64 &lodSize)
+                                      qint64 &lodSize,
+                                      qint64 &filterCachesSize)
 {
     qint64 memBound = 0;
 
@@ -96,10 +100,17 @@ qint64 calculateNodeMemoryHiBoundStep(KisNodeSP node,
     addDevice(node->original(), originalIsProjection, devices, memBound, layersSize, projectionsSize, lodSize);
     addDevice(node->projection(), true, devices, memBound, layersSize, projectionsSize, lodSize);
 
+    if (KisNodeFilterInterface *filterNode = dynamic_cast<KisNodeFilterInterface*>(node.data())) {
+        const qint64 cacheSize = filterNode->filterResultCache()->memoryUsage();
+        filterCachesSize += cacheSize;
+        memBound += cacheSize;
+    }
+
     node = node->firstChild();
     while (node) {
         memBound += calculateNodeMemoryHiBoundStep(node, devices,
-                                                   layersSize, projectionsSize, lodSize);
+                                                   layersSize, projectionsSize, lodSize,
+                                                   filterCachesSize);
         node = node->nextSibling();
     }
 
@@ -109,18 +120,21 @@ qint64 calculateNodeMemoryHiBoundStep(KisNodeSP node,
 qint64 calculateNodeMemoryHiBound(KisNodeSP node,
                                   qint64 &layersSize,
                                   qint64 &projectionsSize,
-                                  qint64 &lodSize)
+                                  qint64 &lodSize,
+                                  qint64 &filterCachesSize)
 {
     layersSize = 0;
     projectionsSize = 0;
     lodSize = 0;
+    filterCachesSize = 0;
 
     QSet<KisPaintDevice*> devices;
     return calculateNodeMemoryHiBoundStep(node,
                                           devices,
                                           layersSize,
                                           projectionsSize,
-                                          lodSize);
+                                          lodSize,
+                                          filterCachesSize);
 }
 
 
@@ -136,8 +150,11 @@ KisMemoryStatisticsServer::fetchMemoryStatistics(KisImageSP image) const
             calculateNodeMemoryHiBound(image->root(),
                                        stats.layersSize,
                                        stats.projectionsSize,
-                                       stats.lodSize);
+                                       stats.lodSize,
+                                       stats.filterCachesSize);
     }
+    stats.fillCachesSize = KisFillRegionLabelMap::totalMemoryUsage();
+
     stats.totalMemorySize = tileStats.totalMemorySize;
     stats.realMemorySize = tileStats.realMemorySize;
     stats.historicalMemorySize = tileStats.historicalMemorySize;
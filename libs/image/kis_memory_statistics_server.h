@@ -26,6 +26,8 @@ public:
               layersSize(0),
               projectionsSize(0),
               lodSize(0),
+              filterCachesSize(0),
+              fillCachesSize(0),
 
               totalMemorySize(0),
               realMemorySize(0),
@@ -45,6 +47,8 @@ public:
         qint64 layersSize;
         qint64 projectionsSize;
         qint64 lodSize;
+        qint64 filterCachesSize;
+        qint64 fillCachesSize;
 
         qint64 totalMemorySize;
         qint64 realMemorySize;
@@ -12,6 +12,7 @@
 #include "filter/kis_filter_registry.h"
 #include "filter/kis_filter_configuration.h"
 #include "generator/kis_generator_registry.h"
+#include "KisFilterResultCache.h"
 
 #ifdef SANITY_CHECK_FILTER_CONFIGURATION_OWNER
 
@@ -41,15 +42,16 @@
 #endif /* SANITY_CHECK_FILTER_CONFIGURATION_OWNER*/
 
 KisNodeFilterInterface::KisNodeFilterInterface(KisFilterConfigurationSP filterConfig)
-    : m_filterConfiguration(filterConfig)
+    : m_filterConfiguration(filterConfig),
+      m_filterResultCache(new KisFilterResultCache())
 {
     SANITY_ACQUIRE_FILTER(m_filterConfiguration);
     KIS_SAFE_ASSERT_RECOVER_NOOP(!filterConfig || filterConfig->hasLocalResourcesSnapshot());
 }
 
 KisNodeFilterInterface::KisNodeFilterInterface(const KisNodeFilterInterface &rhs)
-    : m_filterConfiguration(rhs.m_filterConfiguration->clone())
-
+    : m_filterConfiguration(rhs.m_filterConfiguration->clone()),
+      m_filterResultCache(new KisFilterResultCache())
 {
     SANITY_ACQUIRE_FILTER(m_filterConfiguration);
 }
@@ -71,6 +73,7 @@ void KisNodeFilterInterface::setFilter(KisFilterConfigurationSP filterConfig, bo
     KIS_SAFE_ASSERT_RECOVER_RETURN(filterConfig);
     KIS_SAFE_ASSERT_RECOVER_NOOP(filterConfig->hasLocalResourcesSnapshot());
     m_filterConfiguration = filterConfig;
+    m_filterResultCache->invalidate();
 
     SANITY_ACQUIRE_FILTER(m_filterConfiguration);
 }
@@ -89,4 +92,11 @@ void KisNodeFilterInterface::notifyColorSpaceChanged()
     if (m_filterConfiguration) {
         m_filterConfiguration = m_filterConfiguration->clone();
     }
+
+    m_filterResultCache->invalidate();
+}
+
+KisFilterResultCache* KisNodeFilterInterface::filterResultCache() const
+{
+    return m_filterResultCache.data();
 }
@@ -7,9 +7,13 @@
 #ifndef _KIS_NODE_FILTER_INTERFACE_H_
 #define _KIS_NODE_FILTER_INTERFACE_H_
 
+#include <QScopedPointer>
+
 #include <kritaimage_export.h>
 #include <kis_types.h>
 
+class KisFilterResultCache;
+
 /**
  * Define an interface for nodes that are associated with a filter.
  */
@@ -43,11 +47,18 @@ public:
 
     virtual void notifyColorSpaceChanged();
 
+    /**
+     * @return the cache of the filtered pixels of this node. The cache
+     *         is invalidated automatically when the filter changes.
+     */
+    KisFilterResultCache* filterResultCache() const;
+
 // the child classes should access the filter with the filter() method
 private:
     KisNodeFilterInterface& operator=(const KisNodeFilterInterface &other);
 
     KisFilterConfigurationSP m_filterConfiguration;
+    QScopedPointer<KisFilterResultCache> m_filterResultCache;
 };
 
 #endif
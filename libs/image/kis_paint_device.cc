@@ -15,6 +15,8 @@
 #include <QHash>
 #include <QIODevice>
 #include <qmath.h>
+#include <memory>
+#include <vector>
 #include <KisRegion.h>
 
 #include <klocalizedstring.h>
@@ -1297,6 +1299,25 @@ struct CheckFullyTransparent {
         return m_colorSpace->opacityU8(pixelData) == OPACITY_TRANSPARENT_U8;
     }
 
+    /**
+     * Checks if \p numPixels consecutive pixels are empty. \p emptyRow
+     * should point to a row of the same number of (transparent) default
+     * pixels. The rows are compared with memcmp(), which is vectorized
+     * by the C library, and only when the bytes differ (e.g. transparent
+     * pixels with non-zero color) we fall back to per-pixel checks.
+     */
+    bool isRowEmpty(const quint8 *pixelData, const quint8 *emptyRow, int numPixels, int pixelSize)
+    {
+        if (memcmp(emptyRow, pixelData, numPixels * pixelSize) == 0) return true;
+
+        for (int i = 0; i < numPixels; i++) {
+            if (!isPixelEmpty(pixelData)) return false;
+            pixelData += pixelSize;
+        }
+
+        return true;
+    }
+
 private:
     const KoColorSpace *m_colorSpace;
 };
@@ -1313,11 +1334,134 @@ struct CheckNonDefault {
         return memcmp(m_defaultPixel, pixelData, m_pixelSize) == 0;
     }
 
+    bool isRowEmpty(const quint8 *pixelData, const quint8 *emptyRow, int numPixels, int pixelSize)
+    {
+        return memcmp(emptyRow, pixelData, numPixels * pixelSize) == 0;
+    }
+
 private:
     int m_pixelSize;
     const quint8 *m_defaultPixel;
 };
 
+/**
+ * Calculates exact bounds of a rect \p rc that lies inside a single
+ * tile, which data starts at \p tileStart. We find the first and the
+ * last non-empty rows and then the left and the right boundary,
+ * comparing the pixels row-by-row directly in the tile's memory.
+ */
+template <class ComparePixelOp>
+QRect calculateExactBoundsInTile(const QRect &rc, const quint8 *tileStart, int rowStride, int pixelSize,
+                                 const quint8 *emptyRow, ComparePixelOp &compareOp)
+{
+    auto rowPtr = [tileStart, rowStride] (int row) {
+        return tileStart + row * rowStride;
+    };
+
+    int top = 0;
+    while (top < rc.height() &&
+           compareOp.isRowEmpty(rowPtr(top), emptyRow, rc.width(), pixelSize)) {
+
+        top++;
+    }
+
+    if (top >= rc.height()) return QRect();
+
+    int bottom = rc.height() - 1;
+    while (bottom > top &&
+           compareOp.isRowEmpty(rowPtr(bottom), emptyRow, rc.width(), pixelSize)) {
+
+        bottom--;
+    }
+
+    int left = rc.width() - 1;
+    int right = 0;
+
+    for (int row = top; row <= bottom; row++) {
+        const quint8 *ptr = rowPtr(row);
+
+        for (int col = 0; col < left; col++) {
+            if (!compareOp.isPixelEmpty(ptr + col * pixelSize)) {
+                left = col;
+                break;
+            }
+        }
+
+        for (int col = rc.width() - 1; col > right; col--) {
+            if (!compareOp.isPixelEmpty(ptr + col * pixelSize)) {
+                right = col;
+                break;
+            }
+        }
+    }
+
+    // the top row is known to be non-empty, so at least
+    // one of the loops above has found a pixel
+    right = qMax(left, right);
+
+    return QRect(rc.x() + left, rc.y() + top,
+                 right - left + 1, bottom - top + 1);
+}
+
+/**
+ * Calculates exact bounds of the pixels inside \p rects. The rects are
+ * split into the chunks that belong to a single tile each, and the
+ * chunks that lie completely inside the bounds found so far are
+ * skipped, since they cannot extend the result anyway.
+ */
+template <class ComparePixelOp>
+QRect calculateExactBoundsInTiles(const KisPaintDevice *device, const QVector<QRect> &rects, ComparePixelOp compareOp)
+{
+    const int pixelSize = device->pixelSize();
+
+    const KoColor defaultPixel = device->defaultPixel();
+    QByteArray emptyRow(KisTileData::WIDTH * pixelSize, Qt::Uninitialized);
+    for (int i = 0; i < KisTileData::WIDTH; i++) {
+        memcpy(emptyRow.data() + i * pixelSize, defaultPixel.data(), pixelSize);
+    }
+    const quint8 *emptyRowPtr = reinterpret_cast<const quint8*>(emptyRow.constData());
+
+    KisRandomConstAccessorSP accessor = device->createRandomConstAccessorNG();
+
+    QRect resultRect;
+
+    Q_FOREACH (const QRect &rc, rects) {
+        if (resultRect.contains(rc)) continue;
+
+        qint32 y = rc.y();
+        qint32 rowsRemaining = rc.height();
+
+        while (rowsRemaining > 0) {
+            const qint32 rows = qMin(rowsRemaining, accessor->numContiguousRows(y));
+
+            qint32 x = rc.x();
+            qint32 columnsRemaining = rc.width();
+
+            while (columnsRemaining > 0) {
+                const qint32 columns = qMin(columnsRemaining, accessor->numContiguousColumns(x));
+                const QRect chunkRect(x, y, columns, rows);
+
+                if (!resultRect.contains(chunkRect)) {
+                    const int rowStride = accessor->rowStride(x, y);
+                    accessor->moveTo(x, y);
+
+                    resultRect |= calculateExactBoundsInTile(chunkRect, accessor->rawDataConst(),
+                                                             rowStride, pixelSize,
+                                                             emptyRowPtr, compareOp);
+                }
+
+                x += columns;
+                columnsRemaining -= columns;
+            }
+
+            y += rows;
+            rowsRemaining -= rows;
+        }
+    }
+
+    return resultRect;
+}
+
 template <class ComparePixelOp>
 QRect calculateExactBoundsImpl(const KisPaintDevice *device, const QRect &startRect, const QRect &endRect, ComparePixelOp compareOp)
 {
@@ -1452,7 +1596,33 @@ QRect KisPaintDevice::calculateExactBounds(bool nonDefaultOnly) const
         }
     }
 
-    if (nonDefaultOnly) {
+    if (endRect.isEmpty()) {
+        /**
+         * All the pixels outside the allocated tiles are equal to the
+         * default pixel, so they are empty in both modes. Hence we can
+         * check the allocated tiles only, skipping the ones that cannot
+         * extend the bounds.
+         */
+
+        QVector<QRect> tileRects;
+
+        Q_FOREACH (const QRect &rc, region().rects()) {
+            const QRect clippedRect = rc & startRect;
+            if (clippedRect.isEmpty()) continue;
+
+            tileRects << clippedRect;
+        }
+
+        if (nonDefaultOnly) {
+            const KoColor defaultPixel = this->defaultPixel();
+            Impl::CheckNonDefault compareOp(pixelSize(), defaultPixel.data());
+            endRect = Impl::calculateExactBoundsInTiles(this, tileRects, compareOp);
+        } else {
+            Impl::CheckFullyTransparent compareOp(m_d->colorSpace());
+            endRect = Impl::calculateExactBoundsInTiles(this, tileRects, compareOp);
+        }
+
+    } else if (nonDefaultOnly) {
         const KoColor defaultPixel = this->defaultPixel();
         Impl::CheckNonDefault compareOp(pixelSize(), defaultPixel.data());
         endRect = Impl::calculateExactBoundsImpl(this, startRect, endRect, compareOp);
@@ -1822,6 +1992,70 @@ QImage KisPaintDevice::createThumbnail(qint32 maxw, qint32 maxh,
                            oversample, renderingIntent, conversionFlags);
 }
 
+namespace {
+
+void addPixelsToHistogram(const KisPaintDevice *device, KoHistogramProducer *producer, const QRect &rect)
+{
+    const KoColorSpace *cs = device->colorSpace();
+    KisHLineConstIteratorSP it = device->createHLineConstIteratorNG(rect.x(), rect.y(), rect.width());
+
+    for (int row = 0; row < rect.height(); ++row) {
+        int pixelsLeft = rect.width();
+
+        while (pixelsLeft > 0) {
+            const int numPixels = qMin(it->nConseqPixels(), pixelsLeft);
+            producer->addRegionToBin(it->oldRawData(), 0, numPixels, cs);
+            it->nextPixels(numPixels);
+            pixelsLeft -= numPixels;
+        }
+
+        it->nextRow();
+    }
+}
+
+}
+
+void KisPaintDevice::calculateHistogram(KoHistogramProducer *producer, const QRect &rect) const
+{
+    if (rect.isEmpty()) return;
+
+    const QVector<QRect> patches = KritaUtils::splitRectIntoPatches(rect, KritaUtils::optimalPatchSize());
+
+    std::vector<std::unique_ptr<KoHistogramProducer>> patchProducers;
+    if (patches.size() > 1) {
+        for (int i = 0; i < patches.size(); i++) {
+            KoHistogramProducer *patchProducer = producer->createEmptyCopy();
+            if (!patchProducer) {
+                patchProducers.clear();
+                break;
+            }
+            patchProducers.emplace_back(patchProducer);
+        }
+    }
+
+    if (patchProducers.empty()) {
+        addPixelsToHistogram(this, producer, rect);
+        return;
+    }
+
+    KritaUtils::processConcurrently(patches.size(),
+        [&] (int i) {
+            addPixelsToHistogram(this, patchProducers[i].get(), patches[i]);
+        });
+
+    // the bins are integer, so the result doesn't depend on the order
+    for (const auto &patchProducer : patchProducers) {
+        producer->addBins(patchProducer.get());
+    }
+}
+
+void KisPaintDevice::calculateHistogramCached(KoHistogramProducer *producer, const QRect &rect)
+{
+    if (rect.isEmpty()) return;
+
+    m_d->cache()->addHistogramBins(producer, rect);
+}
+
 KisHLineIteratorSP KisPaintDevice::createHLineIteratorNG(qint32 x, qint32 y, qint32 w)
 {
     m_d->cache()->invalidate();
@@ -33,6 +33,7 @@ class QIODevice;
 class KoColor;
 class KoColorSpace;
 class KoColorProfile;
+class KoHistogramProducer;
 
 class KisRegion;
 class KisDataManager;
@@ -583,6 +584,20 @@ public:
                            KoColorConversionTransformation::Intent renderingIntent = KoColorConversionTransformation::internalRenderingIntent(),
                            KoColorConversionTransformation::ConversionFlags conversionFlags = KoColorConversionTransformation::internalConversionFlags());
 
+    /**
+     * Adds the pixels of \p rect to the bins of \p producer. When the producer
+     * can be split (see KoHistogramProducer::createEmptyCopy()), the pixels
+     * are counted in concurrent patches.
+     */
+    void calculateHistogram(KoHistogramProducer *producer, const QRect &rect) const;
+
+    /**
+     * Cached version of calculateHistogram(). The bins are reused until the
+     * device is changed, so the repeated requests, e.g. by the levels filter
+     * and auto levels, don't need to read the pixels again.
+     */
+    void calculateHistogramCached(KoHistogramProducer *producer, const QRect &rect);
+
     /**
      * Fill c and opacity with the values found at x and y.
      *
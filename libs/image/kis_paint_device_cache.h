@@ -9,9 +9,13 @@
 
 #include "kis_lock_free_cache.h"
 #include <QElapsedTimer>
+#include <QMutex>
+#include <QMutexLocker>
 #include <QReadWriteLock>
 #include <QReadLocker>
+#include <QSharedPointer>
 #include <QWriteLocker>
+#include <KoHistogramProducer.h>
 
 class KisPaintDeviceCache
 {
@@ -109,6 +113,68 @@ public:
         return thumbnail;
     }
 
+    /**
+     * Adds the bins of the pixels in \p rect to \p producer. The bins are
+     * counted again only when the device has been changed since the last
+     * request with the same kind of producer and the same rect.
+     */
+    void addHistogramBins(KoHistogramProducer *producer, const QRect &rect) {
+        const int sequenceNumber = m_sequenceNumber;
+        QSharedPointer<const KoHistogramProducer> bins;
+
+        {
+            QMutexLocker l(&m_histogramsLock);
+            Q_FOREACH (const HistogramItem &item, m_histograms) {
+                if (item.sequenceNumber == sequenceNumber && item.matches(producer, rect)) {
+                    bins = item.bins;
+                    break;
+                }
+            }
+        }
+
+        if (!bins) {
+            QSharedPointer<KoHistogramProducer> newBins(producer->createEmptyCopy());
+
+            // the producer cannot keep its bins separately
+            if (!newBins) {
+                m_paintDevice->calculateHistogram(producer, rect);
+                return;
+            }
+
+            m_paintDevice->calculateHistogram(newBins.data(), rect);
+            bins = newBins;
+
+            HistogramItem newItem;
+            newItem.producerId = producer->id().id();
+            newItem.rect = rect;
+            newItem.viewFrom = producer->viewFrom();
+            newItem.viewWidth = producer->viewWidth();
+            newItem.skipTransparent = producer->skipTransparent();
+            newItem.skipUnselected = producer->skipUnselected();
+            newItem.sequenceNumber = sequenceNumber;
+            newItem.bins = bins;
+
+            QMutexLocker l(&m_histogramsLock);
+
+            for (auto it = m_histograms.begin(); it != m_histograms.end();) {
+                if (it->sequenceNumber != sequenceNumber || it->matches(producer, rect)) {
+                    it = m_histograms.erase(it);
+                } else {
+                    ++it;
+                }
+            }
+
+            // the levels filter uses two histograms at once
+            if (m_histograms.size() >= 4) {
+                m_histograms.removeFirst();
+            }
+
+            m_histograms.append(newItem);
+        }
+
+        producer->addBins(bins.data());
+    }
+
     int sequenceNumber() const {
         return m_sequenceNumber;
     }
@@ -154,6 +220,33 @@ private:
     bool m_thumbnailsValid {false};
     QMap<int, QMap<int, QMap<qreal,QImage> > > m_thumbnails;
 
+    struct HistogramItem {
+        QString producerId;
+        QRect rect;
+        qreal viewFrom {0.0};
+        qreal viewWidth {0.0};
+        bool skipTransparent {false};
+        bool skipUnselected {false};
+        int sequenceNumber {-1};
+        QSharedPointer<const KoHistogramProducer> bins;
+
+        bool matches(const KoHistogramProducer *producer, const QRect &rc) const {
+            return producerId == producer->id().id() &&
+                rect == rc &&
+                viewFrom == producer->viewFrom() &&
+                viewWidth == producer->viewWidth() &&
+                skipTransparent == producer->skipTransparent() &&
+                skipUnselected == producer->skipUnselected();
+        }
+    };
+
+    /**
+     * The items are tagged with the sequence number of the device, so
+     * invalidate() doesn't need to touch them
+     */
+    QMutex m_histogramsLock;
+    QList<HistogramItem> m_histograms;
+
     QAtomicInt m_sequenceNumber;
 };
 
@@ -714,6 +714,15 @@ void KisPainter::bitBltImpl(qint32 dstX, qint32 dstY,
         KisPaintDeviceSP selectionProjection(d->selection->projection());
         KisRandomConstAccessorSP maskIt = selectionProjection->createRandomConstAccessorNG();
 
+        /**
+         * The chunks of the mask, which are fully unselected, can be skipped
+         * only by the ops, which don't touch the destination pixels when
+         * the mask is transparent
+         */
+        const bool canSkipUnselectedChunks =
+            d->compositeOpId == COMPOSITE_OVER ||
+            d->compositeOpId == COMPOSITE_COPY;
+
         while (rowsRemaining > 0) {
 
             qint32 dstX_ = dstX;
@@ -746,12 +755,29 @@ void KisPainter::bitBltImpl(qint32 dstX, qint32 dstY,
                 qint32 maskRowStride = maskIt->rowStride(dstX_, dstY_);
                 maskIt->moveTo(dstX_, dstY_);
 
+                const quint8 *maskRowStart = maskIt->rawDataConst();
+                const KisPixelSelection::PatchType maskType =
+                    KisPixelSelection::patchType(maskRowStart, maskRowStride, rows, columns);
+
+                if (maskType == KisPixelSelection::UnselectedPatch && canSkipUnselectedChunks) {
+                    srcX_ += columns;
+                    dstX_ += columns;
+                    columnsRemaining -= columns;
+                    continue;
+                }
+
+                if (maskType == KisPixelSelection::SelectedPatch) {
+                    // a fully selected mask is the same as no mask at all
+                    maskRowStart = 0;
+                    maskRowStride = 0;
+                }
+
                 d->paramInfo.dstRowStart   = dstIt->rawData();
                 d->paramInfo.dstRowStride  = dstRowStride;
                 // if we don't use the oldRawData, we need to access the rawData of the source device.
                 d->paramInfo.srcRowStart   = useOldSrcData ? srcIt->oldRawData() : static_cast<KisRandomAccessor2*>(srcIt.data())->rawData();
                 d->paramInfo.srcRowStride  = srcRowStride;
-                d->paramInfo.maskRowStart  = static_cast<KisRandomAccessor2*>(maskIt.data())->rawData();
+                d->paramInfo.maskRowStart  = maskRowStart;
                 d->paramInfo.maskRowStride = maskRowStride;
                 d->paramInfo.rows          = rows;
                 d->paramInfo.cols          = columns;
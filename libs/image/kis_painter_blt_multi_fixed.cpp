@@ -12,118 +12,95 @@
 #include "kis_random_accessor_ng.h"
 #include "KisRenderedDab.h"
 
-void KisPainter::Private::applyDevice(const QRect &applyRect,
-                                      const KisRenderedDab &dab,
-                                      KisRandomAccessorSP dstIt,
-                                      const KoColorSpace *srcColorSpace,
-                                      KoCompositeOp::ParameterInfo &localParamInfo)
+void KisPainter::Private::applyDevicesTileByTile(const QRect &applyRect,
+                                                 const QList<KisRenderedDab> &devices,
+                                                 KisRandomAccessorSP dstIt,
+                                                 KisRandomConstAccessorSP maskIt,
+                                                 const KoColorSpace *srcColorSpace,
+                                                 KoCompositeOp::ParameterInfo &localParamInfo)
 {
-    const QRect dabRect = dab.realBounds();
-    const QRect rc = applyRect & dabRect;
+    /**
+     * We walk the destination device tile-by-tile and apply all the
+     * overlapping dabs to every tile before moving to the next one. For
+     * dense strokes many dabs overlap the same tile, so this way the
+     * destination pixels are fetched into the CPU cache only once and all
+     * the dabs are composited while the tile is still hot. The order of
+     * the dabs inside each tile is preserved, so the result is exactly the
+     * same as if the dabs were applied one after another.
+     */
 
     const int srcPixelSize = srcColorSpace->pixelSize();
-    const int dabRowStride = srcPixelSize * dabRect.width();
+    const int dstPixelSize = device->pixelSize();
+    const int maskPixelSize = maskIt ? selection->projection()->pixelSize() : 0;
 
-
-    qint32 dstY = rc.y();
-    qint32 rowsRemaining = rc.height();
+    qint32 dstY = applyRect.y();
+    qint32 rowsRemaining = applyRect.height();
 
     while (rowsRemaining > 0) {
-        qint32 dstX = rc.x();
-
-        qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
-        qint32 rows = qMin(rowsRemaining, numContiguousDstRows);
-
-        qint32 columnsRemaining = rc.width();
-
-        while (columnsRemaining > 0) {
-
-            qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
-            qint32 columns = qMin(numContiguousDstColumns, columnsRemaining);
-
-            qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
-            dstIt->moveTo(dstX, dstY);
+        qint32 dstX = applyRect.x();
 
-            localParamInfo.dstRowStart   = dstIt->rawData();
-            localParamInfo.dstRowStride  = dstRowStride;
-            localParamInfo.maskRowStart  = 0;
-            localParamInfo.maskRowStride = 0;
-            localParamInfo.rows          = rows;
-            localParamInfo.cols          = columns;
-
-
-            const int dabX = dstX - dabRect.x();
-            const int dabY = dstY - dabRect.y();
-
-            localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
-            localParamInfo.srcRowStride  = dabRowStride;
-            localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
-            localParamInfo.flow = dab.flow;
-            colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp(srcColorSpace), renderingIntent, conversionFlags);
-
-            dstX += columns;
-            columnsRemaining -= columns;
+        qint32 rows = qMin(rowsRemaining, dstIt->numContiguousRows(dstY));
+        if (maskIt) {
+            rows = qMin(rows, maskIt->numContiguousRows(dstY));
         }
 
-        dstY += rows;
-        rowsRemaining -= rows;
-    }
-
-}
+        qint32 columnsRemaining = applyRect.width();
 
-void KisPainter::Private::applyDeviceWithSelection(const QRect &applyRect,
-                                                   const KisRenderedDab &dab,
-                                                   KisRandomAccessorSP dstIt,
-                                                   KisRandomConstAccessorSP maskIt,
-                                                   const KoColorSpace *srcColorSpace,
-                                                   KoCompositeOp::ParameterInfo &localParamInfo)
-{
-    const QRect dabRect = dab.realBounds();
-    const QRect rc = applyRect & dabRect;
-
-    const int srcPixelSize = srcColorSpace->pixelSize();
-    const int dabRowStride = srcPixelSize * dabRect.width();
+        while (columnsRemaining > 0) {
 
+            qint32 columns = qMin(columnsRemaining, dstIt->numContiguousColumns(dstX));
+            if (maskIt) {
+                columns = qMin(columns, maskIt->numContiguousColumns(dstX));
+            }
 
-    qint32 dstY = rc.y();
-    qint32 rowsRemaining = rc.height();
+            const QRect tileRect(dstX, dstY, columns, rows);
 
-    while (rowsRemaining > 0) {
-        qint32 dstX = rc.x();
+            qint32 dstRowStride = 0;
+            quint8 *dstTileStart = 0;
 
-        qint32 numContiguousDstRows = dstIt->numContiguousRows(dstY);
-        qint32 numContiguousMaskRows = maskIt->numContiguousRows(dstY);
-        qint32 rows = qMin(rowsRemaining, qMin(numContiguousDstRows, numContiguousMaskRows));
+            qint32 maskRowStride = 0;
+            const quint8 *maskTileStart = 0;
 
-        qint32 columnsRemaining = rc.width();
+            Q_FOREACH (const KisRenderedDab &dab, devices) {
+                const QRect dabRect = dab.realBounds();
+                const QRect rc = tileRect & dabRect;
+                if (rc.isEmpty()) continue;
 
-        while (columnsRemaining > 0) {
+                // fetch the tile lazily to avoid creating tiles
+                // that are not touched by any dab
+                if (!dstTileStart) {
+                    dstRowStride = dstIt->rowStride(dstX, dstY);
+                    dstIt->moveTo(dstX, dstY);
+                    dstTileStart = dstIt->rawData();
 
-            qint32 numContiguousDstColumns = dstIt->numContiguousColumns(dstX);
-            qint32 numContiguousMaskColumns = maskIt->numContiguousColumns(dstX);
-            qint32 columns = qMin(columnsRemaining, qMin(numContiguousDstColumns, numContiguousMaskColumns));
+                    if (maskIt) {
+                        maskRowStride = maskIt->rowStride(dstX, dstY);
+                        maskIt->moveTo(dstX, dstY);
+                        maskTileStart = maskIt->rawDataConst();
+                    }
+                }
 
-            qint32 dstRowStride = dstIt->rowStride(dstX, dstY);
-            qint32 maskRowStride = maskIt->rowStride(dstX, dstY);
-            dstIt->moveTo(dstX, dstY);
-            maskIt->moveTo(dstX, dstY);
+                const int dabRowStride = srcPixelSize * dabRect.width();
 
-            localParamInfo.dstRowStart   = dstIt->rawData();
-            localParamInfo.dstRowStride  = dstRowStride;
-            localParamInfo.maskRowStart  = maskIt->rawDataConst();
-            localParamInfo.maskRowStride = maskRowStride;
-            localParamInfo.rows          = rows;
-            localParamInfo.cols          = columns;
+                const int tileX = rc.x() - tileRect.x();
+                const int tileY = rc.y() - tileRect.y();
 
+                localParamInfo.dstRowStart   = dstTileStart + tileX * dstPixelSize + tileY * dstRowStride;
+                localParamInfo.dstRowStride  = dstRowStride;
+                localParamInfo.maskRowStart  = maskTileStart ? maskTileStart + tileX * maskPixelSize + tileY * maskRowStride : 0;
+                localParamInfo.maskRowStride = maskRowStride;
+                localParamInfo.rows          = rc.height();
+                localParamInfo.cols          = rc.width();
 
-            const int dabX = dstX - dabRect.x();
-            const int dabY = dstY - dabRect.y();
+                const int dabX = rc.x() - dabRect.x();
+                const int dabY = rc.y() - dabRect.y();
 
-            localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
-            localParamInfo.srcRowStride  = dabRowStride;
-            localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
-            localParamInfo.flow = dab.flow;
-            colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp(srcColorSpace), renderingIntent, conversionFlags);
+                localParamInfo.srcRowStart   = dab.device->constData() + dabX * srcPixelSize + dabY * dabRowStride;
+                localParamInfo.srcRowStride  = dabRowStride;
+                localParamInfo.setOpacityAndAverage(dab.opacity, dab.averageOpacity);
+                localParamInfo.flow = dab.flow;
+                colorSpace->bitBlt(srcColorSpace, localParamInfo, compositeOp(srcColorSpace), renderingIntent, conversionFlags);
+            }
 
             dstX += columns;
             columnsRemaining -= columns;
@@ -132,7 +109,6 @@ void KisPainter::Private::applyDeviceWithSelection(const QRect &applyRect,
         dstY += rows;
         rowsRemaining -= rows;
     }
-
 }
 
 void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> allSrcDevices)
@@ -168,15 +144,7 @@ void KisPainter::bltFixed(const QRect &applyRect, const QList<KisRenderedDab> al
     KisRandomAccessorSP dstIt = d->device->createRandomAccessorNG();
     KisRandomConstAccessorSP maskIt = d->selection ? d->selection->projection()->createRandomConstAccessorNG() : 0;
 
-    if (maskIt) {
-        Q_FOREACH (const KisRenderedDab &dab, devices) {
-            d->applyDeviceWithSelection(rc, dab, dstIt, maskIt, srcColorSpace, localParamInfo);
-        }
-    } else {
-        Q_FOREACH (const KisRenderedDab &dab, devices) {
-            d->applyDevice(rc, dab, dstIt, srcColorSpace, localParamInfo);
-        }
-    }
+    d->applyDevicesTileByTile(rc, devices, dstIt, maskIt, srcColorSpace, localParamInfo);
 
 
 #if 0
@@ -15,6 +15,7 @@
 #include <QTransform>
 #include <QVector3D>
 #include <QPolygonF>
+#include <QMutex>
 
 #include <KoUpdater.h>
 #include <KoColor.h>
@@ -107,6 +108,16 @@ void KisPerspectiveTransformWorker::setForwardTransform(const QTransform &transf
 }
 
 
+namespace {
+
+/**
+ * The destination is split into tile-aligned patches of this size,
+ * which are transformed concurrently
+ */
+const int transformPatchSize = 256;
+
+}
+
 struct BilinearWrapper
 {
     using SrcAccessorSP = KisRandomSubAccessorSP;
@@ -167,12 +178,18 @@ void KisPerspectiveTransformWorker::runImpl()
 
     KIS_ASSERT_RECOVER_NOOP(!m_isIdentity);
 
-    KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, m_dstRegion.rectCount());
+    const QVector<QRect> patches =
+        KritaUtils::splitRegionIntoPatches(m_dstRegion, QSize(transformPatchSize, transformPatchSize));
 
-    SrcAccessorWrapper srcAcc(cloneDevice);
-    KisRandomAccessorSP accessor = m_dev->createRandomAccessorNG();
+    KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, patches.size());
+    QMutex progressLock;
+
+    KritaUtils::processConcurrently(patches.size(), [&] (int index) {
+        const QRect &rect = patches.at(index);
+
+        SrcAccessorWrapper srcAcc(cloneDevice);
+        KisRandomAccessorSP accessor = m_dev->createRandomAccessorNG();
 
-    Q_FOREACH (const QRect &rect, m_dstRegion.rects()) {
         for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
             for (int x = rect.x(); x < rect.x() + rect.width(); ++x) {
 
@@ -185,8 +202,10 @@ void KisPerspectiveTransformWorker::runImpl()
                 }
             }
         }
+
+        QMutexLocker l(&progressLock);
         progressHelper.step();
-    }
+    });
 }
 
 void KisPerspectiveTransformWorker::run(SampleType sampleType)
@@ -213,25 +232,37 @@ void KisPerspectiveTransformWorker::runPartialDst(KisPaintDeviceSP srcDev,
         gc.setCompositeOpId(COMPOSITE_COPY);
         gc.bitBlt(dstRect.topLeft(), srcDev, m_backwardTransform.mapRect(dstRect));
     } else {
-        KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, dstRect.height());
+        const QVector<QRect> patches =
+            KritaUtils::splitRectIntoPatches(dstRect, QSize(transformPatchSize, transformPatchSize));
 
-        KisRandomSubAccessorSP srcAcc = srcDev->createRandomSubAccessor();
-        KisRandomAccessorSP accessor = dstDev->createRandomAccessorNG();
+        KisProgressUpdateHelper progressHelper(m_progressUpdater, 100, patches.size());
+        QMutex progressLock;
 
-        for (int y = dstRect.y(); y < dstRect.y() + dstRect.height(); ++y) {
-            for (int x = dstRect.x(); x < dstRect.x() + dstRect.width(); ++x) {
+        const bool wrapAroundMode = srcDev->defaultBounds()->wrapAroundMode();
 
-                QPointF dstPoint(x, y);
-                QPointF srcPoint = m_backwardTransform.map(dstPoint);
+        KritaUtils::processConcurrently(patches.size(), [&] (int index) {
+            const QRect &rect = patches.at(index);
 
-                if (srcClipRect.contains(srcPoint) || srcDev->defaultBounds()->wrapAroundMode()) {
-                    accessor->moveTo(dstPoint.x(), dstPoint.y());
-                    srcAcc->moveTo(srcPoint.x(), srcPoint.y());
-                    srcAcc->sampledOldRawData(accessor->rawData());
+            KisRandomSubAccessorSP srcAcc = srcDev->createRandomSubAccessor();
+            KisRandomAccessorSP accessor = dstDev->createRandomAccessorNG();
+
+            for (int y = rect.y(); y < rect.y() + rect.height(); ++y) {
+                for (int x = rect.x(); x < rect.x() + rect.width(); ++x) {
+
+                    QPointF dstPoint(x, y);
+                    QPointF srcPoint = m_backwardTransform.map(dstPoint);
+
+                    if (srcClipRect.contains(srcPoint) || wrapAroundMode) {
+                        accessor->moveTo(dstPoint.x(), dstPoint.y());
+                        srcAcc->moveTo(srcPoint.x(), srcPoint.y());
+                        srcAcc->sampledOldRawData(accessor->rawData());
+                    }
                 }
             }
+
+            QMutexLocker l(&progressLock);
             progressHelper.step();
-        }
+        });
     }
 }
 
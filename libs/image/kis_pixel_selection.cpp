@@ -14,6 +14,9 @@
 #include <QMutex>
 #include <QPoint>
 #include <QPolygon>
+#include <QScopedPointer>
+
+#include <algorithm>
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
@@ -26,9 +29,208 @@
 #include "kis_image.h"
 #include "kis_fill_painter.h"
 #include "kis_outline_generator.h"
+#include "KisOutlineTileCache.h"
 #include <kis_iterator_ng.h>
+#include <kis_random_accessor_ng.h>
+#include "kis_datamanager.h"
+#include "krita_utils.h"
 #include "kis_lod_transform.h"
 #include "kundo2command.h"
+#include "kis_algebra_2d.h"
+
+namespace {
+
+/**
+ * The simplified outlines are generated only for the outlines with more
+ * points than this, the simple ones are cheap enough to be drawn as is
+ */
+const int minSimplifiedOutlinePoints = 10000;
+const int maxSimplifiedOutlineLevelOfDetail = 3;
+
+/**
+ * Snaps the vertices of the outline to the grid of 2^levelOfDetail pixels,
+ * which is enough for the views zoomed out to 1/2^levelOfDetail. The
+ * contours collapsed into a point or a line are kept visible as a single
+ * cell of the grid.
+ */
+QPainterPath simplifiedOutline(const QVector<QPolygon> &polygons, int levelOfDetail)
+{
+    using KisAlgebra2D::divideFloor;
+
+    const int step = 1 << levelOfDetail;
+    QPainterPath path;
+    QPolygon simplified;
+    QVector<QPoint> collapsedCells;
+
+    Q_FOREACH (const QPolygon &polygon, polygons) {
+        simplified.clear();
+
+        Q_FOREACH (const QPoint &pt, polygon) {
+            const QPoint snapped(divideFloor(pt.x() + step / 2, step) * step,
+                                 divideFloor(pt.y() + step / 2, step) * step);
+
+            if (!simplified.isEmpty() && simplified.last() == snapped) continue;
+
+            const int size = simplified.size();
+            if (size >= 2) {
+                const QPoint d1 = simplified[size - 1] - simplified[size - 2];
+                const QPoint d2 = snapped - simplified[size - 1];
+
+                if (d1.x() * d2.y() == d1.y() * d2.x()) {
+                    if (snapped == simplified[size - 2]) {
+                        simplified.removeLast();
+                    } else {
+                        simplified.last() = snapped;
+                    }
+                    continue;
+                }
+            }
+
+            simplified << snapped;
+        }
+
+        while (simplified.size() > 1 && simplified.first() == simplified.last()) {
+            simplified.removeLast();
+        }
+
+        if (simplified.size() < 3) {
+            collapsedCells << simplified.first();
+        } else {
+            path.addPolygon(simplified);
+            path.closeSubpath();
+        }
+    }
+
+    // many tiny contours may collapse into the same cell
+    std::sort(collapsedCells.begin(), collapsedCells.end(),
+              [] (const QPoint &lhs, const QPoint &rhs) {
+                  return lhs.y() < rhs.y() || (lhs.y() == rhs.y() && lhs.x() < rhs.x());
+              });
+    collapsedCells.erase(std::unique(collapsedCells.begin(), collapsedCells.end()),
+                         collapsedCells.end());
+
+    Q_FOREACH (const QPoint &cell, collapsedCells) {
+        path.addRect(QRect(cell, QSize(step, step)));
+    }
+
+    return path;
+}
+
+QRect outlineRect(const KisPixelSelection *selection)
+{
+    QRect selectionExtent = selection->selectedExactRect();
+
+    /**
+     * When the default pixel is not fully transparent, the
+     * exactBounds() return extent of the device instead. To make this
+     * value sane we should limit the calculated area by the bounds of
+     * the image.
+     */
+    if (*selection->defaultPixel().data() != MIN_SELECTED) {
+        selectionExtent &= selection->defaultBounds()->bounds();
+    }
+
+    return selectionExtent;
+}
+
+const QSize selectionPatchSize(64, 64);
+
+enum PatchAction {
+    KeepPatch,
+    FillUnselected,
+    FillSelected,
+    CopySourcePatch,
+    ProcessPixels
+};
+
+/**
+ * Calls \p pixelFunc(dstPixel, srcPixel) for every pixel of \p rect. The
+ * source pixels are read from the old data of \p src, the same way as the
+ * rest of the selection operations do.
+ */
+template <class PixelFunc>
+void processPixels(KisPaintDevice *dst, KisPaintDeviceSP src, const QRect &rect, PixelFunc pixelFunc)
+{
+    KisRandomAccessorSP dstIt = dst->createRandomAccessorNG();
+    KisRandomConstAccessorSP srcIt = src->createRandomConstAccessorNG();
+
+    for (qint32 y = rect.top(); y <= rect.bottom();) {
+        const qint32 rows = qMin(qMin(dstIt->numContiguousRows(y),
+                                      srcIt->numContiguousRows(y)),
+                                 rect.bottom() - y + 1);
+
+        for (qint32 x = rect.left(); x <= rect.right();) {
+            const qint32 columns = qMin(qMin(dstIt->numContiguousColumns(x),
+                                             srcIt->numContiguousColumns(x)),
+                                        rect.right() - x + 1);
+
+            const qint32 dstRowStride = dstIt->rowStride(x, y);
+            const qint32 srcRowStride = srcIt->rowStride(x, y);
+            dstIt->moveTo(x, y);
+            srcIt->moveTo(x, y);
+
+            quint8 *dstRow = dstIt->rawData();
+            const quint8 *srcRow = srcIt->oldRawData();
+
+            for (qint32 row = 0; row < rows; row++) {
+                for (qint32 column = 0; column < columns; column++) {
+                    pixelFunc(dstRow[column], srcRow[column]);
+                }
+
+                dstRow += dstRowStride;
+                srcRow += srcRowStride;
+            }
+
+            x += columns;
+        }
+
+        y += rows;
+    }
+}
+
+/**
+ * Applies a boolean operation to \p rect of \p dst. The patches, where
+ * the result depends on the kinds of the source and destination patches
+ * only (e.g. a fully selected patch is added), are processed as a whole,
+ * the rest of them are processed pixel by pixel with \p pixelFunc.
+ */
+template <class ActionFunc, class PixelFunc>
+void applyPatchwise(KisPixelSelection *dst, KisPixelSelectionSP src, const QRect &rect,
+                    ActionFunc chooseAction, PixelFunc pixelFunc)
+{
+    /**
+     * The pixel operations read the old data of the source, so it can be
+     * classified only when its current data is the same, i.e. it has no
+     * transaction open
+     */
+    const bool canClassifyPatches = !src->dataManager()->hasCurrentMemento();
+
+    Q_FOREACH (const QRect &patch, KritaUtils::splitRectIntoPatches(rect, selectionPatchSize)) {
+        const PatchAction action = canClassifyPatches ?
+            chooseAction(src->patchType(patch), dst->patchType(patch)) : ProcessPixels;
+
+        switch (action) {
+        case KeepPatch:
+            break;
+        case FillUnselected:
+            dst->fill(patch.x(), patch.y(), patch.width(), patch.height(), &MIN_SELECTED);
+            break;
+        case FillSelected:
+            dst->fill(patch.x(), patch.y(), patch.width(), patch.height(), &MAX_SELECTED);
+            break;
+        case CopySourcePatch:
+            processPixels(dst, src, patch, [] (quint8 &dstPixel, quint8 srcPixel) {
+                dstPixel = srcPixel;
+            });
+            break;
+        case ProcessPixels:
+            processPixels(dst, src, patch, pixelFunc);
+            break;
+        }
+    }
+}
+
+}
 
 
 struct Q_DECL_HIDDEN KisPixelSelection::Private {
@@ -38,6 +240,10 @@ struct Q_DECL_HIDDEN KisPixelSelection::Private {
     bool outlineCacheValid;
     QMutex outlineCacheMutex;
 
+    QVector<QPainterPath> simplifiedOutlineCache;
+    /// created on the first recalculation of the outline cache
+    QScopedPointer<KisOutlineTileCache> outlineTileCache;
+
     bool thumbnailImageValid;
     QImage thumbnailImage;
     QTransform thumbnailImageTransform;
@@ -69,6 +275,7 @@ KisPixelSelection::KisPixelSelection(const KisPixelSelection& rhs, KritaUtils::D
     // parent selection is not supposed to be shared
     m_d->outlineCache = rhs.m_d->outlineCache;
     m_d->outlineCacheValid = rhs.m_d->outlineCacheValid;
+    m_d->simplifiedOutlineCache = rhs.m_d->simplifiedOutlineCache;
 
     m_d->thumbnailImageValid = rhs.m_d->thumbnailImageValid;
     m_d->thumbnailImage = rhs.m_d->thumbnailImage;
@@ -111,6 +318,7 @@ bool KisPixelSelection::read(QIODevice *stream)
 {
     bool retval = KisPaintDevice::read(stream);
     m_d->outlineCacheValid = false;
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
     return retval;
 }
@@ -134,6 +342,7 @@ void KisPixelSelection::select(const QRect & rc, quint8 selectedness)
             m_d->outlineCache -= path;
         }
     }
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -177,6 +386,7 @@ void KisPixelSelection::copyAlphaFrom(KisPaintDeviceSP src, const QRect &process
 
     m_d->outlineCacheValid = false;
     m_d->outlineCache = QPainterPath();
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -185,19 +395,18 @@ void KisPixelSelection::addSelection(KisPixelSelectionSP selection)
     QRect r = selection->selectedRect();
     if (r.isEmpty()) return;
 
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-        do {
-            if (*src->oldRawData() + *dst->rawData() < MAX_SELECTED)
-                *dst->rawData() = *src->oldRawData() + *dst->rawData();
+    applyPatchwise(this, selection, r,
+        [] (PatchType srcType, PatchType dstType) {
+            return srcType == UnselectedPatch || dstType == SelectedPatch ? KeepPatch :
+                srcType == SelectedPatch ? FillSelected :
+                dstType == UnselectedPatch ? CopySourcePatch : ProcessPixels;
+        },
+        [] (quint8 &dstPixel, quint8 srcPixel) {
+            if (srcPixel + dstPixel < MAX_SELECTED)
+                dstPixel = srcPixel + dstPixel;
             else
-                *dst->rawData() = MAX_SELECTED;
-
-        } while (src->nextPixel() && dst->nextPixel());
-        dst->nextRow();
-        src->nextRow();
-    }
+                dstPixel = MAX_SELECTED;
+        });
 
     const quint8 defPixel = qMax(*defaultPixel().data(), *selection->defaultPixel().data());
     setDefaultPixel(KoColor(&defPixel, colorSpace()));
@@ -208,6 +417,7 @@ void KisPixelSelection::addSelection(KisPixelSelectionSP selection)
         m_d->outlineCache += selection->outlineCache();
     }
 
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -216,20 +426,17 @@ void KisPixelSelection::subtractSelection(KisPixelSelectionSP selection)
     QRect r = selection->selectedRect();
     if (r.isEmpty()) return;
 
-
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-        do {
-            if (*dst->rawData() - *src->oldRawData() > MIN_SELECTED)
-                *dst->rawData() = *dst->rawData() - *src->oldRawData();
+    applyPatchwise(this, selection, r,
+        [] (PatchType srcType, PatchType dstType) {
+            return srcType == UnselectedPatch || dstType == UnselectedPatch ? KeepPatch :
+                srcType == SelectedPatch ? FillUnselected : ProcessPixels;
+        },
+        [] (quint8 &dstPixel, quint8 srcPixel) {
+            if (dstPixel - srcPixel > MIN_SELECTED)
+                dstPixel = dstPixel - srcPixel;
             else
-                *dst->rawData() = MIN_SELECTED;
-
-        } while (src->nextPixel() && dst->nextPixel());
-        dst->nextRow();
-        src->nextRow();
-    }
+                dstPixel = MIN_SELECTED;
+        });
 
     const quint8 defPixel = *selection->defaultPixel().data() > *defaultPixel().data()
                             ? MIN_SELECTED
@@ -242,6 +449,7 @@ void KisPixelSelection::subtractSelection(KisPixelSelectionSP selection)
         m_d->outlineCache -= selection->outlineCache();
     }
 
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -253,15 +461,15 @@ void KisPixelSelection::intersectSelection(KisPixelSelectionSP selection)
         return;
     }
 
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-        do {
-            *dst->rawData() = qMin(*dst->rawData(), *src->oldRawData());
-        }  while (src->nextPixel() && dst->nextPixel());
-        dst->nextRow();
-        src->nextRow();
-    }
+    applyPatchwise(this, selection, r,
+        [] (PatchType srcType, PatchType dstType) {
+            return srcType == SelectedPatch || dstType == UnselectedPatch ? KeepPatch :
+                srcType == UnselectedPatch ? FillUnselected :
+                dstType == SelectedPatch ? CopySourcePatch : ProcessPixels;
+        },
+        [] (quint8 &dstPixel, quint8 srcPixel) {
+            dstPixel = qMin(dstPixel, srcPixel);
+        });
 
     const quint8 defPixel = qMin(*defaultPixel().data(), *selection->defaultPixel().data());
     setDefaultPixel(KoColor(&defPixel, colorSpace()));
@@ -275,6 +483,7 @@ void KisPixelSelection::intersectSelection(KisPixelSelectionSP selection)
         m_d->outlineCache.closeSubpath();
     }
 
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -283,17 +492,14 @@ void KisPixelSelection::symmetricdifferenceSelection(KisPixelSelectionSP selecti
     QRect r = selection->selectedRect().united(selectedRect());
     if (r.isEmpty()) return;
 
-    KisHLineIteratorSP dst = createHLineIteratorNG(r.x(), r.y(), r.width());
-    KisHLineConstIteratorSP src = selection->createHLineConstIteratorNG(r.x(), r.y(), r.width());
-    for (int i = 0; i < r.height(); ++i) {
-
-        do {
-            *dst->rawData() = abs(*dst->rawData() - *src->oldRawData());
-        }  while (src->nextPixel() && dst->nextPixel());
-
-        dst->nextRow();
-        src->nextRow();
-    }
+    applyPatchwise(this, selection, r,
+        [] (PatchType srcType, PatchType dstType) {
+            return srcType == UnselectedPatch ? KeepPatch :
+                dstType == UnselectedPatch ? CopySourcePatch : ProcessPixels;
+        },
+        [] (quint8 &dstPixel, quint8 srcPixel) {
+            dstPixel = abs(dstPixel - srcPixel);
+        });
 
     const quint8 defPixel = abs(*defaultPixel().data() - *selection->defaultPixel().data());
     setDefaultPixel(KoColor(&defPixel, colorSpace()));
@@ -304,6 +510,7 @@ void KisPixelSelection::symmetricdifferenceSelection(KisPixelSelectionSP selecti
        m_d->outlineCache = (m_d->outlineCache | selection->outlineCache()) - (m_d->outlineCache & selection->outlineCache());
     }
 
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -324,6 +531,7 @@ void KisPixelSelection::clear(const QRect & r)
         m_d->outlineCache -= path;
     }
 
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -336,6 +544,7 @@ void KisPixelSelection::clear()
     m_d->outlineCache = QPainterPath();
 
     // Empty the thumbnail image. It is a valid state.
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
     m_d->thumbnailImageValid = true;
 }
@@ -346,10 +555,21 @@ void KisPixelSelection::invert()
     // unselected but existing pixels need to be inverted too
     QRect rc = region().boundingRect();
 
-    if (!rc.isEmpty()) {
-        KisSequentialIterator it(this, rc);
-        while(it.nextPixel()) {
-            *(it.rawData()) = MAX_SELECTED - *(it.rawData());
+    Q_FOREACH (const QRect &patch, KritaUtils::splitRectIntoPatches(rc, selectionPatchSize)) {
+        switch (patchType(patch)) {
+        case UnselectedPatch:
+            fill(patch.x(), patch.y(), patch.width(), patch.height(), &MAX_SELECTED);
+            break;
+        case SelectedPatch:
+            fill(patch.x(), patch.y(), patch.width(), patch.height(), &MIN_SELECTED);
+            break;
+        case MixedPatch: {
+            KisSequentialIterator it(this, patch);
+            while(it.nextPixel()) {
+                *(it.rawData()) = MAX_SELECTED - *(it.rawData());
+            }
+            break;
+        }
         }
     }
     quint8 defPixel = MAX_SELECTED - *defaultPixel().data();
@@ -362,6 +582,7 @@ void KisPixelSelection::invert()
         m_d->outlineCache = path - m_d->outlineCache;
     }
 
+    m_d->simplifiedOutlineCache.clear();
     m_d->invalidateThumbnailImage();
 }
 
@@ -375,6 +596,10 @@ void KisPixelSelection::moveTo(const QPoint &pt)
 
     if (m_d->outlineCacheValid) {
         m_d->outlineCache.translate(offset);
+
+        for (QPainterPath &path : m_d->simplifiedOutlineCache) {
+            path.translate(offset);
+        }
     }
 
     if (m_d->thumbnailImageValid) {
@@ -396,6 +621,66 @@ bool KisPixelSelection::isTotallyUnselected(const QRect & r) const
     return ! r.intersects(sr);
 }
 
+KisPixelSelection::PatchType KisPixelSelection::patchType(const QRect &rect) const
+{
+    KisRandomConstAccessorSP it = createRandomConstAccessorNG();
+
+    PatchType result = MixedPatch;
+    bool isFirstChunk = true;
+
+    for (qint32 y = rect.top(); y <= rect.bottom();) {
+        const qint32 rows = qMin(it->numContiguousRows(y), rect.bottom() - y + 1);
+
+        for (qint32 x = rect.left(); x <= rect.right();) {
+            const qint32 columns = qMin(it->numContiguousColumns(x), rect.right() - x + 1);
+
+            const qint32 rowStride = it->rowStride(x, y);
+            it->moveTo(x, y);
+
+            const PatchType chunkType = patchType(it->rawDataConst(), rowStride, rows, columns);
+
+            if (chunkType == MixedPatch || (!isFirstChunk && chunkType != result)) {
+                return MixedPatch;
+            }
+
+            result = chunkType;
+            isFirstChunk = false;
+
+            x += columns;
+        }
+
+        y += rows;
+    }
+
+    return result;
+}
+
+KisPixelSelection::PatchType KisPixelSelection::patchType(const quint8 *rowStart, qint32 rowStride, qint32 rows, qint32 columns)
+{
+    const quint8 value = *rowStart;
+
+    if (value != MIN_SELECTED && value != MAX_SELECTED) {
+        return MixedPatch;
+    }
+
+    for (qint32 row = 0; row < rows; row++) {
+        // no early exit inside the row, so the loop could be vectorized
+        quint8 difference = 0;
+
+        for (qint32 column = 0; column < columns; column++) {
+            difference |= rowStart[column] ^ value;
+        }
+
+        if (difference) {
+            return MixedPatch;
+        }
+
+        rowStart += rowStride;
+    }
+
+    return value == MIN_SELECTED ? UnselectedPatch : SelectedPatch;
+}
+
 QRect KisPixelSelection::selectedRect() const
 {
     return extent();
@@ -408,17 +693,7 @@ QRect KisPixelSelection::selectedExactRect() const
 
 QVector<QPolygon> KisPixelSelection::outline() const
 {
-    QRect selectionExtent = selectedExactRect();
-
-    /**
-     * When the default pixel is not fully transparent, the
-     * exactBounds() return extent of the device instead. To make this
-     * value sane we should limit the calculated area by the bounds of
-     * the image.
-     */
-    if (*defaultPixel().data() != MIN_SELECTED) {
-        selectionExtent &= defaultBounds()->bounds();
-    }
+    const QRect selectionExtent = outlineRect(this);
 
     qint32 xOffset = selectionExtent.x();
     qint32 yOffset = selectionExtent.y();
@@ -460,6 +735,7 @@ void KisPixelSelection::setOutlineCache(const QPainterPath &cache)
     QMutexLocker locker(&m_d->outlineCacheMutex);
     m_d->outlineCache = cache;
     m_d->outlineCacheValid = true;
+    m_d->simplifiedOutlineCache.clear();
     m_d->thumbnailImageValid = false;
 }
 
@@ -473,6 +749,7 @@ void KisPixelSelection::invalidateOutlineCache()
 {
     QMutexLocker locker(&m_d->outlineCacheMutex);
     m_d->outlineCacheValid = false;
+    m_d->simplifiedOutlineCache.clear();
     m_d->thumbnailImageValid = false;
 }
 
@@ -480,26 +757,52 @@ void KisPixelSelection::recalculateOutlineCache()
 {
     QMutexLocker locker(&m_d->outlineCacheMutex);
 
+    /**
+     * The tile cache traces only the tiles changed since the previous
+     * recalculation, which makes the small changes of large selections
+     * cheap
+     */
+    if (!m_d->outlineTileCache) {
+        m_d->outlineTileCache.reset(new KisOutlineTileCache());
+    }
+
+    const QVector<QPolygon> polygons =
+        m_d->outlineTileCache->outline(KisPaintDeviceSP(this), outlineRect(this));
+
     m_d->outlineCache = QPainterPath();
+    int numPoints = 0;
 
-    Q_FOREACH (const QPolygon &polygon, outline()) {
+    Q_FOREACH (const QPolygon &polygon, polygons) {
         m_d->outlineCache.addPolygon(polygon);
 
         /**
-         * The outline generation algorithm has a small bug, which
-         * results in the starting point be repeated twice in the
-         * beginning of the path, instead of being put to the
-         * end. Here we just explicitly close the path to workaround
-         * it.
+         * The generated polygons don't repeat their first point in
+         * the end, so the path should be closed explicitly
          *
          * \see KisSelectionTest::testOutlineGeneration()
          */
         m_d->outlineCache.closeSubpath();
+
+        numPoints += polygon.size();
+    }
+
+    m_d->simplifiedOutlineCache.clear();
+
+    if (numPoints > minSimplifiedOutlinePoints) {
+        for (int lod = 1; lod <= maxSimplifiedOutlineLevelOfDetail; lod++) {
+            m_d->simplifiedOutlineCache.append(simplifiedOutline(polygons, lod));
+        }
     }
 
     m_d->outlineCacheValid = true;
 }
 
+QVector<QPainterPath> KisPixelSelection::simplifiedOutlineCache() const
+{
+    QMutexLocker locker(&m_d->outlineCacheMutex);
+    return m_d->simplifiedOutlineCache;
+}
+
 bool KisPixelSelection::thumbnailImageValid() const
 {
     return m_d->thumbnailImageValid;
@@ -86,6 +86,28 @@ public:
     /// Tests if the rect is totally outside the selection
     bool isTotallyUnselected(const QRect & r) const;
 
+    /**
+     * The kind of the pixels in an area of the selection
+     */
+    enum PatchType {
+        UnselectedPatch, ///< all the pixels are MIN_SELECTED
+        SelectedPatch,   ///< all the pixels are MAX_SELECTED
+        MixedPatch       ///< anything else
+    };
+
+    /**
+     * Classifies the pixels of the selection in \p rect. The check stops
+     * on the first row having a pixel that differs from the others, so
+     * mixed areas are usually recognized after reading a few pixels only.
+     */
+    PatchType patchType(const QRect &rect) const;
+
+    /**
+     * Classifies \p rows rows of \p columns mask pixels starting at
+     * \p rowStart
+     */
+    static PatchType patchType(const quint8 *rowStart, qint32 rowStride, qint32 rows, qint32 columns);
+
     /**
      * Rough, but fastish way of determining the area
      * of the tiles used by the selection.
@@ -118,6 +140,17 @@ public:
     void setOutlineCache(const QPainterPath &cache);
     void invalidateOutlineCache();
 
+    /**
+     * The simplified versions of the outline cache for the views zoomed
+     * out to 1/2, 1/4 and 1/8. The outlines are generated together with
+     * the outline cache, but only for the outlines complex enough. The
+     * list is empty when there are no simplified outlines available.
+     *
+     * @return the list of simplified outlines, where the item at index i
+     *         corresponds to the level of detail (i + 1)
+     */
+    QVector<QPainterPath> simplifiedOutlineCache() const;
+
     bool thumbnailImageValid() const;
     QImage thumbnailImage() const;
     QTransform thumbnailImageTransform() const;
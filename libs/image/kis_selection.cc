@@ -368,6 +368,17 @@ QPainterPath KisSelection::outlineCache() const
     return outline;
 }
 
+QVector<QPainterPath> KisSelection::simplifiedOutlineCache() const
+{
+    QReadLocker l(&m_d->shapeSelectionPointerLock);
+
+    if (m_d->shapeSelection || !m_d->pixelSelection->outlineCacheValid()) {
+        return QVector<QPainterPath>();
+    }
+
+    return m_d->pixelSelection->simplifiedOutlineCache();
+}
+
 void KisSelection::recalculateOutlineCache()
 {
     QReadLocker l(&m_d->shapeSelectionPointerLock);
@@ -89,6 +89,15 @@ public:
     QPainterPath outlineCache() const;
     void recalculateOutlineCache();
 
+    /**
+     * @return the simplified outlines for the zoomed out views, where the
+     * item at index i corresponds to the level of detail (i + 1). The list
+     * is empty if the outline should be drawn as is.
+     *
+     * \see KisPixelSelection::simplifiedOutlineCache()
+     */
+    QVector<QPainterPath> simplifiedOutlineCache() const;
+
 
     /**
      * Tells whether the cached thumbnail of the selection is still valid
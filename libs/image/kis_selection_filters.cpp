@@ -8,14 +8,23 @@
 #include "kis_selection_filters.h"
 
 #include <algorithm>
+#include <atomic>
+#include <limits>
+#include <vector>
+
+#include <QtMath>
 
 #include <klocalizedstring.h>
 
 #include <KoColorSpace.h>
+#include <KoColorSpaceRegistry.h>
 #include "kis_convolution_painter.h"
 #include "kis_convolution_kernel.h"
+#include "kis_gaussian_kernel.h"
 #include "kis_pixel_selection.h"
 #include <kis_sequential_iterator.h>
+#include "kis_algebra_2d.h"
+#include "krita_utils.h"
 
 #define MAX(a, b) ((a) > (b) ? (a) : (b))
 #define MIN(a, b) ((a) < (b) ? (a) : (b))
@@ -99,6 +108,7 @@ void KisSelectionFilter::computeTransition(quint8* transition, quint8** buf, qin
         } else
             transition[x] = 0;
     }
+    x = width - 1;
     if (buf[1][x] >= 128) {
         if (buf[0][x - 1] < 128 || buf[0][x] < 128 ||
             buf[1][x - 1] < 128 ||
@@ -243,6 +253,283 @@ void KisDilateSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 }
 
 
+namespace {
+
+/**
+ * Dilates a binary mask by a symmetric structuring element made of the
+ * vertical spans |dy| <= h(|dx|), where h(|dx|) doesn't grow with |dx|.
+ * The elliptic kernels of the grow, shrink and border filters are all
+ * of this kind.
+ *
+ * The dilation is calculated as a distance transform, see
+ *
+ * P. F. Felzenszwalb, D. P. Huttenlocher, "Distance Transforms of
+ * Sampled Functions", Theory of Computing 8 (2012) 415-428
+ *
+ * The first pass finds the horizontal offset to the closest pixel of
+ * the mask in every row, the second one calculates the lower envelope
+ * of the parabolas dy^2 + cost(dx) in every column. Both passes have
+ * constant cost per pixel, whatever the radius is, and process the rows
+ * and the columns of the rect concurrently. The offsets are passed
+ * between the passes in a tile-managed alpha16 device, so only the
+ * bands and the strips being processed are kept in plain memory.
+ */
+class BinaryDistanceTransform
+{
+public:
+    static constexpr quint32 Infinity = std::numeric_limits<quint32>::max();
+
+    /**
+     * \p columnCost is the cost of the horizontal offset to a pixel
+     * of the mask, it should be non-decreasing. The pixels with larger
+     * offsets don't take part in the transform. If \p outsideIsMask is
+     * true, all the pixels outside the processed rect belong to the mask.
+     */
+    BinaryDistanceTransform(const QVector<quint32> &columnCost, bool outsideIsMask)
+        : m_columnCost(columnCost),
+          m_outsideIsMask(outsideIsMask)
+    {
+    }
+
+    static bool canProcess(int maxOffset) {
+        return maxOffset < std::numeric_limits<quint16>::max();
+    }
+
+    /**
+     * \p maskFunc(quint8 **rows, quint8 *mask, int width) fills the mask
+     * for the middle one of the three rows and returns false if the row
+     * cannot be converted into a binary mask. \p resultFunc(quint32 distance)
+     * returns the value written into \p pixelSelection for the distance
+     * to the closest pixel of the mask.
+     *
+     * @return false if \p maskFunc rejected the pixels, \p pixelSelection
+     *         is not changed then
+     */
+    template <typename MaskFunc, typename ResultFunc>
+    bool process(KisPixelSelectionSP pixelSelection, const QRect &rect,
+                 MaskFunc maskFunc, ResultFunc resultFunc) const
+    {
+        const int width = rect.width();
+        const int height = rect.height();
+        const int maxOffset = m_columnCost.size() - 1;
+        const quint16 farOffset = maxOffset + 1;
+
+        KisPaintDeviceSP offsets = new KisPaintDevice(KoColorSpaceRegistry::instance()->alpha16());
+        std::atomic<bool> isCancelled(false);
+
+        /**
+         * The bands and the strips are aligned to the tiles, so that
+         * the concurrent jobs don't write into the same tiles
+         */
+        const QVector<QPair<int, int>> bands = tileAlignedIntervals(rect.top(), rect.bottom());
+
+        KritaUtils::processConcurrently(bands.size(),
+            [&] (int band) {
+                const int y0 = bands[band].first;
+                const int numRows = bands[band].second - y0;
+
+                // the band with one row of margin on both sides, repeated at the edges
+                std::vector<quint8> buffer(size_t(width) * (numRows + 2));
+                const int readStart = qMax(0, y0 - 1);
+                const int readEnd = qMin(height, y0 + numRows + 1);
+                quint8 *firstRow = buffer.data() + size_t(readStart - y0 + 1) * width;
+
+                pixelSelection->readBytes(firstRow, rect.x(), rect.y() + readStart,
+                                          width, readEnd - readStart);
+
+                if (readStart == y0) {
+                    memcpy(buffer.data(), firstRow, width);
+                }
+                if (readEnd == y0 + numRows) {
+                    memcpy(buffer.data() + size_t(numRows + 1) * width,
+                           buffer.data() + size_t(numRows) * width, width);
+                }
+
+                std::vector<quint8> mask(width);
+                std::vector<quint16> bandOffsets(size_t(width) * numRows);
+
+                for (int i = 0; i < numRows; i++) {
+                    if (isCancelled) return;
+
+                    quint8 *rows[3] = {
+                        buffer.data() + size_t(i) * width,
+                        buffer.data() + size_t(i + 1) * width,
+                        buffer.data() + size_t(i + 2) * width
+                    };
+
+                    if (!maskFunc(rows, mask.data(), width)) {
+                        isCancelled = true;
+                        return;
+                    }
+
+                    quint16 *rowOffsets = bandOffsets.data() + size_t(i) * width;
+
+                    int last = m_outsideIsMask ? -1 : -farOffset - 1;
+                    for (int x = 0; x < width; x++) {
+                        if (mask[x]) last = x;
+                        rowOffsets[x] = qMin(x - last, int(farOffset));
+                    }
+
+                    last = m_outsideIsMask ? width : width + farOffset + 1;
+                    for (int x = width - 1; x >= 0; x--) {
+                        if (mask[x]) last = x;
+                        rowOffsets[x] = qMin(int(rowOffsets[x]), qMin(last - x, int(farOffset)));
+                    }
+                }
+
+                offsets->writeBytes(reinterpret_cast<const quint8*>(bandOffsets.data()),
+                                    rect.x(), rect.y() + y0, width, numRows);
+            });
+
+        if (isCancelled) return false;
+
+        const QVector<QPair<int, int>> strips = tileAlignedIntervals(rect.left(), rect.right());
+
+        KritaUtils::processConcurrently(strips.size(),
+            [&] (int index) {
+                const int x0 = strips[index].first;
+                const int numColumns = strips[index].second - x0;
+
+                std::vector<quint16> stripOffsets(size_t(numColumns) * height);
+                offsets->readBytes(reinterpret_cast<quint8*>(stripOffsets.data()),
+                                   rect.x() + x0, rect.y(), numColumns, height);
+
+                std::vector<quint8> result(size_t(numColumns) * height);
+
+                std::vector<int> sites(height + 2);
+                std::vector<qint64> siteCost(height + 2);
+                std::vector<double> siteStart(height + 2);
+
+                for (int column = 0; column < numColumns; column++) {
+                    int numSites = 0;
+
+                    auto addSite = [&] (int y, qint64 cost) {
+                        double start = -std::numeric_limits<double>::infinity();
+
+                        while (numSites > 0) {
+                            const int lastY = sites[numSites - 1];
+                            const qint64 lastCost = siteCost[numSites - 1];
+
+                            start = double((cost + qint64(y) * y) - (lastCost + qint64(lastY) * lastY)) /
+                                (2.0 * (y - lastY));
+
+                            if (start > siteStart[numSites - 1]) break;
+                            numSites--;
+                        }
+
+                        if (!numSites) {
+                            start = -std::numeric_limits<double>::infinity();
+                        }
+
+                        sites[numSites] = y;
+                        siteCost[numSites] = cost;
+                        siteStart[numSites] = start;
+                        numSites++;
+                    };
+
+                    if (m_outsideIsMask) {
+                        addSite(-1, m_columnCost[0]);
+                    }
+
+                    const quint16 *columnOffsets = stripOffsets.data() + column;
+                    for (int y = 0; y < height; y++) {
+                        const quint16 offset = columnOffsets[size_t(y) * numColumns];
+                        if (offset <= maxOffset && m_columnCost[offset] != Infinity) {
+                            addSite(y, m_columnCost[offset]);
+                        }
+                    }
+
+                    if (m_outsideIsMask) {
+                        addSite(height, m_columnCost[0]);
+                    }
+
+                    quint8 *dst = result.data() + column;
+
+                    if (!numSites) {
+                        const quint8 value = resultFunc(Infinity);
+                        for (int y = 0; y < height; y++) {
+                            dst[size_t(y) * numColumns] = value;
+                        }
+                        continue;
+                    }
+
+                    int site = 0;
+                    for (int y = 0; y < height; y++) {
+                        while (site < numSites - 1 && siteStart[site + 1] < y) {
+                            site++;
+                        }
+
+                        const qint64 dy = y - sites[site];
+                        const qint64 distance = dy * dy + siteCost[site];
+
+                        dst[size_t(y) * numColumns] =
+                            resultFunc(quint32(qMin(distance, qint64(Infinity))));
+                    }
+                }
+
+                pixelSelection->writeBytes(result.data(), rect.x() + x0, rect.y(),
+                                           numColumns, height);
+            });
+
+        return true;
+    }
+
+private:
+    /**
+     * Splits the range [start, end] into the intervals aligned to the
+     * tiles, the intervals are relative to \p start
+     */
+    static QVector<QPair<int, int>> tileAlignedIntervals(int start, int end) {
+        const int tileSize = 64;
+
+        QVector<QPair<int, int>> result;
+        for (int i = start; i <= end;) {
+            const int next = qMin(end + 1, (KisAlgebra2D::divideFloor(i, tileSize) + 1) * tileSize);
+            result.append(qMakePair(i - start, next - start));
+            i = next;
+        }
+        return result;
+    }
+
+private:
+    QVector<quint32> m_columnCost;
+    bool m_outsideIsMask;
+};
+
+/**
+ * Converts the half-heights of the columns of the structuring element
+ * into the costs of BinaryDistanceTransform. The pixel (dx, dy) belongs
+ * to the element when dy^2 + cost(dx) <= yRadius^2.
+ */
+QVector<quint32> columnCostFromHalfHeights(const QVector<qint32> &halfHeights, qint32 yRadius)
+{
+    const quint32 threshold = quint32(yRadius) * yRadius;
+
+    QVector<quint32> result(halfHeights.size());
+    for (int i = 0; i < halfHeights.size(); i++) {
+        const qint32 h = qMin(halfHeights[i], yRadius);
+        result[i] = h >= 0 ? threshold - quint32(h) * h : BinaryDistanceTransform::Infinity;
+    }
+    return result;
+}
+
+/**
+ * Fills \p mask with the pixels of \p src equal to \p value. Returns
+ * false if the row has semi-transparent pixels, they cannot be handled
+ * by BinaryDistanceTransform.
+ */
+inline bool binaryMaskFromRow(const quint8 *src, quint8 *mask, int width, quint8 value)
+{
+    for (int x = 0; x < width; x++) {
+        if (src[x] != MIN_SELECTED && src[x] != MAX_SELECTED) return false;
+        mask[x] = src[x] == value;
+    }
+    return true;
+}
+
+}
+
+
 KisBorderSelectionFilter::KisBorderSelectionFilter(qint32 xRadius, qint32 yRadius, bool antialiasing)
   : m_xRadius(xRadius),
     m_yRadius(yRadius),
@@ -305,6 +592,59 @@ void KisBorderSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
         return;
     }
 
+    if (BinaryDistanceTransform::canProcess(m_xRadius)) {
+        auto transitionMask = [this] (quint8 **rows, quint8 *mask, int width) {
+            computeTransition(mask, rows, width);
+            return true;
+        };
+
+        if (m_antialiasing) {
+            KIS_SAFE_ASSERT_RECOVER_NOOP(m_xRadius == m_yRadius && "anisotropic fading is not implemented");
+            const qreal maxRadius = 0.5 * (m_xRadius + m_yRadius);
+            const qreal minRadius = maxRadius - 1.0;
+
+            QVector<quint32> columnCost(m_xRadius + 1);
+            for (qint32 x = 0; x <= m_xRadius; x++) {
+                columnCost[x] = quint32(x) * x;
+            }
+
+            BinaryDistanceTransform transform(columnCost, false);
+            transform.process(pixelSelection, rect, transitionMask,
+                [maxRadius, minRadius] (quint32 distance) -> quint8 {
+                    if (distance == BinaryDistanceTransform::Infinity) return MIN_SELECTED;
+
+                    const qreal dist = std::sqrt(qreal(distance));
+
+                    return dist > maxRadius ? MIN_SELECTED :
+                        dist > minRadius ? qRound((1.0 - dist + minRadius) * 255.0) :
+                        MAX_SELECTED;
+                });
+        } else {
+            // the same elliptic kernel as the one of density[][] below
+            QVector<qint32> halfHeights(m_xRadius + 1);
+            qint32 h = m_yRadius;
+
+            for (qint32 x = 0; x <= m_xRadius; x++) {
+                const double tmpx = x > 0.0 ? x - 0.5 : 0.0;
+
+                for (; h >= 0; h--) {
+                    const double tmpy = h > 0.0 ? h - 0.5 : 0.0;
+                    if (pow2(tmpy) / pow2(m_yRadius) + pow2(tmpx) / pow2(m_xRadius) <= 1.0) break;
+                }
+                halfHeights[x] = h;
+            }
+
+            const quint32 threshold = quint32(m_yRadius) * m_yRadius;
+
+            BinaryDistanceTransform transform(columnCostFromHalfHeights(halfHeights, m_yRadius), false);
+            transform.process(pixelSelection, rect, transitionMask,
+                [threshold] (quint32 distance) -> quint8 {
+                    return distance <= threshold ? MAX_SELECTED : MIN_SELECTED;
+                });
+        }
+        return;
+    }
+
     qint32* max = new qint32[rect.width() + 2 * m_xRadius];
     for (qint32 i = 0; i < (rect.width() + 2 * m_xRadius); i++)
         max[i] = m_yRadius + 2;
@@ -499,16 +839,43 @@ KUndo2MagicString KisFeatherSelectionFilter::name()
     return kundo2_i18n("Feather Selection");
 }
 
+namespace {
+/**
+ * The feathering kernel is a Gaussian with sigma equal to the radius,
+ * truncated at one sigma. Its standard deviation is about 0.54 of
+ * the radius, so for huge radii we can replace it with the recursive
+ * Gaussian of the same deviation, which has constant cost per pixel.
+ */
+qreal featherRecursiveSigma(qint32 radius)
+{
+    const qreal sigma = 0.5396 * radius;
+    return sigma >= KisGaussianKernel::recursiveGaussianMinSigma() ? sigma : 0.0;
+}
+}
+
 QRect KisFeatherSelectionFilter::changeRect(const QRect& rect, KisDefaultBoundsBaseSP defaultBounds)
 {
     Q_UNUSED(defaultBounds);
 
-    return rect.adjusted(-m_radius, -m_radius,
-                         m_radius, m_radius);
+    // the recursive filter has longer tails than the truncated kernel
+    const qint32 margin = qMax(m_radius, qCeil(3.0 * featherRecursiveSigma(m_radius)));
+
+    return rect.adjusted(-margin, -margin,
+                         margin, margin);
 }
 
 void KisFeatherSelectionFilter::process(KisPixelSelectionSP pixelSelection, const QRect& rect)
 {
+    const qreal recursiveSigma = featherRecursiveSigma(m_radius);
+
+    if (recursiveSigma > 0.0) {
+        KisGaussianKernel::applyRecursiveGaussian(pixelSelection, rect,
+                                                  recursiveSigma, recursiveSigma,
+                                                  pixelSelection->colorSpace()->channelFlags(false, true),
+                                                  0, BORDER_REPEAT);
+        return;
+    }
+
     // compute horizontal kernel
     const uint kernelSize = m_radius * 2 + 1;
     Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> gaussianMatrix(1, kernelSize);
@@ -561,6 +928,24 @@ void KisGrowSelectionFilter::process(KisPixelSelectionSP pixelSelection, const Q
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (BinaryDistanceTransform::canProcess(m_xRadius)) {
+        QVector<qint32> circ(2 * m_xRadius + 1);
+        computeBorder(circ.data(), m_xRadius, m_yRadius);
+
+        const quint32 threshold = quint32(m_yRadius) * m_yRadius;
+
+        BinaryDistanceTransform transform(columnCostFromHalfHeights(circ.mid(m_xRadius), m_yRadius), false);
+        const bool isBinary = transform.process(pixelSelection, rect,
+            [] (quint8 **rows, quint8 *mask, int width) {
+                return binaryMaskFromRow(rows[1], mask, width, MAX_SELECTED);
+            },
+            [threshold] (quint32 distance) -> quint8 {
+                return distance <= threshold ? MAX_SELECTED : MIN_SELECTED;
+            });
+
+        if (isBinary) return;
+    }
+
     /**
         * Much code resembles Shrink filter, so please fix bugs
         * in both filters
@@ -688,6 +1073,30 @@ void KisShrinkSelectionFilter::process(KisPixelSelectionSP pixelSelection, const
 {
     if (m_xRadius <= 0 || m_yRadius <= 0) return;
 
+    if (BinaryDistanceTransform::canProcess(m_xRadius)) {
+        QVector<qint32> circ(2 * m_xRadius + 1);
+        computeBorder(circ.data(), m_xRadius, m_yRadius);
+
+        const quint32 threshold = quint32(m_yRadius) * m_yRadius;
+
+        /**
+         * Shrinking is growing of the unselected area. With edge lock
+         * the pixels outside the rect repeat the edge ones, so they
+         * never come closer than the edge pixels themselves.
+         */
+        BinaryDistanceTransform transform(columnCostFromHalfHeights(circ.mid(m_xRadius), m_yRadius),
+                                          !m_edgeLock);
+        const bool isBinary = transform.process(pixelSelection, rect,
+            [] (quint8 **rows, quint8 *mask, int width) {
+                return binaryMaskFromRow(rows[1], mask, width, MIN_SELECTED);
+            },
+            [threshold] (quint32 distance) -> quint8 {
+                return distance <= threshold ? MIN_SELECTED : MAX_SELECTED;
+            });
+
+        if (isBinary) return;
+    }
+
     /*
         pretty much the same as fatten_region only different
         blame all bugs in this function on jaycox@gimp.org
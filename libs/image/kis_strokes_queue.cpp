@@ -16,6 +16,7 @@
 #include "kis_undo_stores.h"
 #include "kis_post_execution_undo_adapter.h"
 #include "KisCppQuirks.h"
+#include "KisTraceRecorder.h"
 
 typedef QQueue<KisStrokeSP> StrokesQueue;
 typedef QQueue<KisStrokeSP>::iterator StrokesQueueIterator;
@@ -589,6 +590,8 @@ void KisStrokesQueue::Private::forceResetLodAndCloseCurrentLodRange()
 void KisStrokesQueue::processQueue(KisUpdaterContext &updaterContext,
                                    bool externalJobsPending)
 {
+    KIS_TRACE_SCOPE("strokes", "KisStrokesQueue::processQueue");
+
     updaterContext.lock();
     m_d->mutex.lock();
 
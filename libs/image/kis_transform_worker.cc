@@ -14,6 +14,7 @@
 #include <klocalizedstring.h>
 
 #include <QTransform>
+#include <QMutex>
 
 #include <KoColorSpace.h>
 #include <KoCompositeOpRegistry.h>
@@ -30,6 +31,7 @@
 #include "kis_progress_update_helper.h"
 #include "kis_pixel_selection.h"
 #include "kis_image.h"
+#include "krita_utils.h"
 
 
 KisTransformWorker::KisTransformWorker(KisPaintDeviceSP dev,
@@ -189,6 +191,23 @@ void updateBounds<KisVLineIteratorSP>(QRect &boundRect, const KisFilterWeightsAp
     boundRect.setHeight(newBounds.size());
 }
 
+namespace {
+
+/**
+ * The lines of a pass are processed in bands aligned to the tiles of
+ * the device, so that every thread works on its own column (or row)
+ * of tiles, and the tiles of the band stay in the cache while the
+ * adjacent lines are processed.
+ */
+const int transformBandSize = 64;
+
+/**
+ * Passes with fewer pixels are not worth the threading overhead
+ */
+const qint64 minConcurrentPassArea = 256 * 256;
+
+}
+
 template <class T>
 void KisTransformWorker::transformPass(KisPaintDevice *src, KisPaintDevice *dst,
                                        double floatscale, double shear, double dx,
@@ -201,19 +220,50 @@ void KisTransformWorker::transformPass(KisPaintDevice *src, KisPaintDevice *dst,
     calcDimensions<T>(m_boundRect, srcStart, srcLen, firstLine, numLines);
 
     KisProgressUpdateHelper progressHelper(m_progressUpdater, portion, numLines);
+    QMutex progressLock;
+
     KisFilterWeightsBuffer buf(filterStrategy, qAbs(floatscale));
-    KisFilterWeightsApplicator applicator(src, dst, floatscale, shear, dx, clampToEdge);
+    const qreal filterSupport = filterStrategy->support(buf.weightsPositionScale().toFloat());
+    const KisFilterWeightsApplicator applicator(src, dst, floatscale, shear, dx, clampToEdge);
 
-    KisFilterWeightsApplicator::LinePos dstBounds;
+    QVector<std::pair<int, int>> bands;
+
+    if (qint64(srcLen) * numLines < minConcurrentPassArea) {
+        bands << std::make_pair(firstLine, numLines);
+    } else {
+        int bandStart = firstLine;
+        while (bandStart < firstLine + numLines) {
+            const int alignedEnd = (qFloor(qreal(bandStart) / transformBandSize) + 1) * transformBandSize;
+            const int bandEnd = qMin(alignedEnd, firstLine + numLines);
+            bands << std::make_pair(bandStart, bandEnd - bandStart);
+            bandStart = bandEnd;
+        }
+    }
 
-    for (int i = firstLine; i < firstLine + numLines; i++) {
-        KisFilterWeightsApplicator::LinePos dstPos;
-        KisFilterWeightsApplicator::LinePos srcPos(srcStart, srcLen);
+    QVector<KisFilterWeightsApplicator::LinePos> dstLines(numLines);
+    KisFilterWeightsApplicator::LinePos *dstLinesPtr = dstLines.data();
 
-        dstPos = applicator.processLine<T>(srcPos, i, &buf, filterStrategy->support(buf.weightsPositionScale().toFloat()));
-        dstBounds.unite(dstPos);
+    KritaUtils::processConcurrently(bands.size(), [&] (int index) {
+        KisFilterWeightsApplicator bandApplicator(applicator);
 
-        progressHelper.step();
+        const int bandStart = bands.at(index).first;
+        const int bandEnd = bandStart + bands.at(index).second;
+
+        for (int i = bandStart; i < bandEnd; i++) {
+            KisFilterWeightsApplicator::LinePos srcPos(srcStart, srcLen);
+            dstLinesPtr[i - firstLine] =
+                bandApplicator.processLine<T>(srcPos, i, &buf, filterSupport);
+        }
+
+        QMutexLocker l(&progressLock);
+        for (int i = bandStart; i < bandEnd; i++) {
+            progressHelper.step();
+        }
+    });
+
+    KisFilterWeightsApplicator::LinePos dstBounds;
+    Q_FOREACH (const KisFilterWeightsApplicator::LinePos &dstPos, dstLines) {
+        dstBounds.unite(dstPos);
     }
 
     updateBounds<T>(m_boundRect, dstBounds);
@@ -18,6 +18,7 @@
 #include "kis_async_merger.h"
 #include "kis_updater_context.h"
 #include <KoAlwaysInline.h>
+#include <KisTraceRecorder.h>
 
 //#define DEBUG_JOBS_SEQUENCE
 
@@ -81,6 +82,7 @@ private:
             }
 
             if(m_atomicType == Type::MERGE) {
+                KIS_TRACE_SCOPE("updates", "KisUpdateJobItem::runMergeJob");
                 runMergeJob();
             } else {
                 KIS_ASSERT(m_atomicType == Type::STROKE ||
@@ -97,6 +99,8 @@ private:
                     }
 #endif
 
+                    KIS_TRACE_SCOPE(m_atomicType == Type::STROKE ? "strokes" : "updates",
+                                    m_atomicType == Type::STROKE ? "KisStrokeJob::run" : "KisSpontaneousJob::run");
                     m_runnableJob->run();
                 }
             }
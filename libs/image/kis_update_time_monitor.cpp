@@ -39,6 +39,12 @@ struct StrokeTicket
 
     QRegion dirtyRegion;
 
+    /**
+     * Stroke time of the input event that caused the job,
+     * used for measuring the input-to-update latency
+     */
+    qint64 inputTime = -1;
+
     void start() {
         m_timer.start();
     }
@@ -83,12 +89,15 @@ struct Q_DECL_HIDDEN KisUpdateTimeMonitor::Private
 
     qint64 jobsTime;
     qint64 responseTime;
+    qint64 inputLatency = 0;
+    qint32 numInputLatencySamples = 0;
     qint32 numTickets;
     qint32 numUpdates;
     QMutex mutex;
 
     qreal mousePath;
     QPointF lastMousePos;
+    qint64 lastMouseMoveTime = -1;
     QElapsedTimer strokeTime;
     KisPaintOpPresetSP preset;
 
@@ -125,11 +134,14 @@ void KisUpdateTimeMonitor::startStrokeMeasure()
 
     m_d->jobsTime = 0;
     m_d->responseTime = 0;
+    m_d->inputLatency = 0;
+    m_d->numInputLatencySamples = 0;
     m_d->numTickets = 0;
     m_d->numUpdates = 0;
     m_d->mousePath = 0;
 
     m_d->lastMousePos = QPointF();
+    m_d->lastMouseMoveTime = -1;
     m_d->preset = 0;
     m_d->strokeTime.start();
 }
@@ -164,6 +176,7 @@ void KisUpdateTimeMonitor::reportMouseMove(const QPointF &pos)
     }
 
     m_d->lastMousePos = pos;
+    m_d->lastMouseMoveTime = m_d->strokeTime.elapsed();
 }
 
 void KisUpdateTimeMonitor::printValues()
@@ -173,6 +186,8 @@ void KisUpdateTimeMonitor::printValues()
     qreal nonUpdateTime = qreal(m_d->jobsTime) / m_d->numTickets;
     qreal jobsPerUpdate = qreal(m_d->numTickets) / m_d->numUpdates;
     qreal mouseSpeed = qreal(m_d->mousePath) / strokeTime;
+    qreal inputLatency = m_d->numInputLatencySamples ?
+        qreal(m_d->inputLatency) / m_d->numInputLatencySamples : 0.0;
 
     QString prefix;
 
@@ -192,7 +207,8 @@ void KisUpdateTimeMonitor::printValues()
            << i18n("Mouse Speed:") << QString::number( mouseSpeed, 'f', 3 ) << "\t"
            << i18n("Jobs/Update:") << QString::number( jobsPerUpdate, 'f', 3 ) << "\t"
            << i18n("Non Update Time:") << QString::number( nonUpdateTime, 'f', 3 ) << "\t"
-           << i18n("Response Time:") << responseTime << Qt::endl; // 'endl' will use the correct OS line ending
+           << i18n("Response Time:") << responseTime << "\t"
+           << i18n("Input Latency:") << QString::number( inputLatency, 'f', 3 ) << Qt::endl; // 'endl' will use the correct OS line ending
     logFile.close();
 }
 
@@ -204,6 +220,7 @@ void KisUpdateTimeMonitor::reportJobStarted(void *key)
 
     StrokeTicket *ticket = new StrokeTicket();
     ticket->start();
+    ticket->inputTime = m_d->lastMouseMoveTime;
 
     m_d->preliminaryTickets.insert(key, ticket);
 }
@@ -239,6 +256,11 @@ void KisUpdateTimeMonitor::reportUpdateFinished(const QRect &rect)
             m_d->responseTime += ticket->jobTime() + ticket->updateTime();
             m_d->numTickets++;
 
+            if (ticket->inputTime >= 0) {
+                m_d->inputLatency += m_d->strokeTime.elapsed() - ticket->inputTime;
+                m_d->numInputLatencySamples++;
+            }
+
             m_d->finishedTickets.remove(ticket);
             delete ticket;
         }
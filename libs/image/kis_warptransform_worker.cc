@@ -22,6 +22,7 @@
 #include <math.h>
 
 #include "kis_grid_interpolation_tools.h"
+#include "krita_utils.h"
 
 QPointF KisWarpTransformWorker::affineTransformMath(QPointF v, QVector<QPointF> p, QVector<QPointF> q, qreal alpha)
 {
@@ -242,15 +243,47 @@ void KisWarpTransformWorker::run(KisPaintDeviceSP srcDev, KisPaintDeviceSP dstDe
 
     dstDev->clear();
 
+    if (srcBounds.isEmpty()) return;
+
     const int pixelPrecision = 8;
 
     FunctionTransformOp functionOp(m_warpMathFunction, m_origPoint, m_transfPoint, m_alpha);
-    GridIterationTools::PaintDevicePolygonOp polygonOp(srcDev, dstDev);
-    GridIterationTools::processGrid(polygonOp, functionOp,
-                                    srcBounds, pixelPrecision);
-}
 
-#include "krita_utils.h"
+    const QSize gridSize = GridIterationTools::calcGridSize(srcBounds, pixelPrecision);
+    const QVector<QPointF> originalPoints = GridIterationTools::calcGridPoints(srcBounds, pixelPrecision);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(originalPoints.size() == gridSize.width() * gridSize.height());
+
+    /**
+     * The warp functions are quite expensive, so the grid is transformed
+     * concurrently as well
+     */
+    QVector<QPointF> transformedPoints(originalPoints.size());
+    QPointF *transformedPtr = transformedPoints.data();
+
+    KritaUtils::processConcurrently(gridSize.height(), [&] (int row) {
+        const int rowStart = row * gridSize.width();
+        for (int i = rowStart; i < rowStart + gridSize.width(); i++) {
+            transformedPtr[i] = functionOp(originalPoints[i]);
+        }
+    });
+
+    const int numCellCols = gridSize.width() - 1;
+    const int numCellRows = gridSize.height() - 1;
+
+    auto cellOp = [&] (int cellIndex, QPolygonF *srcPolygon, QPolygonF *dstPolygon, QPolygonF *clipDstPolygon) {
+        const int col = cellIndex % numCellCols;
+        const int row = cellIndex / numCellCols;
+
+        Q_FOREACH (int index, GridIterationTools::calculateCellIndexes(col, row, gridSize)) {
+            *srcPolygon << originalPoints[index];
+            *dstPolygon << transformedPoints.at(index);
+        }
+
+        *clipDstPolygon = *dstPolygon;
+    };
+
+    GridIterationTools::processCellsConcurrently(srcDev, dstDev, numCellCols * numCellRows, cellOp);
+}
 
 QRect KisWarpTransformWorker::approxChangeRect(const QRect &rc)
 {
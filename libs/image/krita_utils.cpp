@@ -14,6 +14,10 @@
 #include <QPolygonF>
 #include <QPen>
 #include <QPainter>
+#include <QThread>
+#include <QtConcurrent>
+
+#include <numeric>
 
 #include "kis_algebra_2d.h"
 
@@ -582,6 +586,23 @@ namespace KritaUtils
         return points;
     }
 
+    void processConcurrently(int numJobs, std::function<void(int)> func)
+    {
+        if (numJobs <= 0) return;
+
+        if (numJobs == 1 || QThread::idealThreadCount() <= 1) {
+            for (int i = 0; i < numJobs; i++) {
+                func(i);
+            }
+            return;
+        }
+
+        QVector<int> jobs(numJobs);
+        std::iota(jobs.begin(), jobs.end(), 0);
+
+        QtConcurrent::blockingMap(jobs, [&func] (int index) { func(index); });
+    }
+
     QVector<QPoint> rasterizeVLine(const QPoint &startPoint, const QPoint &endPoint)
     {
         QVector<QPoint> points;
@@ -269,6 +269,16 @@ namespace KritaUtils
         }
     }
 
+    /**
+     * Calls \p func for every index in range [0, numJobs) using the global
+     * thread pool. The function returns when all the jobs are completed.
+     * The calling thread takes part in the processing, so it is safe to
+     * call it from the threads of the updater context.
+     *
+     * The jobs must not touch the same pixels of the same device.
+     */
+    void KRITAIMAGE_EXPORT processConcurrently(int numJobs, std::function<void(int)> func);
+
     // Convenience functions
     QVector<QPoint> KRITAIMAGE_EXPORT rasterizeHLine(const QPoint &startPoint, const QPoint &endPoint);
     QVector<QPoint> KRITAIMAGE_EXPORT rasterizeVLine(const QPoint &startPoint, const QPoint &endPoint);
@@ -0,0 +1,291 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisFilterResultCacheTest.h"
+
+#include "KisFilterResultCache.h"
+#include <KoColorSpaceRegistry.h>
+#include <KisGlobalResourcesInterface.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter_registry.h"
+#include "kis_image.h"
+#include "kis_paint_layer.h"
+#include "kis_adjustment_layer.h"
+#include "kis_merge_walker.h"
+#include "kis_async_merger.h"
+#include "kistest.h"
+#include <testutil.h>
+#include "testing_timed_default_bounds.h"
+
+namespace {
+
+const QRect imageRect(0, 0, 256, 256);
+
+KisPaintDeviceSP createSource()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    KisSequentialIterator it(dev, imageRect);
+    while (it.nextPixel()) {
+        const QColor color(it.x() % 256, it.y() % 256, (it.x() * it.y()) % 256, 255);
+        cs->fromQColor(color, it.rawData());
+    }
+
+    return dev;
+}
+
+KisFilterConfigurationSP createBlurConfig(int radius)
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config = filter->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    config->setProperty("halfWidth", radius);
+    config->setProperty("halfHeight", radius);
+    return config->cloneWithResourcesSnapshot();
+}
+
+bool compareWithReference(KisFilterSP filter, KisFilterConfigurationSP config,
+                          KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &rect)
+{
+    KisPaintDeviceSP reference = new KisPaintDevice(src->colorSpace());
+    filter->process(src, reference, 0, rect, config);
+
+    QPoint pt;
+    return TestUtil::compareQImages(pt,
+                                    reference->convertToQImage(0, rect),
+                                    dst->convertToQImage(0, rect));
+}
+
+}
+
+void KisFilterResultCacheTest::testCacheHit()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config = createBlurConfig(5);
+    KisPaintDeviceSP src = createSource();
+
+    const QRect rect(64, 64, 128, 128);
+
+    KisFilterResultCache cache;
+
+    KisPaintDeviceSP dst1 = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config, src, dst1, rect, false);
+    QCOMPARE(cache.numMisses(), 1);
+    QCOMPARE(cache.numHits(), 0);
+    QVERIFY(cache.memoryUsage() > 0);
+
+    KisPaintDeviceSP dst2 = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config, src, dst2, rect, false);
+    QCOMPARE(cache.numMisses(), 1);
+    QCOMPARE(cache.numHits(), 1);
+
+    QVERIFY(compareWithReference(filter, config, src, dst2, rect));
+
+    // the rect is not covered by the cache
+    KisPaintDeviceSP dst3 = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config, src, dst3, rect.adjusted(-10, 0, 0, 0), false);
+    QCOMPARE(cache.numMisses(), 2);
+}
+
+void KisFilterResultCacheTest::testSourceChanged()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config = createBlurConfig(5);
+    KisPaintDeviceSP src = createSource();
+
+    const QRect leftRect(0, 0, 128, 256);
+    const QRect rightRect(128, 0, 128, 256);
+
+    KisFilterResultCache cache;
+
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config, src, dst, leftRect, false);
+    cache.process(filter, config, src, dst, rightRect, false);
+    QCOMPARE(cache.numMisses(), 2);
+
+    /**
+     * Change a pixel in the left half, but close enough to the
+     * right half to affect its result. The update of the left half
+     * reports the change, so the cache must drop the results of
+     * the right half as well.
+     */
+    src->setPixel(125, 100, KoColor(Qt::black, src->colorSpace()));
+
+    cache.process(filter, config, src, dst, leftRect, true);
+    QCOMPARE(cache.numMisses(), 3);
+
+    cache.process(filter, config, src, dst, rightRect, false);
+    QCOMPARE(cache.numMisses(), 4);
+    QCOMPARE(cache.numHits(), 0);
+
+    QVERIFY(compareWithReference(filter, config, src, dst, imageRect));
+
+    cache.process(filter, config, src, dst, rightRect, false);
+    QCOMPARE(cache.numHits(), 1);
+
+    // the left half was not cached, since its source was changing
+    cache.process(filter, config, src, dst, leftRect, false);
+    QCOMPARE(cache.numMisses(), 5);
+    QCOMPARE(cache.numHits(), 1);
+}
+
+void KisFilterResultCacheTest::testPointFilterNotCached()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("desaturate");
+    QVERIFY(filter);
+
+    KisFilterConfigurationSP config =
+        filter->defaultConfiguration(KisGlobalResourcesInterface::instance())->cloneWithResourcesSnapshot();
+    KisPaintDeviceSP src = createSource();
+
+    KisFilterResultCache cache;
+
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config, src, dst, imageRect, false);
+    cache.process(filter, config, src, dst, imageRect, false);
+
+    QCOMPARE(cache.numMisses(), 0);
+    QCOMPARE(cache.numHits(), 0);
+    QCOMPARE(cache.memoryUsage(), 0);
+
+    QVERIFY(compareWithReference(filter, config, src, dst, imageRect));
+}
+
+void KisFilterResultCacheTest::testMergeWalkerUpdates()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisImageSP image = new KisImage(0, imageRect.width(), imageRect.height(), cs, "filter cache test");
+
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config = createBlurConfig(5);
+
+    KisPaintLayerSP paintLayer = new KisPaintLayer(image, "paint", OPACITY_OPAQUE_U8, createSource());
+    KisAdjustmentLayerSP blurLayer = new KisAdjustmentLayer(image, "blur", config, 0);
+
+    image->addNode(paintLayer, image->rootLayer());
+    image->addNode(blurLayer, image->rootLayer());
+
+    KisFilterResultCache *cache = blurLayer->filterResultCache();
+
+    KisMergeWalker walker(image->bounds());
+    KisAsyncMerger merger;
+
+    // the source of the filter changes, nothing is cached
+    walker.collectRects(paintLayer, imageRect);
+    merger.startMerge(walker);
+    QCOMPARE(cache->numMisses(), 1);
+    QCOMPARE(cache->memoryUsage(), 0);
+
+    // the layer itself is dirty, its source is the same
+    walker.collectRects(blurLayer, imageRect);
+    merger.startMerge(walker);
+    QCOMPARE(cache->numMisses(), 2);
+    QVERIFY(cache->memoryUsage() > 0);
+
+    walker.collectRects(blurLayer, QRect(32, 32, 64, 64));
+    merger.startMerge(walker);
+    QCOMPARE(cache->numHits(), 1);
+
+    paintLayer->paintDevice()->setPixel(100, 100, KoColor(Qt::black, cs));
+    walker.collectRects(paintLayer, QRect(100, 100, 1, 1));
+    merger.startMerge(walker);
+    QCOMPARE(cache->numMisses(), 3);
+
+    walker.collectRects(blurLayer, imageRect);
+    merger.startMerge(walker);
+    QCOMPARE(cache->numMisses(), 4);
+    QCOMPARE(cache->numHits(), 1);
+
+    QVERIFY(compareWithReference(filter, config, paintLayer->paintDevice(),
+                                 blurLayer->original(), imageRect));
+
+    // the layers below a hidden layer change unnoticed
+    blurLayer->setVisible(false);
+    QCOMPARE(cache->memoryUsage(), 0);
+}
+
+void KisFilterResultCacheTest::testConfigChanged()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config1 = createBlurConfig(5);
+    KisFilterConfigurationSP config2 = createBlurConfig(10);
+    KisPaintDeviceSP src = createSource();
+
+    KisFilterResultCache cache;
+
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config1, src, dst, imageRect, false);
+    cache.process(filter, config2, src, dst, imageRect, false);
+    QCOMPARE(cache.numMisses(), 2);
+
+    QVERIFY(compareWithReference(filter, config2, src, dst, imageRect));
+
+    cache.invalidate();
+    QCOMPARE(cache.memoryUsage(), 0);
+
+    cache.process(filter, config2, src, dst, imageRect, false);
+    QCOMPARE(cache.numMisses(), 3);
+}
+
+void KisFilterResultCacheTest::testBoundsChanged()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config = createBlurConfig(5);
+    KisPaintDeviceSP src = createSource();
+
+    const QRect rect(64, 64, 128, 128);
+
+    KisFilterResultCache cache;
+
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+    cache.process(filter, config, src, dst, rect, false);
+    QCOMPARE(cache.numMisses(), 1);
+
+    // the image has been cropped, but the pixels are the same
+    src->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(QRect(32, 32, 192, 192)));
+
+    cache.process(filter, config, src, dst, rect, false);
+    QCOMPARE(cache.numMisses(), 2);
+    QCOMPARE(cache.numHits(), 0);
+
+    cache.process(filter, config, src, dst, rect, false);
+    QCOMPARE(cache.numHits(), 1);
+}
+
+void KisFilterResultCacheTest::testSharedMemoryUsage()
+{
+    KisFilterSP filter = KisFilterRegistry::instance()->value("blur");
+    KisFilterConfigurationSP config = createBlurConfig(5);
+    KisPaintDeviceSP src = createSource();
+
+    const qint64 initialUsage = KisFilterResultCache::totalMemoryUsage();
+
+    QScopedPointer<KisFilterResultCache> cache1(new KisFilterResultCache());
+    KisFilterResultCache cache2;
+
+    KisPaintDeviceSP dst = new KisPaintDevice(src->colorSpace());
+    cache1->process(filter, config, src, dst, imageRect, false);
+    cache2.process(filter, config, src, dst, QRect(0, 0, 64, 64), false);
+
+    QVERIFY(cache1->memoryUsage() > 0);
+    QVERIFY(cache2.memoryUsage() > 0);
+    QCOMPARE(KisFilterResultCache::totalMemoryUsage(),
+             initialUsage + cache1->memoryUsage() + cache2.memoryUsage());
+
+    cache2.invalidate();
+    QCOMPARE(KisFilterResultCache::totalMemoryUsage(),
+             initialUsage + cache1->memoryUsage());
+
+    cache1.reset();
+    QCOMPARE(KisFilterResultCache::totalMemoryUsage(), initialUsage);
+}
+
+KISTEST_MAIN(KisFilterResultCacheTest)
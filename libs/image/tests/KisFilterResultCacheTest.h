@@ -0,0 +1,27 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISFILTERRESULTCACHETEST_H
+#define KISFILTERRESULTCACHETEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisFilterResultCacheTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testCacheHit();
+    void testSourceChanged();
+    void testPointFilterNotCached();
+    void testMergeWalkerUpdates();
+    void testConfigChanged();
+    void testBoundsChanged();
+    void testSharedMemoryUsage();
+};
+
+#endif // KISFILTERRESULTCACHETEST_H
@@ -0,0 +1,117 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisSlidingWindowHistogramTest.h"
+
+#include "KisSlidingWindowHistogram.h"
+#include <KoColorSpaceRegistry.h>
+#include <kis_paint_device.h>
+#include <kis_sequential_iterator.h>
+#include <kis_random_accessor_ng.h>
+#include "kistest.h"
+
+#include <algorithm>
+
+
+void KisSlidingWindowHistogramTest::testRankBin()
+{
+    KisSlidingWindowHistogram histogram(10, 1);
+
+    const float payload = 1.0;
+
+    histogram.add(2, &payload);
+    histogram.add(2, &payload);
+    histogram.add(5, &payload);
+    histogram.add(7, &payload);
+
+    QCOMPARE(histogram.totalCount(), 4);
+    QCOMPARE(histogram.rankBin(0), 2);
+    QCOMPARE(histogram.rankBin(1), 2);
+    QCOMPARE(histogram.rankBin(2), 5);
+    QCOMPARE(histogram.rankBin(3), 7);
+    QCOMPARE(histogram.rankBin(4), -1);
+    QCOMPARE(histogram.medianBin(), 5);
+    QCOMPARE(histogram.mostFrequentBin(), 2);
+    QCOMPARE(*histogram.payload(2), 2.0);
+
+    KisSlidingWindowHistogram other(10, 1);
+    other.add(5, &payload);
+    other.add(5, &payload);
+    other.add(5, &payload);
+
+    histogram.add(other);
+    QCOMPARE(histogram.mostFrequentBin(), 5);
+    QCOMPARE(histogram.totalCount(), 7);
+
+    histogram.subtract(other);
+    QCOMPARE(histogram.mostFrequentBin(), 2);
+    QCOMPARE(histogram.totalCount(), 4);
+}
+
+void KisSlidingWindowHistogramTest::testMedianFilter_data()
+{
+    QTest::addColumn<int>("radius");
+
+    QTest::newRow("1") << 1;
+    QTest::newRow("3") << 3;
+    QTest::newRow("40") << 40;
+}
+
+void KisSlidingWindowHistogramTest::testMedianFilter()
+{
+    QFETCH(int, radius);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->alpha8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    const QRect rc(10, 20, 150, 170);
+
+    srand(12345);
+
+    {
+        // leave some default pixels inside the processed area as well
+        KisSequentialIterator it(dev, rc.adjusted(5, 5, -7, -3));
+        while (it.nextPixel()) {
+            *it.rawData() = rand() % 256;
+        }
+    }
+
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    KritaUtils::processSlidingWindowHistogram(dev, dst, rc, radius, 256, 0,
+        [] (const quint8 *pixel, float *) {
+            return int(*pixel);
+        },
+        [] (const KisSlidingWindowHistogram &histogram, const quint8 *, quint8 *dstPixel) {
+            *dstPixel = histogram.medianBin();
+        });
+
+    KisRandomConstAccessorSP srcIt = dev->createRandomConstAccessorNG();
+    KisRandomConstAccessorSP dstIt = dst->createRandomConstAccessorNG();
+
+    const int windowSize = 2 * radius + 1;
+    std::vector<quint8> window(windowSize * windowSize);
+
+    for (int y = rc.top(); y <= rc.bottom(); y += 7) {
+        for (int x = rc.left(); x <= rc.right(); x += 5) {
+            auto it = window.begin();
+
+            for (int j = -radius; j <= radius; j++) {
+                for (int i = -radius; i <= radius; i++) {
+                    srcIt->moveTo(x + i, y + j);
+                    *it++ = *srcIt->rawDataConst();
+                }
+            }
+
+            std::nth_element(window.begin(), window.begin() + window.size() / 2, window.end());
+
+            dstIt->moveTo(x, y);
+            QCOMPARE(*dstIt->rawDataConst(), window[window.size() / 2]);
+        }
+    }
+}
+
+KISTEST_MAIN(KisSlidingWindowHistogramTest)
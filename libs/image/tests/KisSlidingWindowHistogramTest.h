@@ -0,0 +1,23 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISSLIDINGWINDOWHISTOGRAMTEST_H
+#define KISSLIDINGWINDOWHISTOGRAMTEST_H
+
+#include <QtTest>
+#include <QObject>
+
+class KisSlidingWindowHistogramTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testRankBin();
+    void testMedianFilter_data();
+    void testMedianFilter();
+};
+
+#endif // KISSLIDINGWINDOWHISTOGRAMTEST_H
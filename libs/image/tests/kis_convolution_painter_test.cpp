@@ -581,4 +581,106 @@ void KisConvolutionPainterTest::testNormalMapFFTW()
     testNormalMap(true);
 }
 
+void KisConvolutionPainterTest::testRecursiveGaussian()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 300, 200);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    dev->fill(imageRect, KoColor(Qt::white, cs));
+    dev->fill(QRect(100, 50, 100, 100), KoColor(Qt::blue, cs));
+    dev->fill(QRect(150, 80, 20, 90), KoColor(Qt::red, cs));
+
+    const qreal radius = 60;
+    const QBitArray channelFlags = cs->channelFlags(true, true);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(*dev);
+    KisPaintDeviceSP interm = new KisPaintDevice(cs);
+    interm->prepareClone(reference);
+
+    KisConvolutionKernelSP kernelHoriz = KisGaussianKernel::createHorizontalKernel(radius);
+    KisConvolutionKernelSP kernelVertical = KisGaussianKernel::createVerticalKernel(radius);
+    const int verticalMargin = kernelVertical->height() / 2;
+
+    KisConvolutionPainter horizPainter(interm, KisConvolutionPainter::SPATIAL);
+    horizPainter.setChannelFlags(channelFlags);
+    horizPainter.applyMatrix(kernelHoriz, reference,
+                             imageRect.topLeft() - QPoint(0, verticalMargin),
+                             imageRect.topLeft() - QPoint(0, verticalMargin),
+                             imageRect.size() + QSize(0, 2 * verticalMargin),
+                             BORDER_REPEAT);
+
+    KisConvolutionPainter verticalPainter(reference, KisConvolutionPainter::SPATIAL);
+    verticalPainter.setChannelFlags(channelFlags);
+    verticalPainter.applyMatrix(kernelVertical, interm,
+                                imageRect.topLeft(), imageRect.topLeft(),
+                                imageRect.size(), BORDER_REPEAT);
+
+    const qreal sigma = KisGaussianKernel::sigmaFromRadius(radius);
+    QVERIFY(sigma >= KisGaussianKernel::recursiveGaussianMinSigma());
+
+    KisGaussianKernel::applyRecursiveGaussian(dev, imageRect, sigma, sigma, channelFlags, 0);
+
+    QImage referenceImage = reference->convertToQImage(0, imageRect);
+    QImage resultImage = dev->convertToQImage(0, imageRect);
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt, referenceImage, resultImage, 5, 5)) {
+        referenceImage.save("recursive_gaussian_reference.png");
+        resultImage.save("recursive_gaussian_result.png");
+        QFAIL(QString("Recursive Gaussian differs from the FIR one at %1,%2").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+void KisConvolutionPainterTest::testFFTWMultipleBlocks()
+{
+    if (!KisConvolutionPainter::supportsFFTW()) {
+        QSKIP("FFTW is not available");
+    }
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 1300, 900);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+
+    for (int y = 0; y < imageRect.height(); y += 23) {
+        for (int x = 0; x < imageRect.width(); x += 37) {
+            const QColor color((x * 7) % 256, (y * 5) % 256, ((x + y) * 3) % 256, 128 + (x + y) % 128);
+            dev->fill(QRect(x, y, 37, 23), KoColor(color, cs));
+        }
+    }
+
+    /**
+     * The area is much bigger than the FFT block for this kernel,
+     * so it will be processed in several blocks. Convolve the device
+     * in-place to check that the blocks don't read the results of
+     * their neighbours.
+     */
+    KisConvolutionKernelSP kernel = KisGaussianKernel::createUniform2DKernel(5, 5);
+    const QBitArray channelFlags = cs->channelFlags(true, true);
+
+    KisPaintDeviceSP reference = new KisPaintDevice(cs);
+    reference->prepareClone(dev);
+
+    KisConvolutionPainter spatialPainter(reference, KisConvolutionPainter::SPATIAL);
+    spatialPainter.setChannelFlags(channelFlags);
+    spatialPainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+
+    KisConvolutionPainter fftPainter(dev, KisConvolutionPainter::FFTW);
+    fftPainter.setChannelFlags(channelFlags);
+    fftPainter.applyMatrix(kernel, dev, imageRect.topLeft(), imageRect.topLeft(), imageRect.size(), BORDER_REPEAT);
+
+    QImage referenceImage = reference->convertToQImage(0, imageRect);
+    QImage resultImage = dev->convertToQImage(0, imageRect);
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt, referenceImage, resultImage, 1, 1)) {
+        referenceImage.save("fftw_blocks_reference.png");
+        resultImage.save("fftw_blocks_result.png");
+        QFAIL(QString("FFTW result differs from the spatial one at %1,%2").arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
 KISTEST_MAIN(KisConvolutionPainterTest)
@@ -52,6 +52,9 @@ private Q_SLOTS:
 
     void testNormalMapSpatial();
     void testNormalMapFFTW();
+
+    void testRecursiveGaussian();
+    void testFFTWMultipleBlocks();
 };
 
 #endif
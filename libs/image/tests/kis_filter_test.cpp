@@ -21,6 +21,8 @@
 #include <KoProgressUpdater.h>
 #include <KoUpdater.h>
 #include "testing_timed_default_bounds.h"
+#include <KisSequentialIteratorProgress.h>
+#include "kis_random_accessor_ng.h"
 
 class TestFilter : public KisFilter
 {
@@ -42,6 +44,47 @@ public:
 
 };
 
+/**
+ * Copies the pixels from \p shift rows above, so the filter reads
+ * only the top margin of the processed rect
+ */
+class VerticalShiftFilter : public KisFilter
+{
+public:
+
+    VerticalShiftFilter(int shift, bool streaming)
+        : KisFilter(KoID("shift", "shift"), KoID("test", "test"), "VerticalShiftFilter"),
+          m_shift(shift)
+    {
+        setSupportsStreaming(streaming);
+    }
+
+    void processImpl(KisPaintDeviceSP device,
+                     const QRect& rect,
+                     const KisFilterConfigurationSP config,
+                     KoUpdater* progressUpdater) const override {
+        Q_UNUSED(config);
+
+        const int pixelSize = device->pixelSize();
+        KisRandomConstAccessorSP srcIt = device->createRandomConstAccessorNG();
+        KisSequentialIteratorProgress dstIt(device, rect, progressUpdater);
+
+        while (dstIt.nextPixel()) {
+            srcIt->moveTo(dstIt.x(), dstIt.y() - m_shift);
+            memcpy(dstIt.rawData(), srcIt->oldRawData(), pixelSize);
+        }
+    }
+
+    QRect neededRect(const QRect &rect, const KisFilterConfigurationSP config, int lod) const override {
+        Q_UNUSED(config);
+        Q_UNUSED(lod);
+        return rect.adjusted(0, -m_shift, 0, 0);
+    }
+
+private:
+    int m_shift;
+};
+
 void KisFilterTest::testCreation()
 {
     TestFilter test;
@@ -237,5 +280,52 @@ void KisFilterTest::testBlurFilterApplicationRect()
     QVERIFY(TestUtil::compareQImages(pt, refImage, dst2Image));
 }
 
+void KisFilterTest::testStreaming()
+{
+    const KoColorSpace * cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rc(0, 0, 64, 2000);
+    const QRect applyRect(0, 300, 64, 1700);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(rc));
+
+    {
+        KisSequentialIterator it(dev, rc);
+        while (it.nextPixel()) {
+            const QColor color(it.x() * 4 % 256, it.y() % 256, it.y() / 256 * 16, 255);
+            cs->fromQColor(color, it.rawData());
+        }
+    }
+
+    KisSelectionSP sel = new KisSelection(new KisSelectionDefaultBounds(dev), KisImageResolutionProxy::identity());
+    sel->pixelSelection()->select(rc);
+    sel->updateProjection();
+
+    KisFilterSP reference = new VerticalShiftFilter(300, false);
+    KisFilterSP streaming = new VerticalShiftFilter(300, true);
+
+    KisFilterConfigurationSP config =
+        reference->defaultConfiguration(KisGlobalResourcesInterface::instance())->cloneWithResourcesSnapshot();
+
+    // filtering in place with a selection, the strips must read the original pixels
+    KisPaintDeviceSP refDev = new KisPaintDevice(*dev);
+    reference->process(refDev, refDev, sel, applyRect, config);
+
+    KisPaintDeviceSP streamingDev = new KisPaintDevice(*dev);
+    streaming->process(streamingDev, streamingDev, sel, applyRect, config);
+
+    QPoint pt;
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     refDev->convertToQImage(0, rc),
+                                     streamingDev->convertToQImage(0, rc)));
+
+    // filtering into a separate device
+    KisPaintDeviceSP streamingDst = new KisPaintDevice(cs);
+    streaming->process(dev, streamingDst, 0, applyRect, config);
+
+    QVERIFY(TestUtil::compareQImages(pt,
+                                     refDev->convertToQImage(0, applyRect),
+                                     streamingDst->convertToQImage(0, applyRect)));
+}
 
 SIMPLE_TEST_MAIN(KisFilterTest)
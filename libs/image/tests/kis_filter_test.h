@@ -20,6 +20,7 @@ private Q_SLOTS:
     void testDifferentSrcAndDst();
     void testOldDataApiAfterCopy();
     void testBlurFilterApplicationRect();
+    void testStreaming();
 };
 
 #endif
@@ -10,10 +10,13 @@
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
 #include <KoHistogramProducer.h>
+#include <KoBasicHistogramProducers.h>
+#include <KoColor.h>
 #include "kis_paint_device.h"
 #include "kis_histogram.h"
 #include "kis_paint_layer.h"
 #include "kis_types.h"
+#include "kis_sequential_iterator.h"
 #include "testimage.h"
 
 void KisHistogramTest::testCreation()
@@ -35,4 +38,55 @@ void KisHistogramTest::testCreation()
 }
 
 
+void KisHistogramTest::testConcurrentAndCachedBins()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    const QRect rect(0, 0, 1100, 700);
+
+    srand(7);
+    for (int y = rect.top(); y <= rect.bottom(); y += 50) {
+        for (int x = rect.left(); x <= rect.right(); x += 50) {
+            dev->fill(QRect(x, y, 50, 50), KoColor(QColor(rand() % 256, rand() % 256, rand() % 256), cs));
+        }
+    }
+
+    auto referenceBins = [&] (KoHistogramProducer *producer) {
+        producer->clear();
+        KisSequentialConstIterator it(dev, rect);
+        int numConseqPixels = it.nConseqPixels();
+        while (it.nextPixels(numConseqPixels)) {
+            numConseqPixels = it.nConseqPixels();
+            producer->addRegionToBin(it.oldRawData(), 0, numConseqPixels, cs);
+        }
+    };
+
+    auto compareBins = [] (KoHistogramProducer *producer, KoHistogramProducer *reference) {
+        QCOMPARE(producer->count(), reference->count());
+        for (int ch = 0; ch < reference->channels().size(); ch++) {
+            for (int i = 0; i < reference->numberOfBins(); i++) {
+                QCOMPARE(producer->getBinAt(ch, i), reference->getBinAt(ch, i));
+            }
+        }
+    };
+
+    QScopedPointer<KoHistogramProducer> reference(new KoGenericLabHistogramProducer());
+    referenceBins(reference.data());
+
+    KisHistogram histogram(dev, rect, new KoGenericLabHistogramProducer(), LINEAR);
+    compareBins(histogram.producer(), reference.data());
+
+    // the second histogram uses the cached bins
+    KisHistogram cachedHistogram(dev, rect, new KoGenericLabHistogramProducer(), LINEAR);
+    compareBins(cachedHistogram.producer(), reference.data());
+
+    // the changed device is counted again
+    dev->fill(QRect(100, 100, 600, 300), KoColor(Qt::red, cs));
+    referenceBins(reference.data());
+
+    histogram.updateHistogram();
+    compareBins(histogram.producer(), reference.data());
+}
+
+
 KISTEST_MAIN(KisHistogramTest)
@@ -148,4 +148,38 @@ void KisLiquifyTransformWorkerTest::testIdentityTransform()
     TestUtil::checkQImage(result, "liquify_transform_test", "liquify_dev", "identity");
 }
 
+void KisLiquifyTransformWorkerTest::testIncrementalPreview()
+{
+    QImage image(TestUtil::fetchDataFileLazy("test_transform_quality_second.png"));
+    image.convertTo(QImage::Format_ARGB32);
+
+    const int pixelPrecision = 8;
+    const QTransform imageToThumbTransform = QTransform::fromScale(0.5, 0.5);
+
+    KisLiquifyTransformWorker worker(image.rect(), 0, pixelPrecision);
+
+    worker.translatePoints(QPointF(100,100),
+                           QPointF(50, 0),
+                           50, false, 0.2);
+
+    QPointF offset;
+    worker.runOnQImage(image, QPointF(10, 10), imageToThumbTransform, &offset);
+
+    // the second stroke is small, so only a part of the preview is updated
+    worker.translatePoints(QPointF(300,300),
+                           QPointF(7, 3),
+                           20, false, 0.2);
+
+    QImage result = worker.runOnQImage(image, QPointF(10, 10), imageToThumbTransform, &offset);
+
+    KisLiquifyTransformWorker refWorker(image.rect(), 0, pixelPrecision);
+    refWorker.transformedPoints() = worker.transformedPoints();
+
+    QPointF refOffset;
+    QImage refResult = refWorker.runOnQImage(image, QPointF(10, 10), imageToThumbTransform, &refOffset);
+
+    QCOMPARE(offset, refOffset);
+    QCOMPARE(result, refResult);
+}
+
 SIMPLE_TEST_MAIN(KisLiquifyTransformWorkerTest)
@@ -16,6 +16,7 @@ private Q_SLOTS:
     void testPoints();
     void testPointsQImage();
     void testIdentityTransform();
+    void testIncrementalPreview();
 };
 
 #endif /* __KIS_LIQUIFY_TRANSFORM_WORKER_TEST_H */
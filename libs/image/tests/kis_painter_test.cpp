@@ -22,10 +22,12 @@
 #include "kis_paint_device.h"
 #include "kis_painter.h"
 #include "kis_pixel_selection.h"
+#include "kis_selection.h"
 #include "kis_fill_painter.h"
 #include <kis_fixed_paint_device.h>
 #include <testutil.h>
 #include <kis_iterator_ng.h>
+#include <kis_sequential_iterator.h>
 #include <testimage.h>
 
 void KisPainterTest::allCsApplicator(void (KisPainterTest::* funcPtr)(const KoColorSpace*cs))
@@ -671,6 +673,73 @@ void KisPainterTest::testOptimizedCopying()
 
 }
 
+void KisPainterTest::testBitBltSelectionChunks()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect rect(0, 0, 256, 192);
+
+    KisPaintDeviceSP src = new KisPaintDevice(cs);
+    KisPaintDeviceSP dst = new KisPaintDevice(cs);
+
+    {
+        KisSequentialIterator srcIt(src, rect);
+        KisSequentialIterator dstIt(dst, rect);
+
+        while (srcIt.nextPixel() && dstIt.nextPixel()) {
+            const int x = srcIt.x();
+            const int y = srcIt.y();
+
+            cs->fromQColor(QColor(x % 256, y % 256, 128, (x + y) % 256), srcIt.rawData());
+            cs->fromQColor(QColor(255 - y % 256, 64, x % 256, 255 - x % 256), dstIt.rawData());
+        }
+    }
+
+    /**
+     * The mask has fully selected, fully unselected and mixed tiles,
+     * and the blitted rect is not aligned to the tiles, so all the
+     * kinds of the mask chunks are blitted
+     */
+    KisSelectionSP selection = new KisSelection();
+    KisPixelSelectionSP pixelSelection = selection->pixelSelection();
+    pixelSelection->select(QRect(0, 0, 64, 192), MAX_SELECTED);
+    pixelSelection->select(QRect(128, 0, 20, 192), MAX_SELECTED);
+    pixelSelection->select(QRect(150, 70, 40, 40), 100);
+    pixelSelection->select(QRect(192, 64, 64, 64), MAX_SELECTED);
+
+    const QRect bltRect(10, 5, 230, 180);
+
+    KisFixedPaintDeviceSP fixedSelection = new KisFixedPaintDevice(KoColorSpaceRegistry::instance()->alpha8());
+    fixedSelection->setRect(QRect(QPoint(), bltRect.size()));
+    fixedSelection->initialize();
+    pixelSelection->readBytes(fixedSelection->data(), bltRect);
+
+    Q_FOREACH (const QString &compositeOpId, QStringList({COMPOSITE_OVER, COMPOSITE_COPY})) {
+        KisPaintDeviceSP result = new KisPaintDevice(*dst);
+        KisPaintDeviceSP reference = new KisPaintDevice(*dst);
+
+        {
+            KisPainter gc(result);
+            gc.setCompositeOpId(compositeOpId);
+            gc.setSelection(selection);
+            gc.bitBlt(bltRect.topLeft(), src, bltRect);
+        }
+
+        {
+            KisPainter gc(reference);
+            gc.setCompositeOpId(compositeOpId);
+            gc.bitBltWithFixedSelection(bltRect.x(), bltRect.y(), src, fixedSelection,
+                                        0, 0, bltRect.x(), bltRect.y(),
+                                        bltRect.width(), bltRect.height());
+        }
+
+        QPoint errorPoint;
+        if (!TestUtil::comparePaintDevices(errorPoint, result, reference)) {
+            QFAIL(QString("Blitting through the mask failed for %1 at %2,%3")
+                  .arg(compositeOpId).arg(errorPoint.x()).arg(errorPoint.y()).toLatin1());
+        }
+    }
+}
+
 KISTEST_MAIN(KisPainterTest)
 
 
@@ -51,6 +51,8 @@ private Q_SLOTS:
 
 
     void testOptimizedCopying();
+
+    void testBitBltSelectionChunks();
 };
 
 #endif
@@ -7,6 +7,7 @@
 #include "kis_perspective_transform_worker_test.h"
 
 #include <simpletest.h>
+#include <QtMath>
 
 #include <testutil.h>
 
@@ -15,6 +16,8 @@
 
 #include "kis_perspectivetransform_worker.h"
 #include "kis_transaction.h"
+#include "kis_random_accessor_ng.h"
+#include "kis_random_sub_accessor.h"
 
 
 class PerspectiveWorkerTester : public TestUtil::QImageBasedTest
@@ -60,4 +63,50 @@ void KisPerspectiveTransformWorkerTest::testSimpleTransform()
     t.checkLayer("simple_transform");
 }
 
+void KisPerspectiveTransformWorkerTest::testConcurrentProcessing()
+{
+    PerspectiveWorkerTester t;
+    KisPaintDeviceSP srcDev = t.paintDevice();
+
+    QTransform transform = QTransform::fromScale(1.5, 1.2);
+    transform.rotateRadians(M_PI / 7);
+    transform.translate(30.5, -15.3);
+    transform = QTransform(transform.m11(), transform.m12(), 0.0002,
+                           transform.m21(), transform.m22(), 0.0003,
+                           transform.m31(), transform.m32(), 1.0);
+
+    const QRect dstRect(0, 0, 1000, 800);
+
+    KisPaintDeviceSP dstDev = new KisPaintDevice(srcDev->colorSpace());
+    KisPerspectiveTransformWorker worker(0, transform, true, 0);
+    worker.runPartialDst(srcDev, dstDev, dstRect);
+
+    // the reference is sampled pixel by pixel in a single thread
+    KisPaintDeviceSP refDev = new KisPaintDevice(srcDev->colorSpace());
+    {
+        const QRectF srcClipRect = kisGrowRect(srcDev->exactBounds(), 1) | srcDev->defaultBounds()->imageBorderRect();
+        const QTransform backwardTransform = transform.inverted();
+
+        KisRandomSubAccessorSP srcAcc = srcDev->createRandomSubAccessor();
+        KisRandomAccessorSP accessor = refDev->createRandomAccessorNG();
+
+        for (int y = dstRect.top(); y <= dstRect.bottom(); ++y) {
+            for (int x = dstRect.left(); x <= dstRect.right(); ++x) {
+                const QPointF srcPoint = backwardTransform.map(QPointF(x, y));
+
+                if (srcClipRect.contains(srcPoint)) {
+                    accessor->moveTo(x, y);
+                    srcAcc->moveTo(srcPoint.x(), srcPoint.y());
+                    srcAcc->sampledOldRawData(accessor->rawData());
+                }
+            }
+        }
+    }
+
+    const QRect rc = refDev->exactBounds();
+    QVERIFY(!rc.isEmpty());
+    QCOMPARE(dstDev->exactBounds(), rc);
+    QCOMPARE(dstDev->convertToQImage(0, rc), refDev->convertToQImage(0, rc));
+}
+
 SIMPLE_TEST_MAIN(KisPerspectiveTransformWorkerTest)
@@ -14,6 +14,7 @@ class KisPerspectiveTransformWorkerTest : public QObject
     Q_OBJECT
 private Q_SLOTS:
     void testSimpleTransform();
+    void testConcurrentProcessing();
 };
 
 #endif /* __KIS_PERSPECTIVE_TRANSFORM_WORKER_TEST_H */
@@ -10,6 +10,11 @@
 
 #include <kis_debug.h>
 #include <QRect>
+#include <QRegion>
+#include <QtMath>
+#include <QRandomGenerator>
+
+#include <functional>
 
 #include <KoColorSpace.h>
 #include <KoColorSpaceRegistry.h>
@@ -26,6 +31,8 @@
 #include "kis_transaction.h"
 #include "kis_surrogate_undo_adapter.h"
 #include "commands/kis_selection_commands.h"
+#include "kis_selection_filters.h"
+#include "KisOutlineTileCache.h"
 
 
 void KisPixelSelectionTest::testCreation()
@@ -165,6 +172,66 @@ void KisPixelSelectionTest::testIntersectSelection()
     QCOMPARE(sel1->selectedExactRect(), QRect(25, 0, 25, 50));
 }
 
+void KisPixelSelectionTest::testPatchwiseOperations()
+{
+    const QRect rect(-20, -10, 300, 200);
+
+    /**
+     * The selections have fully selected, fully deselected and mixed
+     * patches, so all the shortcuts of the operations are exercised
+     */
+    auto createSelection = [rect] (int seed) {
+        KisPixelSelectionSP selection = new KisPixelSelection();
+        selection->select(QRect(0, 0, 128, 128));
+
+        QRandomGenerator random(seed);
+        for (int i = 0; i < 30; i++) {
+            const QPoint pt(rect.left() + random.bounded(rect.width()), rect.top() + random.bounded(rect.height()));
+            selection->select(QRect(pt, QSize(1 + random.bounded(40), 1 + random.bounded(40))) & rect,
+                              random.bounded(2) ? MAX_SELECTED : quint8(random.bounded(256)));
+        }
+        return selection;
+    };
+
+    KisPixelSelectionSP src = createSelection(1);
+    QVector<quint8> srcPixels(rect.width() * rect.height());
+    src->readBytes(srcPixels.data(), rect);
+
+    auto testOperation = [&] (SelectionAction action, std::function<quint8(quint8, quint8)> func) {
+        KisPixelSelectionSP dst = createSelection(2);
+
+        QVector<quint8> expected(rect.width() * rect.height());
+        dst->readBytes(expected.data(), rect);
+        for (int i = 0; i < expected.size(); i++) {
+            expected[i] = func(expected[i], srcPixels[i]);
+        }
+
+        dst->applySelection(src, action);
+
+        QVector<quint8> result(rect.width() * rect.height());
+        dst->readBytes(result.data(), rect);
+        QCOMPARE(result, expected);
+    };
+
+    testOperation(SELECTION_ADD, [] (quint8 dst, quint8 src) { return quint8(qMin(dst + src, 255)); });
+    testOperation(SELECTION_SUBTRACT, [] (quint8 dst, quint8 src) { return quint8(qMax(dst - src, 0)); });
+    testOperation(SELECTION_INTERSECT, [] (quint8 dst, quint8 src) { return qMin(dst, src); });
+    testOperation(SELECTION_SYMMETRICDIFFERENCE, [] (quint8 dst, quint8 src) { return quint8(qAbs(dst - src)); });
+
+    QCOMPARE(src->patchType(QRect(0, 0, 64, 64)), KisPixelSelection::SelectedPatch);
+    QCOMPARE(src->patchType(QRect(1000, 1000, 64, 64)), KisPixelSelection::UnselectedPatch);
+    QCOMPARE(src->patchType(QRect(-1, 0, 64, 64)), KisPixelSelection::MixedPatch);
+
+    KisPixelSelectionSP inverted = new KisPixelSelection(*src);
+    inverted->invert();
+
+    QVector<quint8> invertedPixels(rect.width() * rect.height());
+    inverted->readBytes(invertedPixels.data(), rect);
+    for (int i = 0; i < invertedPixels.size(); i++) {
+        QCOMPARE(invertedPixels[i], quint8(MAX_SELECTED - srcPixels[i]));
+    }
+}
+
 void KisPixelSelectionTest::testTotally()
 {
     KisPixelSelectionSP sel = new KisPixelSelection();
@@ -580,5 +647,271 @@ void KisPixelSelectionTest::testOutlineArtifacts()
                    QPoint(0,0)})}));
 }
 
+QRegion outlineRegion(const QVector<QPolygon> &polygons)
+{
+    QRegion region;
+
+    Q_FOREACH (const QPolygon &polygon, polygons) {
+        region ^= QRegion(polygon, Qt::OddEvenFill);
+    }
+
+    return region;
+}
+
+void KisPixelSelectionTest::testOutlineTileCache()
+{
+    KisPixelSelectionSP psel = new KisPixelSelection();
+    psel->select(QRect(10, 10, 300, 200));
+    psel->select(QRect(100, 100, 30, 30), MIN_SELECTED);
+    psel->select(QRect(400, 20, 1, 1));
+
+    const QRect rc = psel->selectedExactRect();
+    KisOutlineTileCache cache;
+
+    QVector<QPolygon> outline = cache.outline(psel, rc);
+    QCOMPARE(cache.numRecalculatedTiles(), 28);
+    QCOMPARE(outline.size(), 3);
+    QCOMPARE(outlineRegion(outline), outlineRegion(psel->outline()));
+
+    // nothing has changed
+    QCOMPARE(cache.outline(psel, rc), outline);
+    QCOMPARE(cache.numRecalculatedTiles(), 0);
+
+    // the hole lies inside a single tile and doesn't touch its border
+    psel->select(QRect(200, 150, 5, 5), MIN_SELECTED);
+
+    outline = cache.outline(psel, rc);
+    QCOMPARE(cache.numRecalculatedTiles(), 1);
+    QCOMPARE(outline.size(), 4);
+    QCOMPARE(outlineRegion(outline), outlineRegion(psel->outline()));
+
+    KisOutlineTileCache freshCache;
+    QCOMPARE(freshCache.outline(psel, rc), outline);
+}
+
+void KisPixelSelectionTest::testSimplifiedOutline()
+{
+    KisPixelSelectionSP psel = new KisPixelSelection();
+    psel->select(QRect(10, 10, 300, 200));
+    psel->invalidateOutlineCache();
+    psel->recalculateOutlineCache();
+
+    QVERIFY(psel->simplifiedOutlineCache().isEmpty());
+
+    const QRect rc(0, 0, 200, 200);
+    QVector<quint8> pixels(rc.width() * rc.height(), MIN_SELECTED);
+
+    for (int y = 0; y < rc.height(); y += 2) {
+        for (int x = 0; x < rc.width(); x += 2) {
+            pixels[y * rc.width() + x] = MAX_SELECTED;
+        }
+    }
+
+    psel->clear();
+    psel->writeBytes(pixels.data(), rc);
+    psel->invalidateOutlineCache();
+    psel->recalculateOutlineCache();
+
+    const QVector<QPainterPath> simplified = psel->simplifiedOutlineCache();
+    QCOMPARE(simplified.size(), 3);
+    QVERIFY(simplified.last().elementCount() < psel->outlineCache().elementCount() / 4);
+    QVERIFY(simplified.last().boundingRect().contains(psel->outlineCache().boundingRect()));
+
+    // the cheap updates of the outline cache drop the simplified outlines
+    psel->select(QRect(300, 300, 10, 10));
+    QVERIFY(psel->outlineCacheValid());
+    QVERIFY(psel->simplifiedOutlineCache().isEmpty());
+}
+
+void KisPixelSelectionTest::testGrowShrinkFilters()
+{
+    const QRect rect(-10, -7, 130, 110);
+
+    KisPixelSelectionSP selection = new KisPixelSelection();
+
+    srand(5);
+    for (int i = 0; i < 40; i++) {
+        const QPoint pt(rect.left() + rand() % rect.width(), rect.top() + rand() % rect.height());
+        selection->select(QRect(pt, QSize(1 + rand() % 20, 1 + rand() % 20)) & rect, MAX_SELECTED);
+    }
+
+    QVector<quint8> src(rect.width() * rect.height());
+    selection->readBytes(src.data(), rect);
+
+    /**
+     * Brute force morphology with the same elliptic structuring
+     * element as the one of the filters
+     */
+    auto bruteForce = [&] (int xRadius, int yRadius, bool grow, bool edgeLock) {
+        QVector<int> halfHeights(xRadius + 1);
+        halfHeights[0] = yRadius;
+        for (int i = 1; i <= xRadius; i++) {
+            halfHeights[i] = qFloor(yRadius * std::sqrt(pow2(xRadius) - pow2(i - 0.5)) / xRadius + 0.5);
+        }
+
+        QVector<quint8> result(src.size());
+
+        for (int y = 0; y < rect.height(); y++) {
+            for (int x = 0; x < rect.width(); x++) {
+                quint8 value = grow ? MIN_SELECTED : MAX_SELECTED;
+
+                for (int dx = -xRadius; dx <= xRadius; dx++) {
+                    const int h = halfHeights[qAbs(dx)];
+
+                    for (int dy = -h; dy <= h; dy++) {
+                        int sx = x + dx;
+                        int sy = y + dy;
+
+                        quint8 srcValue = MIN_SELECTED;
+
+                        if (edgeLock) {
+                            sx = qBound(0, sx, rect.width() - 1);
+                            sy = qBound(0, sy, rect.height() - 1);
+                        }
+
+                        if (sx >= 0 && sx < rect.width() && sy >= 0 && sy < rect.height()) {
+                            srcValue = src[sy * rect.width() + sx];
+                        }
+
+                        value = grow ? qMax(value, srcValue) : qMin(value, srcValue);
+                    }
+                }
+
+                result[y * rect.width() + x] = value;
+            }
+        }
+
+        return result;
+    };
+
+    const QVector<QPair<int, int>> radii({{1, 1}, {4, 4}, {9, 3}, {2, 11}, {25, 25}});
+
+    for (auto it = radii.begin(); it != radii.end(); ++it) {
+        const int xRadius = it->first;
+        const int yRadius = it->second;
+
+        QVector<quint8> result(src.size());
+
+        {
+            KisPixelSelectionSP dst = new KisPixelSelection(*selection);
+            KisGrowSelectionFilter(xRadius, yRadius).process(dst, rect);
+            dst->readBytes(result.data(), rect);
+            QVERIFY(result == bruteForce(xRadius, yRadius, true, false));
+        }
+
+        Q_FOREACH (bool edgeLock, QVector<bool>({false, true})) {
+            KisPixelSelectionSP dst = new KisPixelSelection(*selection);
+            KisShrinkSelectionFilter(xRadius, yRadius, edgeLock).process(dst, rect);
+            dst->readBytes(result.data(), rect);
+            QVERIFY(result == bruteForce(xRadius, yRadius, false, edgeLock));
+        }
+    }
+}
+
+void KisPixelSelectionTest::testBorderFilter()
+{
+    const QRect rect(-10, -7, 130, 110);
+
+    KisPixelSelectionSP selection = new KisPixelSelection();
+
+    QRandomGenerator random(7);
+    for (int i = 0; i < 40; i++) {
+        const QPoint pt(rect.left() + random.bounded(rect.width()), rect.top() + random.bounded(rect.height()));
+        selection->select(QRect(pt, QSize(1 + random.bounded(20), 1 + random.bounded(20))) & rect, MAX_SELECTED);
+    }
+
+    QVector<quint8> src(rect.width() * rect.height());
+    selection->readBytes(src.data(), rect);
+
+    auto srcValue = [&] (int x, int y) {
+        return src[qBound(0, y, rect.height() - 1) * rect.width() + qBound(0, x, rect.width() - 1)];
+    };
+
+    // the selected pixels having an unselected neighbour, as in computeTransition()
+    QVector<bool> transition(src.size());
+    for (int y = 0; y < rect.height(); y++) {
+        for (int x = 0; x < rect.width(); x++) {
+            bool isTransition = false;
+
+            if (srcValue(x, y) >= 128) {
+                for (int dy = -1; dy <= 1; dy++) {
+                    for (int dx = -1; dx <= 1; dx++) {
+                        isTransition |= srcValue(x + dx, y + dy) < 128;
+                    }
+                }
+            }
+
+            transition[y * rect.width() + x] = isTransition;
+        }
+    }
+
+    /**
+     * Brute force border with the same density kernels as the ones
+     * of the filter
+     */
+    auto bruteForce = [&] (int xRadius, int yRadius, bool antialiasing) {
+        auto density = [&] (int dx, int dy) -> quint8 {
+            if (antialiasing) {
+                const qreal maxRadius = 0.5 * (xRadius + yRadius);
+                const qreal minRadius = maxRadius - 1.0;
+                const qreal dist = std::sqrt(qreal(pow2(dx) + pow2(dy)));
+
+                return dist > maxRadius ? MIN_SELECTED :
+                    dist > minRadius ? qRound((1.0 - dist + minRadius) * 255.0) :
+                    MAX_SELECTED;
+            } else {
+                const qreal tmpx = dx ? qAbs(dx) - 0.5 : 0.0;
+                const qreal tmpy = dy ? qAbs(dy) - 0.5 : 0.0;
+
+                return pow2(tmpy) / pow2(yRadius) + pow2(tmpx) / pow2(xRadius) <= 1.0 ?
+                    MAX_SELECTED : MIN_SELECTED;
+            }
+        };
+
+        QVector<quint8> result(src.size());
+
+        for (int y = 0; y < rect.height(); y++) {
+            for (int x = 0; x < rect.width(); x++) {
+                quint8 value = MIN_SELECTED;
+
+                for (int dy = -yRadius; dy <= yRadius; dy++) {
+                    for (int dx = -xRadius; dx <= xRadius; dx++) {
+                        const int sx = x + dx;
+                        const int sy = y + dy;
+
+                        if (sx >= 0 && sx < rect.width() && sy >= 0 && sy < rect.height() &&
+                            transition[sy * rect.width() + sx]) {
+
+                            value = qMax(value, density(dx, dy));
+                        }
+                    }
+                }
+
+                result[y * rect.width() + x] = value;
+            }
+        }
+
+        return result;
+    };
+
+    QVector<quint8> result(src.size());
+
+    const QVector<QPair<int, int>> radii({{4, 4}, {9, 3}, {2, 11}, {25, 25}});
+
+    for (auto it = radii.begin(); it != radii.end(); ++it) {
+        KisPixelSelectionSP dst = new KisPixelSelection(*selection);
+        KisBorderSelectionFilter(it->first, it->second, false).process(dst, rect);
+        dst->readBytes(result.data(), rect);
+        QVERIFY(result == bruteForce(it->first, it->second, false));
+    }
+
+    Q_FOREACH (int radius, QVector<int>({3, 8, 25})) {
+        KisPixelSelectionSP dst = new KisPixelSelection(*selection);
+        KisBorderSelectionFilter(radius, radius, true).process(dst, rect);
+        dst->readBytes(result.data(), rect);
+        QVERIFY(result == bruteForce(radius, radius, true));
+    }
+}
+
 KISTEST_MAIN(KisPixelSelectionTest)
 
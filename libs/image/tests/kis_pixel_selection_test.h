@@ -24,6 +24,7 @@ private Q_SLOTS:
     void testAddSelection();
     void testSubtractSelection();
     void testIntersectSelection();
+    void testPatchwiseOperations();
     void testTotally();
     void testUpdateProjection();
     void testExactRectWithImage();
@@ -35,6 +36,12 @@ private Q_SLOTS:
     void testOutlineCacheTransactions();
 
     void testOutlineArtifacts();
+
+    void testOutlineTileCache();
+    void testSimplifiedOutline();
+
+    void testGrowShrinkFilters();
+    void testBorderFilter();
 };
 
 #endif
@@ -284,6 +284,181 @@ void KisScanlineFillTest::testExternalFill()
     QCOMPARE(c, QColor(Qt::blue));
 }
 
+void KisScanlineFillTest::testParallelEngine()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect boundingRect(-37, -21, 300, 250);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    /**
+     * Random blocks of a few levels of gray make lots of small
+     * regions that cross the tile borders in different ways
+     */
+    srand(10);
+    const int levels[] = {0, 20, 60, 200};
+
+    for (int y = boundingRect.top(); y <= boundingRect.bottom(); y += 3) {
+        for (int x = boundingRect.left(); x <= boundingRect.right(); x += 3) {
+            const int level = levels[rand() % 4];
+            dev->fill(QRect(x, y, 3, 3), KoColor(QColor(level, level, level), cs));
+        }
+    }
+
+    auto runFill = [&] (bool useParallelEngine, int mode, int threshold, int opacitySpread,
+                        QImage *resultImage, QRect *fillExtent) {
+
+        KisPaintDeviceSP src = new KisPaintDevice(*dev);
+        KisPixelSelectionSP pixelSelection = new KisPixelSelection(new KisSelectionDefaultBounds(src));
+
+        KisScanlineFill gc(src, QPoint(5, 7), boundingRect);
+        gc.setUseParallelEngine(useParallelEngine);
+        gc.setThreshold(threshold);
+        gc.setOpacitySpread(opacitySpread);
+
+        if (mode == 0) {
+            gc.fillSelection(pixelSelection);
+        } else if (mode == 1) {
+            gc.fillSelectionUntilColor(pixelSelection, KoColor(QColor(200, 200, 200), cs));
+        } else {
+            gc.fill(KoColor(Qt::red, cs));
+        }
+
+        *fillExtent = gc.fillExtent();
+        *resultImage = mode < 2 ?
+            pixelSelection->convertToQImage(0, boundingRect) :
+            src->convertToQImage(0, boundingRect);
+    };
+
+    for (int mode = 0; mode < 3; mode++) {
+        for (int threshold : {1, 30, 80}) {
+            for (int opacitySpread : {100, 40}) {
+                QImage scanlineImage;
+                QImage parallelImage;
+                QRect scanlineExtent;
+                QRect parallelExtent;
+
+                runFill(false, mode, threshold, opacitySpread, &scanlineImage, &scanlineExtent);
+                runFill(true, mode, threshold, opacitySpread, &parallelImage, &parallelExtent);
+
+                QCOMPARE(parallelExtent, scanlineExtent);
+                QCOMPARE(parallelImage, scanlineImage);
+            }
+        }
+    }
+}
+
+void KisScanlineFillTest::testRegionLabelMap()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect boundingRect(-37, -21, 300, 250);
+    const KoColor boundaryColor(QColor(200, 200, 200), cs);
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    srand(10);
+    const int levels[] = {0, 20, 60, 200};
+
+    for (int y = boundingRect.top(); y <= boundingRect.bottom(); y += 3) {
+        for (int x = boundingRect.left(); x <= boundingRect.right(); x += 3) {
+            const int level = levels[rand() % 4];
+            dev->fill(QRect(x, y, 3, 3), KoColor(QColor(level, level, level), cs));
+        }
+    }
+
+    auto runFill = [&] (KisFillRegionLabelMapSP map, const QPoint &seed) {
+        KisPaintDeviceSP src = new KisPaintDevice(*dev);
+        KisPixelSelectionSP pixelSelection = new KisPixelSelection(new KisSelectionDefaultBounds(src));
+
+        KisScanlineFill gc(src, seed, boundingRect);
+        gc.setThreshold(30);
+        gc.setOpacitySpread(40);
+        gc.setRegionLabelMap(map);
+        gc.fillSelectionUntilColor(pixelSelection, boundaryColor);
+
+        return pixelSelection->convertToQImage(0, boundingRect);
+    };
+
+    const QVector<QPoint> seeds({QPoint(5, 7), QPoint(130, 70), QPoint(250, 200), QPoint(-30, 220)});
+
+    const qint64 initialUsage = KisFillRegionLabelMap::totalMemoryUsage();
+
+    KisFillRegionLabelMapSP map = new KisFillRegionLabelMap;
+
+    for (int pass = 0; pass < 2; pass++) {
+        Q_FOREACH (const QPoint &seed, seeds) {
+            QCOMPARE(runFill(map, seed), runFill(KisFillRegionLabelMapSP(), seed));
+        }
+    }
+
+    QVERIFY(map->numRegions() > 0);
+    QVERIFY(map->numHits() > 0);
+
+    QVERIFY(map->memoryUsage() > 0);
+    QCOMPARE(KisFillRegionLabelMap::totalMemoryUsage(), initialUsage + map->memoryUsage());
+
+    // the changed pixels should invalidate the regions around them
+    dev->fill(QRect(0, 0, 40, 40), KoColor(QColor(20, 20, 20), cs));
+    dev->fill(QRect(100, 50, 60, 3), boundaryColor);
+
+    Q_FOREACH (const QPoint &seed, seeds) {
+        QCOMPARE(runFill(map, seed), runFill(KisFillRegionLabelMapSP(), seed));
+    }
+
+    map->clear();
+    QCOMPARE(map->numRegions(), 0);
+    QCOMPARE(map->numHits(), 0);
+    QCOMPARE(map->memoryUsage(), 0);
+    QCOMPARE(KisFillRegionLabelMap::totalMemoryUsage(), initialUsage);
+}
+
+void KisScanlineFillTest::testGapMapCache()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+
+    QImage srcImage(TestUtil::fetchDataFileLazy("close_gap_low.png"));
+    QVERIFY(!srcImage.isNull());
+
+    const QRect imageRect = srcImage.rect();
+    dev->convertFromQImage(srcImage, 0, 0, 0);
+
+    auto runFill = [&] (KisFillRegionLabelMapSP map, const QPoint &seed, int gapSize) {
+        KisPaintDeviceSP src = new KisPaintDevice(*dev);
+        KisPixelSelectionSP pixelSelection = new KisPixelSelection(new KisSelectionDefaultBounds(src));
+
+        KisScanlineFill gc(src, seed, imageRect);
+        gc.setThreshold(1);
+        gc.setOpacitySpread(100);
+        gc.setCloseGap(gapSize);
+        gc.setRegionLabelMap(map);
+        gc.fillSelection(pixelSelection);
+
+        return pixelSelection->convertToQImage(0, imageRect);
+    };
+
+    const QVector<QPoint> seeds({QPoint(52, 84), QPoint(103, 94), QPoint(43, 30), QPoint(63, 53)});
+
+    KisFillRegionLabelMapSP map = new KisFillRegionLabelMap;
+
+    for (int gapSize : {3, 3, 5}) {
+        Q_FOREACH (const QPoint &seed, seeds) {
+            QCOMPARE(runFill(map, seed, gapSize), runFill(KisFillRegionLabelMapSP(), seed, gapSize));
+        }
+    }
+
+    // the changed pixels should invalidate the distances around them
+    dev->fill(QRect(40, 20, 4, 30), KoColor(Qt::black, cs));
+    dev->fill(QRect(90, 90, 30, 30), KoColor(Qt::transparent, cs));
+
+    Q_FOREACH (const QPoint &seed, seeds) {
+        QCOMPARE(runFill(map, seed, 5), runFill(KisFillRegionLabelMapSP(), seed, 5));
+    }
+
+    // the loaded tiles of the gap map are accounted as well
+    QVERIFY(map->memoryUsage() >= 64 * 64 * 4);
+}
+
 void KisScanlineFillTest::testGapClosingFillGeneral(QPoint seed, int gapSize)
 {
     const KoColorSpace* cs = KoColorSpaceRegistry::instance()->rgb8();
@@ -26,8 +26,11 @@ private Q_SLOTS:
 
     void testClearNonZeroComponent();
     void testExternalFill();
+    void testParallelEngine();
+    void testRegionLabelMap();
 
     void testGapClosingFill();
+    void testGapMapCache();
 
 private:
     void testFillGeneral(const QVector<KisFillInterval> &initialBackwardIntervals,
@@ -315,11 +315,9 @@ void KisSelectionTest::testOutlineGeneration()
     closedSubPath.closeSubpath();
 
     /**
-     * Our outline generation code has a small problem: it can
-     * generate a polygon, which isn't closed (it'll repeat the first
-     * point instead). There is a special workaround for it in
-     * KisPixelSelection::recalculateOutlineCache(), which explicitly
-     * closes the path, so here we just check it.
+     * The generated polygons don't repeat their first point in the
+     * end, so KisPixelSelection::recalculateOutlineCache() closes the
+     * subpaths explicitly. Here we just check it.
      */
 
     bool isClosed = closedSubPath == calculatedOutline;
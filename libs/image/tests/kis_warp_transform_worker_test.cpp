@@ -336,5 +336,48 @@ void KisWarpTransformWorkerTest::testNeedChangeRects()
     QCOMPARE(worker.approxChangeRect(d.bounds.toAlignedRect()), QRect(-44,-44, 982,986));
 }
 
+void KisWarpTransformWorkerTest::testConcurrentProcessing()
+{
+    WarpTransformWorkerData d;
+    KisPaintDeviceSP srcDev = new KisPaintDevice(*d.dev);
+
+    KisWarpTransformWorker worker(KisWarpTransformWorker::RIGID_TRANSFORM,
+                                  d.origPoints,
+                                  d.transfPoints,
+                                  d.alpha,
+                                  d.updater);
+    worker.run(srcDev, d.dev);
+
+    // the reference is painted cell by cell in a single thread
+    KisPaintDeviceSP refDev = new KisPaintDevice(srcDev->colorSpace());
+
+    auto transformOp = [&d] (const QPointF &pt) {
+        return KisWarpTransformWorker::rigidTransformMath(pt, d.origPoints, d.transfPoints, d.alpha);
+    };
+
+    GridIterationTools::PaintDevicePolygonOp polygonOp(srcDev, refDev);
+    GridIterationTools::processGrid(polygonOp, transformOp,
+                                    srcDev->region().boundingRect(), 8);
+
+    const QRect rc = refDev->exactBounds();
+    QCOMPARE(d.dev->exactBounds(), rc);
+    QCOMPARE(d.dev->convertToQImage(0, rc), refDev->convertToQImage(0, rc));
+}
+
+void KisWarpTransformWorkerTest::testEmptyDevice()
+{
+    WarpTransformWorkerData d;
+    KisPaintDeviceSP srcDev = new KisPaintDevice(d.dev->colorSpace());
+
+    KisWarpTransformWorker worker(KisWarpTransformWorker::RIGID_TRANSFORM,
+                                  d.origPoints,
+                                  d.transfPoints,
+                                  d.alpha,
+                                  d.updater);
+    worker.run(srcDev, d.dev);
+
+    QVERIFY(d.dev->exactBounds().isEmpty());
+}
+
 
 SIMPLE_TEST_MAIN(KisWarpTransformWorkerTest)
@@ -41,34 +41,35 @@ bool KisTiledExtentManager::Data::add(qint32 index)
         currentIndex = m_offset + index;
     }
 
-    KIS_ASSERT_RECOVER_NOOP(m_buffer[currentIndex].loadAcquire() >= 0);
-    bool needsUpdateExtent = false;
-
-    while (true) {
-        QReadLocker rl(&m_extentLock);
+    QAtomicInt &counter = m_buffer[currentIndex];
 
-        int oldValue = m_buffer[currentIndex].loadAcquire();
-        if (oldValue == 0) {
-            rl.unlock();
-            QWriteLocker wl(&m_extentLock);
+    /**
+     * Fast path: the column/row is already a part of the extent, so
+     * we can just bump its counter without touching the extent lock.
+     * That is what happens in the majority of cases, when many threads
+     * create tiles in the same area of the device. The counter can
+     * never drop to zero while the CAS is in progress, because CAS
+     * checks the exact old value.
+     */
+    int oldValue = counter.loadAcquire();
+    KIS_ASSERT_RECOVER_NOOP(oldValue >= 0);
 
-            if ((oldValue = m_buffer[currentIndex].loadAcquire()) == 0) {
+    while (oldValue > 0) {
+        if (counter.testAndSetOrdered(oldValue, oldValue + 1, oldValue)) {
+            return false;
+        }
+    }
 
-                if (m_min > index) m_min = index;
-                if (m_max < index) m_max = index;
+    QWriteLocker wl(&m_extentLock);
 
-                ++m_count;
-                needsUpdateExtent = true;
+    bool needsUpdateExtent = false;
 
-                m_buffer[currentIndex].storeRelease(1);
-            } else {
-                m_buffer[currentIndex].storeRelease(oldValue + 1);
-            }
+    if (counter.fetchAndAddOrdered(1) == 0) {
+        if (m_min > index) m_min = index;
+        if (m_max < index) m_max = index;
 
-            break;
-        } else if (m_buffer[currentIndex].testAndSetOrdered(oldValue, oldValue + 1)) {
-            break;
-        }
+        ++m_count;
+        needsUpdateExtent = true;
     }
 
     return needsUpdateExtent;
@@ -80,9 +81,8 @@ bool KisTiledExtentManager::Data::remove(qint32 index)
     qint32 currentIndex = m_offset + index;
 
     bool needsUpdateExtent = false;
-    QReadLocker rl(&m_extentLock);
 
-    const int oldValue = m_buffer[currentIndex].fetchAndAddAcquire(-1);
+    const int oldValue = m_buffer[currentIndex].fetchAndAddOrdered(-1);
 
     /**
      * That is not the droid you're looking for. If you see this assert
@@ -96,8 +96,13 @@ bool KisTiledExtentManager::Data::remove(qint32 index)
         return false;
     }
 
+    /**
+     * The counter might have already been raised from zero by a
+     * concurrent add() call. In such a case the extent is either
+     * kept as it is by updateMin()/updateMax() or fixed up by
+     * the counterpart's add() (the count is adjusted symmetrically).
+     */
     if (oldValue == 1) {
-        rl.unlock();
         QWriteLocker wl(&m_extentLock);
 
         if (m_min == index) updateMin();
@@ -17,6 +17,7 @@
 // #include "Ko_global.h"
 #include "KoIntegerMaths.h"
 #include "KoChannelInfo.h"
+#include "kis_assert.h"
 
 static const KoColorSpace* m_labCs = 0;
 
@@ -68,6 +69,28 @@ void KoBasicHistogramProducer::clear()
     }
 }
 
+void KoBasicHistogramProducer::addBins(const KoHistogramProducer *other)
+{
+    const KoBasicHistogramProducer *src = dynamic_cast<const KoBasicHistogramProducer*>(other);
+    KIS_SAFE_ASSERT_RECOVER_RETURN(src && src->m_channels == m_channels && src->m_nrOfBins == m_nrOfBins);
+
+    m_count += src->m_count;
+    for (int i = 0; i < m_channels; i++) {
+        for (int j = 0; j < m_nrOfBins; j++) {
+            m_bins[i][j] += src->m_bins[i][j];
+        }
+        m_outRight[i] += src->m_outRight[i];
+        m_outLeft[i] += src->m_outLeft[i];
+    }
+}
+
+void KoBasicHistogramProducer::copySettingsTo(KoBasicHistogramProducer *producer) const
+{
+    producer->setView(m_from, m_width);
+    producer->setSkipTransparent(m_skipTransparent);
+    producer->setSkipUnselected(m_skipUnselected);
+}
+
 void KoBasicHistogramProducer::makeExternalToInternal()
 {
     // This function assumes that the pixel is has no 'gaps'. That is to say: if we start
@@ -100,6 +123,13 @@ QString KoBasicU8HistogramProducer::positionToString(qreal pos) const
     return QString("%1").arg(static_cast<quint8>(pos * UINT8_MAX));
 }
 
+KoHistogramProducer *KoBasicU8HistogramProducer::createEmptyCopy() const
+{
+    KoBasicU8HistogramProducer *producer = new KoBasicU8HistogramProducer(m_id, m_colorSpace);
+    copySettingsTo(producer);
+    return producer;
+}
+
 void KoBasicU8HistogramProducer::addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *cs)
 {
     quint32 dstPixelSize = m_colorSpace->pixelSize();
@@ -134,6 +164,7 @@ void KoBasicU8HistogramProducer::addRegionToBin(const quint8 * pixels, const qui
             nPixels--;
         }
     }
+    delete[] dstPixels;
 }
 
 // ------------ U16 ---------------------
@@ -153,6 +184,13 @@ qreal KoBasicU16HistogramProducer::maximalZoom() const
     return 1.0 / 255.0;
 }
 
+KoHistogramProducer *KoBasicU16HistogramProducer::createEmptyCopy() const
+{
+    KoBasicU16HistogramProducer *producer = new KoBasicU16HistogramProducer(m_id, m_colorSpace);
+    copySettingsTo(producer);
+    return producer;
+}
+
 void KoBasicU16HistogramProducer::addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *cs)
 {
     // The view
@@ -206,6 +244,7 @@ void KoBasicU16HistogramProducer::addRegionToBin(const quint8 * pixels, const qu
             nPixels--;
         }
     }
+    delete[] dstPixels;
 }
 
 // ------------ Float32 ---------------------
@@ -225,6 +264,13 @@ qreal KoBasicF32HistogramProducer::maximalZoom() const
     return 1.0 / 255.0;
 }
 
+KoHistogramProducer *KoBasicF32HistogramProducer::createEmptyCopy() const
+{
+    KoBasicF32HistogramProducer *producer = new KoBasicF32HistogramProducer(m_id, m_colorSpace);
+    copySettingsTo(producer);
+    return producer;
+}
+
 void KoBasicF32HistogramProducer::addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *cs)
 {
     // The view
@@ -279,6 +325,7 @@ void KoBasicF32HistogramProducer::addRegionToBin(const quint8 * pixels, const qu
 
         }
     }
+    delete[] dstPixels;
 }
 
 #ifdef HAVE_OPENEXR
@@ -300,6 +347,13 @@ qreal KoBasicF16HalfHistogramProducer::maximalZoom() const
     return 1.0 / 255.0;
 }
 
+KoHistogramProducer *KoBasicF16HalfHistogramProducer::createEmptyCopy() const
+{
+    KoBasicF16HalfHistogramProducer *producer = new KoBasicF16HalfHistogramProducer(m_id, m_colorSpace);
+    copySettingsTo(producer);
+    return producer;
+}
+
 void KoBasicF16HalfHistogramProducer::addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *cs)
 {
     // The view
@@ -352,6 +406,7 @@ void KoBasicF16HalfHistogramProducer::addRegionToBin(const quint8 * pixels, cons
             nPixels--;
         }
     }
+    delete[] dstPixels;
 }
 #endif
 
@@ -381,6 +436,13 @@ qreal KoGenericRGBHistogramProducer::maximalZoom() const
     return 1.0;
 }
 
+KoHistogramProducer *KoGenericRGBHistogramProducer::createEmptyCopy() const
+{
+    KoGenericRGBHistogramProducer *producer = new KoGenericRGBHistogramProducer();
+    copySettingsTo(producer);
+    return producer;
+}
+
 
 void KoGenericRGBHistogramProducer::addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *cs)
 {
@@ -465,6 +527,13 @@ qreal KoGenericLabHistogramProducer::maximalZoom() const
     return 1.0;
 }
 
+KoHistogramProducer *KoGenericLabHistogramProducer::createEmptyCopy() const
+{
+    KoGenericLabHistogramProducer *producer = new KoGenericLabHistogramProducer();
+    copySettingsTo(producer);
+    return producer;
+}
+
 
 void KoGenericLabHistogramProducer::addRegionToBin(const quint8 *pixels, const quint8 *selectionMask, quint32 nPixels,  const KoColorSpace *cs)
 {
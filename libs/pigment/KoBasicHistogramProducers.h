@@ -27,6 +27,8 @@ public:
 
     void clear() override;
 
+    void addBins(const KoHistogramProducer *other) override;
+
     void setView(qreal from, qreal size) override {
         m_from = from; m_width = size;
     }
@@ -78,6 +80,8 @@ protected:
     }
     // not virtual since that is useless: we call it from constructor
     void makeExternalToInternal();
+    /// copies the view and the skipping options to \p producer
+    void copySettingsTo(KoBasicHistogramProducer *producer) const;
     typedef QVector<quint32> vBins;
     QVector<vBins> m_bins;
     vBins m_outLeft, m_outRight;
@@ -95,6 +99,7 @@ public:
     KoBasicU8HistogramProducer(const KoID& id, const KoColorSpace *colorSpace);
     ~KoBasicU8HistogramProducer() override {}
     void addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *colorSpace) override;
+    KoHistogramProducer *createEmptyCopy() const override;
     QString positionToString(qreal pos) const override;
     qreal maximalZoom() const override {
         return 1.0;
@@ -107,6 +112,7 @@ public:
     KoBasicU16HistogramProducer(const KoID& id, const KoColorSpace *colorSpace);
     ~KoBasicU16HistogramProducer() override {}
     void addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *colorSpace) override;
+    KoHistogramProducer *createEmptyCopy() const override;
     QString positionToString(qreal pos) const override;
     qreal maximalZoom() const override;
 };
@@ -117,6 +123,7 @@ public:
     KoBasicF32HistogramProducer(const KoID& id, const KoColorSpace *colorSpace);
     ~KoBasicF32HistogramProducer() override {}
     void addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *colorSpace) override;
+    KoHistogramProducer *createEmptyCopy() const override;
     QString positionToString(qreal pos) const override;
     qreal maximalZoom() const override;
 };
@@ -129,6 +136,7 @@ public:
     KoBasicF16HalfHistogramProducer(const KoID& id, const KoColorSpace *colorSpace);
     ~KoBasicF16HalfHistogramProducer() override {}
     void addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *colorSpace) override;
+    KoHistogramProducer *createEmptyCopy() const override;
     QString positionToString(qreal pos) const override;
     qreal maximalZoom() const override;
 };
@@ -182,6 +190,7 @@ public:
     KoGenericRGBHistogramProducer();
     ~KoGenericRGBHistogramProducer() override {}
     void addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *colorSpace) override;
+    KoHistogramProducer *createEmptyCopy() const override;
     QString positionToString(qreal pos) const override;
     qreal maximalZoom() const override;
     QList<KoChannelInfo *> channels() override;
@@ -223,6 +232,7 @@ public:
     KoGenericLabHistogramProducer();
     ~KoGenericLabHistogramProducer() override;
     void addRegionToBin(const quint8 * pixels, const quint8 * selectionMask, quint32 nPixels, const KoColorSpace *colorSpace) override;
+    KoHistogramProducer *createEmptyCopy() const override;
     QString positionToString(qreal pos) const override;
     qreal maximalZoom() const override;
     QList<KoChannelInfo *> channels() override;
@@ -399,6 +399,26 @@ void KoColorSpace::transparentColor(quint8 *dst, quint32 nPixels) const
     setOpacity(dst, OPACITY_TRANSPARENT_U8, nPixels);
 }
 
+void KoColorSpace::differences(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const
+{
+    const qint32 pixelSize = this->pixelSize();
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        differences[i] = difference(reference, pixels);
+        pixels += pixelSize;
+    }
+}
+
+void KoColorSpace::differencesA(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const
+{
+    const qint32 pixelSize = this->pixelSize();
+
+    for (qint32 i = 0; i < nPixels; i++) {
+        differences[i] = differenceA(reference, pixels);
+        pixels += pixelSize;
+    }
+}
+
 const KoColorConversionTransformation* KoColorSpace::toLabA16Converter() const
 {
     if (!d->transfoToLABA16) {
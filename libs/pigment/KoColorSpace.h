@@ -604,6 +604,21 @@ public:
      */
     virtual quint8 differenceA(const quint8* src1, const quint8* src2) const = 0;
 
+    /**
+     * Calculate difference() between \p reference and every pixel of
+     * \p pixels and write the results into \p differences.
+     *
+     * The default implementation calls difference() for every pixel. The
+     * color spaces, which convert the pixels to calculate the difference,
+     * should reimplement it to convert all the pixels in one go.
+     */
+    virtual void differences(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const;
+
+    /**
+     * Same as differences(), but calculates differenceA() for every pixel
+     */
+    virtual void differencesA(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const;
+
     /**
      * @return the mix color operation of this colorspace (do not delete it locally, it's deleted by the colorspace).
      */
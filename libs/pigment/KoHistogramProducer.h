@@ -66,6 +66,33 @@ public:
     virtual void setSkipUnselected(bool set) {
         m_skipUnselected = set;
     }
+    bool skipTransparent() const {
+        return m_skipTransparent;
+    }
+    bool skipUnselected() const {
+        return m_skipUnselected;
+    }
+
+    // Methods to split the counting into several parts
+
+    /**
+     * Creates a producer of the same kind and with the same settings, but
+     * with empty bins. The parts of an image can be counted by several such
+     * producers concurrently and then merged with addBins().
+     *
+     * @return the new producer or 0 if the producer cannot be split
+     */
+    virtual KoHistogramProducer *createEmptyCopy() const {
+        return 0;
+    }
+
+    /**
+     * Adds the bins and counts of \p other, which was created by
+     * createEmptyCopy(), to the bins of this producer
+     */
+    virtual void addBins(const KoHistogramProducer *other) {
+        Q_UNUSED(other);
+    }
 
     // Methods with general information about this specific producer
     virtual const KoID& id() const = 0;
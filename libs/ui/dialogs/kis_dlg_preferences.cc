@@ -1305,6 +1305,7 @@ void TabletSettingsTab::setDefault()
     m_page->chkUseTimestampsForBrushSpeed->setChecked(false);
     m_page->intMaxAllowedBrushSpeed->setValue(30);
     m_page->intBrushSpeedSmoothing->setValue(3);
+    m_page->intStrokePredictionLookAhead->setValue(cfg.strokePredictionLookAhead(true));
 
 }
 
@@ -1378,6 +1379,15 @@ TabletSettingsTab::TabletSettingsTab(QWidget* parent, const char* name): QWidget
         //       used as the prefix and the text after as the suffix
         return i18np("Brush speed smoothing: {n} sample", "Brush speed smoothing: {n} samples", value);
     });
+
+    m_page->intStrokePredictionLookAhead->setRange(0, 50);
+    m_page->intStrokePredictionLookAhead->setValue(cfg.strokePredictionLookAhead());
+    KisSpinBoxI18nHelper::install(m_page->intStrokePredictionLookAhead, [](int value) {
+        // i18n: This is meant to be used in a spinbox so keep the {n} in the text
+        //       and it will be substituted by the number. The text before will be
+        //       used as the prefix and the text after as the suffix
+        return i18np("Stroke prediction look-ahead: {n} ms", "Stroke prediction look-ahead: {n} ms", value);
+    });
 }
 
 void TabletSettingsTab::slotTabletTest()
@@ -2474,6 +2484,7 @@ bool KisDlgPreferences::editPreferences()
         cfg.writeEntry<bool>("useTimestampsForBrushSpeed", m_tabletSettings->m_page->chkUseTimestampsForBrushSpeed->isChecked());
         cfg.writeEntry<int>("maxAllowedSpeedValue", m_tabletSettings->m_page->intMaxAllowedBrushSpeed->value());
         cfg.writeEntry<int>("speedValueSmoothing", m_tabletSettings->m_page->intBrushSpeedSmoothing->value());
+        cfg.setStrokePredictionLookAhead(m_tabletSettings->m_page->intStrokePredictionLookAhead->value());
 
         m_performanceSettings->save();
 
@@ -52,6 +52,7 @@
 #include "kis_extended_modifiers_mapper.h"
 #include "kis_input_manager_p.h"
 #include "kis_algebra_2d.h"
+#include "KisTraceRecorder.h"
 
 template <typename T>
 uint qHash(QPointer<T> value) {
@@ -178,6 +179,8 @@ bool KisInputManager::eventFilter(QObject* object, QEvent* event)
 {
     if (object != d->eventsReceiver) return false;
 
+    KIS_TRACE_SCOPE("input", "KisInputManager::eventFilter");
+
     if (d->eventEater.eventFilter(object, event)) return false;
 
     if (!d->matcher.hasRunningShortcut()) {
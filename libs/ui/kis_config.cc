@@ -1195,6 +1195,16 @@ void KisConfig::setForceAlwaysFullSizedOutline(bool value) const
     m_cfg.writeEntry("forceAlwaysFullSizedOutline", value);
 }
 
+int KisConfig::strokePredictionLookAhead(bool defaultValue) const
+{
+    return (defaultValue ? 0 : m_cfg.readEntry("strokePredictionLookAhead", 0));
+}
+
+void KisConfig::setStrokePredictionLookAhead(int value) const
+{
+    m_cfg.writeEntry("strokePredictionLookAhead", value);
+}
+
 // eraser outline settings
 
 bool KisConfig::showEraserOutlineWhilePainting(bool defaultValue) const
@@ -286,6 +286,14 @@ public:
     bool forceAlwaysFullSizedOutline(bool defaultValue = false) const;
     void setForceAlwaysFullSizedOutline(bool value) const;
 
+    /**
+     * Time (in ms) for which the freehand tool extrapolates the stroke
+     * while painting and shows the predicted position of the brush in
+     * the outline. Zero disables prediction.
+     */
+    int strokePredictionLookAhead(bool defaultValue = false) const;
+    void setStrokePredictionLookAhead(int value) const;
+
     bool showEraserOutlineWhilePainting(bool defaultValue = false) const;
     void setShowEraserOutlineWhilePainting(bool showEraserOutlineWhilePainting) const;
 
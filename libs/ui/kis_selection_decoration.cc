@@ -33,6 +33,7 @@
 #include "kis_image_config.h"
 #include "KisImageConfigNotifier.h"
 #include "kis_painting_tweaks.h"
+#include "kis_lod_transform_base.h"
 #include "KisView.h"
 #include "kis_selection_mask.h"
 #include <KisPart.h>
@@ -121,6 +122,7 @@ void KisSelectionDecoration::selectionChanged()
 
             if (m_mode == Ants) {
                 m_outlinePath = selection->outlineCache();
+                m_simplifiedOutlinePaths = selection->simplifiedOutlineCache();
                 m_antsTimer->start();
             } else {
                 m_thumbnailImage = selection->thumbnailImage();
@@ -137,6 +139,7 @@ void KisSelectionDecoration::selectionChanged()
     } else {
         m_signalCompressor.stop();
         m_outlinePath = QPainterPath();
+        m_simplifiedOutlinePaths.clear();
         m_thumbnailImage = QImage();
         m_thumbnailImageTransform = QTransform();
         view()->canvasBase()->updateCanvas();
@@ -221,13 +224,21 @@ void KisSelectionDecoration::drawDecoration(QPainter& gc, const QRectF& updateRe
 
         gc.setOpacity(m_opacity);
 
+        // the zoomed out views don't need the pixel-precise outline
+        const int levelOfDetail =
+            KisLodTransformBase::scaleToLod(converter->effectiveZoom(),
+                                            m_simplifiedOutlinePaths.size());
+
+        const QPainterPath &outlinePath =
+            levelOfDetail > 0 ? m_simplifiedOutlinePaths[levelOfDetail - 1] : m_outlinePath;
+
         // render selection outline in white
         gc.setPen(m_outlinePen);
-        gc.drawPath(m_outlinePath);
+        gc.drawPath(outlinePath);
 
         // render marching ants in black (above the white outline)
         gc.setPen(m_antsPen);
-        gc.drawPath(m_outlinePath);
+        gc.drawPath(outlinePath);
     }
     gc.restore();
 }
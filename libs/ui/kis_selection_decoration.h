@@ -11,6 +11,7 @@
 #include <QTimer>
 #include <QPolygon>
 #include <QPen>
+#include <QVector>
 
 #include <kis_signal_compressor.h>
 #include "canvas/kis_canvas_decoration.h"
@@ -57,6 +58,7 @@ private:
 
     KisSignalCompressor m_signalCompressor;
     QPainterPath m_outlinePath;
+    QVector<QPainterPath> m_simplifiedOutlinePaths;
     QImage m_thumbnailImage;
     QTransform m_thumbnailImageTransform;
     QTimer* m_antsTimer;
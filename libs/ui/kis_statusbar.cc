@@ -277,11 +277,13 @@ void KisStatusBar::updateMemoryStatus()
                   "Image size:\t %1\n"
                   "  - layers:\t\t %2\n"
                   "  - projections:\t %3\n"
-                  "  - instant preview:\t %4\n",
+                  "  - instant preview:\t %4\n"
+                  "  - filter caches:\t %5\n",
                   format.formatByteSize(stats.imageSize),
                   format.formatByteSize(stats.layersSize),
                   format.formatByteSize(stats.projectionsSize),
-                  format.formatByteSize(stats.lodSize));
+                  format.formatByteSize(stats.lodSize),
+                  format.formatByteSize(stats.filterCachesSize));
 
     const QString memoryStatsMsg =
             i18nc("tooltip on statusbar memory reporting button (total stats)",
@@ -289,8 +291,9 @@ void KisStatusBar::updateMemoryStatus()
                   "  image data:\t %3 / %4\n"
                   "  pool:\t\t %5 / %6\n"
                   "  undo data:\t %7\n"
+                  "  fill tool caches:\t %8\n"
                   "\n"
-                  "Swap used:\t %8",
+                  "Swap used:\t %9",
                   format.formatByteSize(stats.totalMemorySize),
                   format.formatByteSize(stats.totalMemoryLimit),
 
@@ -301,6 +304,7 @@ void KisStatusBar::updateMemoryStatus()
                   format.formatByteSize(stats.tilesPoolLimit),
 
                   format.formatByteSize(stats.historicalMemorySize),
+                  format.formatByteSize(stats.fillCachesSize),
                   format.formatByteSize(stats.swapSize));
 
     QString longStats = imageStatsMsg + "\n" + memoryStatsMsg;
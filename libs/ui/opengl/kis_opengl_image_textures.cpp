@@ -24,6 +24,7 @@
 #include <KoColorModelStandardIds.h>
 
 #include "kis_image.h"
+#include "KisTraceRecorder.h"
 #include "kis_config.h"
 #include "KisPart.h"
 #include "KisOpenGLModeProber.h"
@@ -326,6 +327,8 @@ KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheNoConversion(const QRec
 // TODO: add sanity checks about the conformance of the passed srcImage!
 KisOpenGLUpdateInfoSP KisOpenGLImageTextures::updateCacheImpl(const QRect& rect, KisImageSP srcImage, bool convertColorSpace)
 {
+    KIS_TRACE_SCOPE("canvas", "KisOpenGLImageTextures::updateCache");
+
     if (!m_initialized) return new KisOpenGLUpdateInfo();
     return m_updateInfoBuilder.buildUpdateInfo(rect, srcImage, convertColorSpace);
 }
@@ -340,6 +343,8 @@ void KisOpenGLImageTextures::recalculateCache(KisUpdateInfoSP info, bool blockMi
     KisOpenGLUpdateInfoSP glInfo = dynamic_cast<KisOpenGLUpdateInfo*>(info.data());
     if(!glInfo) return;
 
+    KIS_TRACE_SCOPE("canvas", "KisOpenGLImageTextures::recalculateCache");
+
     QScopedPointer<KisOpenGLSync> sync;
     int numProcessedTiles = 0;
 
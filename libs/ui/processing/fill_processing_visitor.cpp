@@ -167,6 +167,7 @@ void FillProcessingVisitor::normalFill(KisPaintDeviceSP device, const QRect &fil
     fillPainter.setFillThreshold(m_fillThreshold);
     fillPainter.setOpacitySpread(m_opacitySpread);
     fillPainter.setCloseGap(m_closeGap);
+    fillPainter.setRegionLabelMap(m_regionLabelMap);
     fillPainter.setRegionFillingMode(m_regionFillingMode);
     if (m_regionFillingMode == KisFillPainter::RegionFillingMode_BoundaryFill) {
         fillPainter.setRegionFillingBoundaryColor(m_regionFillingBoundaryColor);
@@ -259,6 +260,7 @@ void FillProcessingVisitor::continuousFill(KisPaintDeviceSP device, const QRect
         painter.setFillThreshold(m_fillThreshold);
         painter.setOpacitySpread(m_opacitySpread);
         painter.setCloseGap(m_closeGap);
+        painter.setRegionLabelMap(m_regionLabelMap);
         painter.setRegionFillingMode(m_regionFillingMode);
         if (m_regionFillingMode == KisFillPainter::RegionFillingMode_BoundaryFill) {
             painter.setRegionFillingBoundaryColor(m_regionFillingBoundaryColor);
@@ -370,6 +372,11 @@ void FillProcessingVisitor::setCloseGap(int gap)
     m_closeGap = gap;
 }
 
+void FillProcessingVisitor::setRegionLabelMap(KisFillRegionLabelMapSP regionLabelMap)
+{
+    m_regionLabelMap = regionLabelMap;
+}
+
 void FillProcessingVisitor::setRegionFillingMode(KisFillPainter::RegionFillingMode regionFillingMode)
 {
     m_regionFillingMode = regionFillingMode;
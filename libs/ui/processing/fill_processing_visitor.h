@@ -42,6 +42,7 @@ public:
     void setFillThreshold(int fillThreshold);
     void setOpacitySpread(int opacitySpread);
     void setCloseGap(int gap);
+    void setRegionLabelMap(KisFillRegionLabelMapSP regionLabelMap);
     void setRegionFillingMode(KisFillPainter::RegionFillingMode regionFillingMode);
     void setRegionFillingBoundaryColor(const KoColor &regionFillingBoundaryColor);
     void setContinuousFillMode(ContinuousFillMode continuousFillMode);
@@ -83,6 +84,7 @@ private:
     int m_fillThreshold;
     int m_opacitySpread;
     int m_closeGap;
+    KisFillRegionLabelMapSP m_regionLabelMap;
     KisFillPainter::RegionFillingMode m_regionFillingMode;
     KoColor m_regionFillingBoundaryColor;
 
@@ -9,6 +9,7 @@
 #include <QTimer>
 #include <QElapsedTimer>
 #include <QQueue>
+#include <QPainterPath>
 
 #include <klocalizedstring.h>
 
@@ -108,7 +109,16 @@ struct KisToolFreehandHelper::Private
     KisStabilizedEventsSampler stabilizedSampler;
     KisStabilizerDelayedPaintHelper stabilizerDelayedPaintHelper;
 
+    // Stroke prediction data
+    int predictionLookAhead = 0;
+    bool hasLastEvent = false;
+    QPointF lastEventPos;
+    qreal lastEventTime = 0.0;
+    bool hasPredictionVelocity = false;
+    QPointF predictionVelocity;
+
     qreal effectiveSmoothnessDistance() const;
+    void updatePrediction(const KisPaintInformation &info);
 };
 
 
@@ -216,6 +226,32 @@ KisOptimizedBrushOutline KisToolFreehandHelper::paintOpOutline(const QPointF &sa
 
     KisOptimizedBrushOutline outline = settings->brushOutline(info, mode, currentPhysicalZoom());
 
+    if (!m_d->strokeInfos.isEmpty() &&
+        m_d->predictionLookAhead > 0 &&
+        m_d->hasPredictionVelocity) {
+
+        /**
+         * The painted stroke always lags behind the pen because of the
+         * smoothing and rendering delays. To make it feel more responsive
+         * we extrapolate the motion of the pen and show where the brush
+         * is expected to be in a few milliseconds. The prediction is a
+         * part of the outline, so it is replaced by the real stroke as
+         * soon as the next input event arrives.
+         */
+        const QPointF predictedPos =
+            m_d->lastEventPos + m_d->predictionVelocity * m_d->predictionLookAhead;
+
+        KisOptimizedBrushOutline predictedOutline = outline;
+        predictedOutline.translate(predictedPos - info.pos());
+
+        QPainterPath predictedSegment;
+        predictedSegment.moveTo(info.pos());
+        predictedSegment.lineTo(predictedPos);
+
+        outline.addPath(predictedOutline);
+        outline.addPath(predictedSegment);
+    }
+
     if (m_d->resources &&
         m_d->smoothingOptions->smoothingType() == KisSmoothingOptions::STABILIZER &&
         m_d->smoothingOptions->useDelayDistance()) {
@@ -312,6 +348,10 @@ void KisToolFreehandHelper::initPaintImpl(qreal startAngle,
 
     m_d->history.clear();
     m_d->distanceHistory.clear();
+    m_d->predictionLookAhead = KisConfig(true).strokePredictionLookAhead();
+    m_d->hasLastEvent = false;
+    m_d->hasPredictionVelocity = false;
+
     m_d->lastDrawnPixel = QPointF(-1.0, -1.0); 
     m_d->hasLastDrawnPixel = false;
     m_d->pixelInLineCount = 0;
@@ -453,9 +493,34 @@ void KisToolFreehandHelper::paintEvent(KoPointerEvent *event)
                                              elapsedStrokeTime());
     KisUpdateTimeMonitor::instance()->reportMouseMove(info.pos());
 
+    m_d->updatePrediction(info);
+
     paint(info);
 }
 
+void KisToolFreehandHelper::Private::updatePrediction(const KisPaintInformation &info)
+{
+    if (predictionLookAhead <= 0) return;
+
+    if (hasLastEvent) {
+        const qreal timeDiff = info.currentTime() - lastEventTime;
+
+        if (timeDiff > 0) {
+            const QPointF velocity = (info.pos() - lastEventPos) / timeDiff;
+
+            // average with the previous value to suppress the tablet jitter
+            predictionVelocity = hasPredictionVelocity ?
+                0.5 * (predictionVelocity + velocity) : velocity;
+
+            hasPredictionVelocity = true;
+        }
+    }
+
+    lastEventPos = info.pos();
+    lastEventTime = info.currentTime();
+    hasLastEvent = true;
+}
+
 
 void KisToolFreehandHelper::paint(KisPaintInformation &info)
 { 
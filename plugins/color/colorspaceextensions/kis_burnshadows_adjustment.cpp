@@ -20,74 +20,22 @@
 #include <KoColorTransformation.h>
 #include <KoID.h>
 
-template<typename _channel_type_, typename traits>
-class KisBurnShadowsAdjustment : public KoColorTransformation
- {
-    typedef traits RGBTrait;
-    typedef typename RGBTrait::Pixel RGBPixel;
+#include "kis_channel_lut_adjustment.h"
 
+template<typename _channel_type_, typename traits>
+class KisBurnShadowsAdjustment : public KisChannelLutAdjustment<_channel_type_, traits, KisBurnShadowsAdjustment<_channel_type_, traits>>
+{
 public:
-    KisBurnShadowsAdjustment(){}
-
- 	void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
- 	{
-        const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
-        RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-        float value_red, value_green, value_blue, new_value_red, new_value_green, new_value_blue;
-        const float factor(exposure * 0.333333);
-        while (nPixels > 0) {
-
-            value_red =  KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->red);
-            value_green =  KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->green);
-            value_blue =  KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->blue);
-
-            if( value_red < factor ) new_value_red = 0;
-            else new_value_red = (value_red - factor)/(1 - factor);
-            if( value_green < factor ) new_value_green = 0;
-            else new_value_green = (value_green - factor)/(1 - factor);
-            if( value_blue < factor ) new_value_blue = 0;
-            else new_value_blue = (value_blue - factor)/(1 - factor);
-            
-            dst->red = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(new_value_red);
-            dst->green = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(new_value_green);
-            dst->blue = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(new_value_blue);
-            dst->alpha = src->alpha;
-            
-            --nPixels;
-            ++src;
-            ++dst;
-        }
- 	}
-
-	QList<QString> parameters() const override
-	{
-        QList<QString> list;
-        list << "exposure";
-        return list;
-	}
-
-	int parameterId(const QString& name) const override
+    static inline float factor(float exposure)
     {
-        if (name == "exposure")
-        return 0;
-        return -1;
+        return exposure * 0.333333;
     }
 
-    void setParameter(int id, const QVariant& parameter) override
+    static inline float mapChannel(float value, float factor)
     {
-        switch(id)
-        {
-        case 0:
-            exposure = parameter.toDouble();
-            break;
-        default:
-            ;
-        }
+        return value < factor ? 0.0f : (value - factor) / (1 - factor);
     }
-private:
-
-    float exposure {0.0f};
- };
+};
 
  KisBurnShadowsAdjustmentFactory::KisBurnShadowsAdjustmentFactory()
     : KoColorTransformationFactory("BurnShadows")
@@ -0,0 +1,129 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ * SPDX-License-Identifier: LGPL-2.0-or-later
+*/
+
+#ifndef _KIS_CHANNEL_LUT_ADJUSTMENT_H_
+#define _KIS_CHANNEL_LUT_ADJUSTMENT_H_
+
+#include <type_traits>
+#include <limits>
+
+#include <QVector>
+#include <QVariant>
+
+#include <KoColorSpaceMaths.h>
+#include <KoColorTransformation.h>
+
+/**
+ * Base class for the dodge and burn adjustments. They apply the same
+ * function, controlled by the "exposure" parameter, to the red, green
+ * and blue channels independently.
+ *
+ * For integer channels the function is baked into a lookup table when
+ * the exposure is set, so transform() does only the table lookups. For
+ * floating point channels the function is inlined into the pixel loop.
+ *
+ * \p Derived should implement two static functions:
+ *
+ * \code{.cpp}
+ * static float factor(float exposure);
+ * static float mapChannel(float value, float factor);
+ * \endcode
+ */
+template<typename _channel_type_, typename traits, class Derived>
+class KisChannelLutAdjustment : public KoColorTransformation
+{
+    typedef traits RGBTrait;
+    typedef typename RGBTrait::Pixel RGBPixel;
+
+    static const bool useLut = std::is_integral<_channel_type_>::value;
+
+public:
+    KisChannelLutAdjustment()
+    {
+        updateLut();
+    }
+
+    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
+    {
+        const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
+        RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
+
+        if constexpr (useLut) {
+            const _channel_type_ *lut = m_lut.constData();
+
+            for (qint32 i = 0; i < nPixels; i++) {
+                dst[i].red = lut[src[i].red];
+                dst[i].green = lut[src[i].green];
+                dst[i].blue = lut[src[i].blue];
+                dst[i].alpha = src[i].alpha;
+            }
+        } else {
+            const float factor = m_factor;
+
+            for (qint32 i = 0; i < nPixels; i++) {
+                dst[i].red = mapValue(src[i].red, factor);
+                dst[i].green = mapValue(src[i].green, factor);
+                dst[i].blue = mapValue(src[i].blue, factor);
+                dst[i].alpha = src[i].alpha;
+            }
+        }
+    }
+
+    QList<QString> parameters() const override
+    {
+        QList<QString> list;
+        list << "exposure";
+        return list;
+    }
+
+    int parameterId(const QString& name) const override
+    {
+        if (name == "exposure")
+            return 0;
+        return -1;
+    }
+
+    void setParameter(int id, const QVariant& parameter) override
+    {
+        switch(id)
+        {
+        case 0:
+            m_exposure = parameter.toDouble();
+            updateLut();
+            break;
+        default:
+            ;
+        }
+    }
+
+private:
+    static inline _channel_type_ mapValue(_channel_type_ value, float factor)
+    {
+        const float result = Derived::mapChannel(KoColorSpaceMaths<_channel_type_, float>::scaleToA(value), factor);
+        return KoColorSpaceMaths<float, _channel_type_>::scaleToA(result);
+    }
+
+    void updateLut()
+    {
+        m_factor = Derived::factor(m_exposure);
+
+        if constexpr (useLut) {
+            const int size = int(std::numeric_limits<_channel_type_>::max()) + 1;
+            m_lut.resize(size);
+
+            for (int i = 0; i < size; i++) {
+                m_lut[i] = mapValue(_channel_type_(i), m_factor);
+            }
+        }
+    }
+
+private:
+    float m_exposure {0.0f};
+    float m_factor {0.0f};
+    QVector<_channel_type_> m_lut;
+};
+
+#endif
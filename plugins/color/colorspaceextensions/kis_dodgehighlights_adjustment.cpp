@@ -20,68 +20,22 @@
 #include <KoColorTransformation.h>
 #include <KoID.h>
 
+#include "kis_channel_lut_adjustment.h"
+
 template<typename _channel_type_, typename traits>
-class KisDodgeHighlightsAdjustment : public KoColorTransformation
+class KisDodgeHighlightsAdjustment : public KisChannelLutAdjustment<_channel_type_, traits, KisDodgeHighlightsAdjustment<_channel_type_, traits>>
 {
-    typedef traits RGBTrait;
-    typedef typename RGBTrait::Pixel RGBPixel;
-
 public:
-    KisDodgeHighlightsAdjustment(){}
-
-    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
+    static inline float factor(float exposure)
     {
-        const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
-        RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-        float value_red, value_green, value_blue;
-        const float factor(1.0 + exposure * (0.33333));
-        while(nPixels > 0) {
-
-            value_red = factor * KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->red);
-            value_green = factor * KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->green);
-            value_blue = factor * KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->blue);
-            
-            dst->red = KoColorSpaceMaths< float, _channel_type_>::scaleToA(value_red);
-            dst->green = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(value_green);
-            dst->blue = KoColorSpaceMaths< float, _channel_type_>::scaleToA(value_blue);
-            dst->alpha = src->alpha;
-            
-            --nPixels;
-            ++src;
-            ++dst;
-        }
-
+        return 1.0 + exposure * (0.33333);
     }
 
-	QList<QString> parameters() const override
-	{
-        QList<QString> list;
-        list << "exposure";
-        return list;
-	}
-
-	int parameterId(const QString& name) const override
+    static inline float mapChannel(float value, float factor)
     {
-        if (name == "exposure")
-        return 0;
-        return -1;
+        return factor * value;
     }
-
-    void setParameter(int id, const QVariant& parameter) override
-    {
-        switch(id)
-        {
-        case 0:
-            exposure = parameter.toDouble();
-            break;
-        default:
-            ;
-        }
-    }
-private:
-
-    float exposure {0.0f};
- };
+};
 
  KisDodgeHighlightsAdjustmentFactory::KisDodgeHighlightsAdjustmentFactory()
     : KoColorTransformationFactory("DodgeHighlights")
@@ -19,69 +19,22 @@
 #include <KoColorSpaceTraits.h>
 #include <KoColorTransformation.h>
 #include <KoID.h>
- 
-template<typename _channel_type_, typename traits >
-class KisDodgeMidtonesAdjustment : public KoColorTransformation
- {
-    typedef traits RGBTrait;
-    typedef typename RGBTrait::Pixel RGBPixel;
-
-public:
-    KisDodgeMidtonesAdjustment(){}
 
+#include "kis_channel_lut_adjustment.h"
+ 
+template<typename _channel_type_, typename traits>
+class KisDodgeMidtonesAdjustment : public KisChannelLutAdjustment<_channel_type_, traits, KisDodgeMidtonesAdjustment<_channel_type_, traits>>
+{
 public:
-    
-    void transform(const quint8 *srcU8, quint8 *dstU8, qint32 nPixels) const override
-    {
-    	const RGBPixel* src = reinterpret_cast<const RGBPixel*>(srcU8);
-        RGBPixel* dst = reinterpret_cast<RGBPixel*>(dstU8);
-        float value_red, value_green, value_blue;
-        const float factor(1.0/(1.0 + exposure));
-        while(nPixels > 0) {
-
-            value_red = pow((float)KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->red), factor);
-            value_green = pow((float)KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->green), factor);
-            value_blue = pow((float)KoColorSpaceMaths<_channel_type_, float>::scaleToA(src->blue), factor);
-            
-            dst->red = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(value_red);
-            dst->green = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(value_green);
-            dst->blue = KoColorSpaceMaths< float, _channel_type_ >::scaleToA(value_blue);
-            dst->alpha = src->alpha;
-            
-            --nPixels;
-            ++src;
-            ++dst;
-        }
-    }
-
-    QList<QString> parameters() const override
+    static inline float factor(float exposure)
     {
-    	QList<QString> list;
-    	list << "exposure";
-    	return list;
+        return 1.0/(1.0 + exposure);
     }
 
-    int parameterId(const QString& name) const override
+    static inline float mapChannel(float value, float factor)
     {
-        if (name == "exposure")
-        return 0;
-        return -1;
+        return pow(value, factor);
     }
-
-    void setParameter(int id, const QVariant& parameter) override
-    {
-        switch(id)
-        {
-        case 0:
-            exposure = parameter.toDouble();
-            break;
-        default:
-            ;
-        }
-    }
-private:
-
-    float exposure {0.0f};
 };
 
  KisDodgeMidtonesAdjustmentFactory::KisDodgeMidtonesAdjustmentFactory()
@@ -362,7 +362,6 @@ public:
     quint8 difference(const quint8 *src1, const quint8 *src2) const override
     {
         quint8 lab1[8], lab2[8];
-        cmsCIELab labF1, labF2;
 
         if (this->opacityU8(src1) == OPACITY_TRANSPARENT_U8
                 || this->opacityU8(src2) == OPACITY_TRANSPARENT_U8) {
@@ -371,23 +370,14 @@ public:
         Q_ASSERT(this->toLabA16Converter());
         this->toLabA16Converter()->transform(src1, lab1, 1);
         this->toLabA16Converter()->transform(src2, lab2, 1);
-        cmsLabEncoded2Float(&labF1, (cmsUInt16Number *)lab1);
-        cmsLabEncoded2Float(&labF2, (cmsUInt16Number *)lab2);
-        qreal diff = cmsDeltaE(&labF1, &labF2);
 
-        if (diff > 255.0) {
-            return 255;
-        } else {
-            return quint8(diff);
-        }
+        return labDifference(lab1, lab2);
     }
 
     quint8 differenceA(const quint8 *src1, const quint8 *src2) const override
     {
         quint8 lab1[8];
         quint8 lab2[8];
-        cmsCIELab labF1;
-        cmsCIELab labF2;
 
         if (this->opacityU8(src1) == OPACITY_TRANSPARENT_U8
                 || this->opacityU8(src2) == OPACITY_TRANSPARENT_U8) {
@@ -399,8 +389,44 @@ public:
         Q_ASSERT(this->toLabA16Converter());
         this->toLabA16Converter()->transform(src1, lab1, 1);
         this->toLabA16Converter()->transform(src2, lab2, 1);
-        cmsLabEncoded2Float(&labF1, (cmsUInt16Number *)lab1);
-        cmsLabEncoded2Float(&labF2, (cmsUInt16Number *)lab2);
+
+        return labDifferenceA(lab1, lab2);
+    }
+
+    void differences(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const override
+    {
+        differencesImpl<false>(reference, pixels, differences, nPixels);
+    }
+
+    void differencesA(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const override
+    {
+        differencesImpl<true>(reference, pixels, differences, nPixels);
+    }
+
+private:
+
+    static quint8 labDifference(const quint8 *lab1, const quint8 *lab2)
+    {
+        cmsCIELab labF1, labF2;
+
+        cmsLabEncoded2Float(&labF1, (const cmsUInt16Number *)lab1);
+        cmsLabEncoded2Float(&labF2, (const cmsUInt16Number *)lab2);
+        qreal diff = cmsDeltaE(&labF1, &labF2);
+
+        if (diff > 255.0) {
+            return 255;
+        } else {
+            return quint8(diff);
+        }
+    }
+
+    static quint8 labDifferenceA(const quint8 *lab1, const quint8 *lab2)
+    {
+        cmsCIELab labF1;
+        cmsCIELab labF2;
+
+        cmsLabEncoded2Float(&labF1, (const cmsUInt16Number *)lab1);
+        cmsLabEncoded2Float(&labF2, (const cmsUInt16Number *)lab2);
 
         cmsFloat64Number dL;
         cmsFloat64Number da;
@@ -413,8 +439,8 @@ public:
 
         static const int LabAAlphaPos = 3;
         static const cmsFloat64Number alphaScale = 100.0 / KoColorSpaceMathsTraits<quint16>::max;
-        quint16 alpha1 = reinterpret_cast<quint16 *>(lab1)[LabAAlphaPos];
-        quint16 alpha2 = reinterpret_cast<quint16 *>(lab2)[LabAAlphaPos];
+        quint16 alpha1 = reinterpret_cast<const quint16 *>(lab1)[LabAAlphaPos];
+        quint16 alpha2 = reinterpret_cast<const quint16 *>(lab2)[LabAAlphaPos];
         dAlpha = fabs((qreal)(alpha1 - alpha2)) * alphaScale;
 
         qreal diff = pow(dL * dL + da * da + db * db + dAlpha * dAlpha, 0.5);
@@ -426,7 +452,55 @@ public:
         }
     }
 
-private:
+    /**
+     * The per-pixel transformations of LCMS have a huge overhead, so the
+     * pixels are converted to Lab in chunks and only then compared with
+     * the reference color. The results are exactly the same as the ones
+     * of difference() and differenceA().
+     */
+    template <bool useAlpha>
+    void differencesImpl(const quint8 *reference, const quint8 *pixels, quint8 *differences, qint32 nPixels) const
+    {
+        const int maxChunkSize = 256;
+        const int labPixelSize = 4;
+
+        quint16 referenceLab[labPixelSize];
+        quint16 labPixels[maxChunkSize * labPixelSize];
+
+        const quint8 referenceOpacity = _CSTraits::opacityU8(reference);
+        const qint32 pixelSize = _CSTraits::pixelSize;
+
+        Q_ASSERT(this->toLabA16Converter());
+        this->toLabA16Converter()->transform(reference, reinterpret_cast<quint8*>(referenceLab), 1);
+
+        while (nPixels > 0) {
+            const qint32 chunkSize = qMin(nPixels, maxChunkSize);
+
+            this->toLabA16Converter()->transform(pixels, reinterpret_cast<quint8*>(labPixels), chunkSize);
+
+            for (qint32 i = 0; i < chunkSize; i++) {
+                const quint8 opacity = _CSTraits::opacityU8(pixels + i * pixelSize);
+                const quint8 *lab = reinterpret_cast<const quint8*>(labPixels + i * labPixelSize);
+
+                if (referenceOpacity == OPACITY_TRANSPARENT_U8 || opacity == OPACITY_TRANSPARENT_U8) {
+                    if (useAlpha) {
+                        const qreal alphaScale = 100.0 / 255.0;
+                        differences[i] = qRound(alphaScale * qAbs(referenceOpacity - opacity));
+                    } else {
+                        differences[i] = referenceOpacity == opacity ? 0 : 255;
+                    }
+                } else {
+                    differences[i] = useAlpha ?
+                        labDifferenceA(reinterpret_cast<const quint8*>(referenceLab), lab) :
+                        labDifference(reinterpret_cast<const quint8*>(referenceLab), lab);
+                }
+            }
+
+            pixels += chunkSize * pixelSize;
+            differences += chunkSize;
+            nPixels -= chunkSize;
+        }
+    }
 
     inline LcmsColorProfileContainer *lcmsProfile() const
     {
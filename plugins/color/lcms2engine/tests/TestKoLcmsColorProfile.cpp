@@ -7,6 +7,8 @@
 #include <cmath>
 #include <lcms2.h>
 
+#include <QVector>
+
 #include <KoColor.h>
 #include <KoColorProfile.h>
 #include <KoColorSpace.h>
@@ -103,4 +105,40 @@ void TestKoLcmsColorProfile::testProofingConversion()
     Q_ASSERT((dst[0] == alarm[0]) && (dst[1] == alarm[1]) && (dst[2] == alarm[2]));
 
 }
+
+void TestKoLcmsColorProfile::testBatchedDifferences()
+{
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+
+    // more pixels than fit into a single conversion chunk
+    const int numPixels = 600;
+    QVector<quint8> pixels(numPixels * 4);
+
+    srand(7);
+    for (int i = 0; i < pixels.size(); i++) {
+        pixels[i] = rand() % 256;
+    }
+    for (int i = 0; i < numPixels; i += 5) {
+        // every fifth pixel is fully transparent
+        pixels[i * 4 + 3] = 0;
+    }
+
+    QVector<quint8> differences(numPixels);
+
+    // an opaque and a transparent reference colors
+    for (int referenceIndex : {1, 0}) {
+        const quint8 *reference = pixels.constData() + referenceIndex * 4;
+
+        cs->differences(reference, pixels.constData(), differences.data(), numPixels);
+        for (int j = 0; j < numPixels; j++) {
+            QCOMPARE(differences[j], cs->difference(reference, pixels.constData() + j * 4));
+        }
+
+        cs->differencesA(reference, pixels.constData(), differences.data(), numPixels);
+        for (int j = 0; j < numPixels; j++) {
+            QCOMPARE(differences[j], cs->differenceA(reference, pixels.constData() + j * 4));
+        }
+    }
+}
+
 SIMPLE_TEST_MAIN(TestKoLcmsColorProfile)
@@ -6,12 +6,41 @@
  */
 #include "HistogramComputationStrokeStrategy.h"
 
+#include <algorithm>
+
 #include "KoColorSpace.h"
 
 #include "krita_utils.h"
 #include "kis_image.h"
 #include "kis_sequential_iterator.h"
 
+void HistogramPatchCache::addDirtyRect(const QRect &rect)
+{
+    QMutexLocker l(&m_mutex);
+
+    /**
+     * When the histogram is not calculated for a long time, e.g. during
+     * a long stroke, don't let the list grow infinitely
+     */
+    if (m_dirtyRects.size() >= 256) {
+        QRect boundingRect = rect;
+        Q_FOREACH (const QRect &rc, m_dirtyRects) {
+            boundingRect |= rc;
+        }
+        m_dirtyRects.clear();
+        m_dirtyRects.append(boundingRect);
+    } else {
+        m_dirtyRects.append(rect);
+    }
+}
+
+void HistogramPatchCache::clear()
+{
+    QMutexLocker l(&m_mutex);
+    m_isReset = true;
+    m_dirtyRects.clear();
+}
+
 struct HistogramComputationStrokeStrategy::Private
 {
 
@@ -25,19 +54,20 @@ struct HistogramComputationStrokeStrategy::Private
         {}
 
         QRect rectToCalculate;
-        int jobId; // id in the list of results
+        int jobId; // id of the patch in the cache
     };
 
     KisImageSP image;
-    std::vector<HistVector> results;
+    HistogramPatchCacheSP cache;
 };
 
 
-HistogramComputationStrokeStrategy::HistogramComputationStrokeStrategy(KisImageSP image)
+HistogramComputationStrokeStrategy::HistogramComputationStrokeStrategy(KisImageSP image, HistogramPatchCacheSP patchCache)
     : KisIdleTaskStrokeStrategy(QLatin1String("ComputeHistogram"), kundo2_i18n("Update histogram"))
     , m_d(new Private)
 {
     m_d->image = image;
+    m_d->cache = patchCache;
 }
 
 HistogramComputationStrokeStrategy::~HistogramComputationStrokeStrategy()
@@ -48,15 +78,50 @@ void HistogramComputationStrokeStrategy::initStrokeCallback()
 {
     KisIdleTaskStrokeStrategy::initStrokeCallback();
 
+    HistogramPatchCache &cache = *m_d->cache;
+    const QRect imageBounds = m_d->image->bounds();
+    const KoColorSpace *cs = m_d->image->projection()->colorSpace();
+
     QVector<KisStrokeJobData*> jobsData;
-    int i = 0;
-    QVector<QRect> tileRects = KritaUtils::splitRectIntoPatches(m_d->image->bounds(), KritaUtils::optimalPatchSize());
-    m_d->results.resize(tileRects.size());
 
-    Q_FOREACH (const QRect &tileRectangle, tileRects) {
-        jobsData << new HistogramComputationStrokeStrategy::Private::ProcessData(tileRectangle, i);
-        i++;
+    {
+        QMutexLocker l(&cache.m_mutex);
+
+        if (cache.m_isReset ||
+            cache.m_imageBounds != imageBounds ||
+            cache.m_colorSpace != cs) {
+
+            cache.m_imageBounds = imageBounds;
+            cache.m_colorSpace = cs;
+            cache.m_patchRects = KritaUtils::splitRectIntoPatches(imageBounds, KritaUtils::optimalPatchSize());
+            cache.m_patchBins.clear();
+            cache.m_patchBins.resize(cache.m_patchRects.size());
+            cache.m_isPatchValid.assign(cache.m_patchRects.size(), false);
+            cache.m_isReset = false;
+        } else {
+            Q_FOREACH (const QRect &dirtyRect, cache.m_dirtyRects) {
+                for (int i = 0; i < cache.m_patchRects.size(); i++) {
+                    if (cache.m_patchRects[i].intersects(dirtyRect)) {
+                        cache.m_isPatchValid[i] = false;
+                    }
+                }
+            }
+        }
+
+        cache.m_dirtyRects.clear();
+
+        /**
+         * The patches are marked as valid only when the job is completed,
+         * so the patches of a cancelled computation will be counted by the
+         * next one
+         */
+        for (int i = 0; i < cache.m_patchRects.size(); i++) {
+            if (!cache.m_isPatchValid[i]) {
+                jobsData << new HistogramComputationStrokeStrategy::Private::ProcessData(cache.m_patchRects[i], i);
+            }
+        }
     }
+
     addMutatedJobs(jobsData);
 }
 
@@ -72,11 +137,11 @@ void HistogramComputationStrokeStrategy::doStrokeCallback(KisStrokeJobData *data
     QRect calculate = d_pd->rectToCalculate;
 
     KisPaintDeviceSP m_dev = m_d->image->projection();
-    QRect imageBounds = m_d->image->bounds();
+    QRect imageBounds = m_d->cache->m_imageBounds;
 
-    const KoColorSpace *cs = m_dev->colorSpace();
-    quint32 channelCount = m_dev->channelCount();
-    quint32 pixelSize = m_dev->pixelSize();
+    const KoColorSpace *cs = m_d->cache->m_colorSpace;
+    quint32 channelCount = cs->channelCount();
+    quint32 pixelSize = cs->pixelSize();
 
     int imageSize = imageBounds.width() * imageBounds.height();
     int nSkip = 1 + (imageSize >> 20); //for speed use about 1M pixels for computing histograms
@@ -84,8 +149,14 @@ void HistogramComputationStrokeStrategy::doStrokeCallback(KisStrokeJobData *data
     if (calculate.isEmpty())
         return;
 
-    initiateVector(m_d->results[d_pd->jobId], cs);
+    HistVector &bins = m_d->cache->m_patchBins[d_pd->jobId];
+    initiateVector(bins, cs);
+    for (auto &bin : bins) {
+        std::fill(bin.begin(), bin.end(), 0);
+    }
 
+    // the skipping starts anew in every patch, so the result of
+    // the patch depends on its own pixels only
     quint32 toSkip = nSkip;
 
     KisSequentialConstIterator it(m_dev, calculate);
@@ -98,43 +169,43 @@ void HistogramComputationStrokeStrategy::doStrokeCallback(KisStrokeJobData *data
         for (int k = 0; k < numConseqPixels; ++k) {
             if (--toSkip == 0) {
                 for (int chan = 0; chan < (int)channelCount; ++chan) {
-                    m_d->results[d_pd->jobId][chan][cs->scaleToU8(pixel, chan)]++;
+                    bins[chan][cs->scaleToU8(pixel, chan)]++;
                 }
                 toSkip = nSkip;
             }
             pixel += pixelSize;
         }
     }
+
+    m_d->cache->m_isPatchValid[d_pd->jobId] = true;
 }
 
 void HistogramComputationStrokeStrategy::finishStrokeCallback()
 {
+    const HistogramPatchCache &cache = *m_d->cache;
+
     HistogramData hisData;
-    hisData.colorSpace = m_d->image->projection()->colorSpace();
+    hisData.colorSpace = cache.m_colorSpace;
 
-    if (m_d->results.size() == 1) {
-        hisData.bins = m_d->results[0];
-        Q_EMIT computationResultReady(hisData);
-    } else {
+    initiateVector(hisData.bins, hisData.colorSpace);
 
-        quint32 channelCount = m_d->image->projection()->channelCount();
+    for (int i = 0; i < (int)cache.m_patchBins.size(); i++) {
+        if (!cache.m_isPatchValid[i]) continue;
 
-        initiateVector(hisData.bins, hisData.colorSpace);
+        const HistVector &patchBins = cache.m_patchBins[i];
 
-        for (int chan = 0; chan < (int)channelCount; chan++) {
-            int bsize = hisData.bins[chan].size();
+        for (int chan = 0; chan < (int)hisData.bins.size(); chan++) {
+            std::vector<quint32> &dst = hisData.bins[chan];
+            const std::vector<quint32> &src = patchBins[chan];
 
-            for (int bi = 0; bi < bsize; bi++) {
-                hisData.bins[chan][bi] = 0;
-                for (int i = 0; i < (int)m_d->results.size(); i++) {
-                    hisData.bins[chan][bi] += m_d->results[i][chan][bi];
-                }
+            for (int bi = 0; bi < (int)dst.size(); bi++) {
+                dst[bi] += src[bi];
             }
         }
-
-        Q_EMIT computationResultReady(hisData);
     }
 
+    Q_EMIT computationResultReady(hisData);
+
     KisIdleTaskStrokeStrategy::finishStrokeCallback();
 }
 
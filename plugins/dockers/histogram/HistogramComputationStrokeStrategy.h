@@ -8,6 +8,10 @@
 #define HISTOGRAMCOMPUTATIONSTROKESTRATEGY_H
 
 #include <KisIdleTaskStrokeStrategy.h>
+#include <QMutex>
+#include <QRect>
+#include <QSharedPointer>
+#include <QVector>
 #include <vector>
 
 class KoColorSpace;
@@ -23,11 +27,46 @@ struct HistogramData
 Q_DECLARE_METATYPE(HistogramData)
 
 
+/**
+ * The partial histograms of the patches of the image projection. The
+ * docker keeps the cache between the runs of the computation, so only
+ * the patches touched by the updates of the projection are counted again.
+ *
+ * The dirty rects may be added from any thread, the patches are used
+ * by one computation at a time.
+ */
+class HistogramPatchCache
+{
+public:
+    void addDirtyRect(const QRect &rect);
+
+    /**
+     * Make the next computation count all the patches again
+     */
+    void clear();
+
+private:
+    friend class HistogramComputationStrokeStrategy;
+
+    QMutex m_mutex;
+    bool m_isReset {true};
+    QVector<QRect> m_dirtyRects;
+
+    QRect m_imageBounds;
+    const KoColorSpace *m_colorSpace {0};
+    QVector<QRect> m_patchRects;
+    std::vector<HistVector> m_patchBins;
+    std::vector<char> m_isPatchValid;
+};
+
+using HistogramPatchCacheSP = QSharedPointer<HistogramPatchCache>;
+
+
 class HistogramComputationStrokeStrategy : public KisIdleTaskStrokeStrategy
 {
     Q_OBJECT
 public:
-    HistogramComputationStrokeStrategy(KisImageSP image);
+    HistogramComputationStrokeStrategy(KisImageSP image, HistogramPatchCacheSP patchCache);
     ~HistogramComputationStrokeStrategy() override;
 
 private:
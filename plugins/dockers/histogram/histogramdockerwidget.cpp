@@ -23,6 +23,7 @@
 
 HistogramDockerWidget::HistogramDockerWidget(QWidget *parent, const char *name, Qt::WindowFlags f)
     : KisWidgetWithIdleTask<QLabel>(parent, f)
+    , m_patchCache(new HistogramPatchCache)
 {
     setObjectName(name);
     qRegisterMetaType<HistogramData>();
@@ -32,6 +33,28 @@ HistogramDockerWidget::~HistogramDockerWidget()
 {
 }
 
+void HistogramDockerWidget::setCanvas(KisCanvas2 *canvas)
+{
+    if (m_image) {
+        m_image->disconnect(this);
+    }
+
+    KisWidgetWithIdleTask<QLabel>::setCanvas(canvas);
+
+    m_image = canvas ? canvas->image() : KisImageWSP();
+
+    if (m_image) {
+        // the signal is emitted by the threads of the updates scheduler
+        connect(m_image.data(), SIGNAL(sigImageUpdated(QRect)),
+                this, SLOT(slotImageUpdated(QRect)), Qt::DirectConnection);
+    }
+}
+
+void HistogramDockerWidget::slotImageUpdated(const QRect &rect)
+{
+    m_patchCache->addDirtyRect(rect);
+}
+
 void HistogramDockerWidget::receiveNewHistogram(HistogramData data)
 {
     m_histogramData = data.bins;
@@ -47,7 +70,7 @@ KisIdleTasksManager::TaskGuard HistogramDockerWidget::registerIdleTask(KisCanvas
         canvas->viewManager()->idleTasksManager()->
         addIdleTaskWithGuard([this](KisImageSP image) {
             HistogramComputationStrokeStrategy* strategy =
-                new HistogramComputationStrokeStrategy(image);
+                new HistogramComputationStrokeStrategy(image, m_patchCache);
 
             connect(strategy, SIGNAL(computationResultReady(HistogramData)), this, SLOT(receiveNewHistogram(HistogramData)));
 
@@ -59,6 +82,7 @@ void HistogramDockerWidget::clearCachedState()
 {
     m_colorSpace = 0;
     m_histogramData.clear();
+    m_patchCache->clear();
 }
 
 void HistogramDockerWidget::paintEvent(QPaintEvent *event)
@@ -14,6 +14,7 @@
 #include <QThread>
 #include "HistogramComputationStrokeStrategy.h"
 #include "KisWidgetWithIdleTask.h"
+#include <kis_types.h>
 
 class KoColorSpace;
 
@@ -26,14 +27,21 @@ public:
     ~HistogramDockerWidget() override;
     void paintEvent(QPaintEvent *event) override;
 
+    void setCanvas(KisCanvas2 *canvas) override;
+
 public Q_SLOTS:
     void receiveNewHistogram(HistogramData data);
 
+private Q_SLOTS:
+    void slotImageUpdated(const QRect &rect);
+
 private:
     KisIdleTasksManager::TaskGuard registerIdleTask(KisCanvas2 *canvas) override;
     void clearCachedState() override;
 
 private:
+    KisImageWSP m_image;
+    HistogramPatchCacheSP m_patchCache;
     HistVector m_histogramData;
     const KoColorSpace* m_colorSpace {0};
     bool m_smoothHistogram {false};
@@ -13,6 +13,7 @@
 #include <QStandardPaths>
 #include <QDateTime>
 #include <QCheckBox>
+#include <QMessageBox>
 
 #include <klocalizedstring.h>
 #include <ksharedconfig.h>
@@ -28,6 +29,7 @@
 #include "KisViewManager.h"
 #include "KisMainWindow.h"
 #include "kis_config.h"
+#include "KisTraceRecorder.h"
 
 MessageSender *LogDockerDock::s_messageSender {new MessageSender()};
 QTextCharFormat LogDockerDock::s_debug;
@@ -56,6 +58,9 @@ LogDockerDock::LogDockerDock( )
     bnSave->setIcon(koIcon("document-save-16"));
     connect(bnSave, SIGNAL(clicked(bool)), SLOT(saveLog()));
 
+    bnTrace->setIcon(koIcon("media-record"));
+    connect(bnTrace, SIGNAL(clicked(bool)), SLOT(toggleTracing(bool)));
+
     bnSettings->setIcon(koIcon("configure-thicker"));
     connect(bnSettings, SIGNAL(clicked(bool)), SLOT(settings()));
 
@@ -110,6 +115,25 @@ void LogDockerDock::saveLog()
     }
 }
 
+void LogDockerDock::toggleTracing(bool toggle)
+{
+    KisTraceRecorder::instance()->setEnabled(toggle);
+
+    if (toggle || !KisTraceRecorder::instance()->numEvents()) return;
+
+    KoFileDialog fileDialog(this, KoFileDialog::SaveFile, "tracefile");
+    fileDialog.setDefaultDir(QStandardPaths::writableLocation(QStandardPaths::DesktopLocation) + "/" + QString("krita_%1.json").arg(QDateTime::currentDateTime().toString("yyyy-MM-ddThh-mm")));
+    QString filename = fileDialog.filename();
+    if (!filename.isEmpty() &&
+        !KisTraceRecorder::instance()->saveChromeTrace(filename)) {
+
+        QMessageBox::warning(this, i18nc("@title:window", "Krita"),
+                             i18n("Could not save the trace to %1.", filename));
+    }
+
+    KisTraceRecorder::instance()->clear();
+}
+
 void LogDockerDock::settings()
 {
     KoDialog dlg(this);
@@ -42,6 +42,7 @@ private Q_SLOTS:
     void toggleLogging(bool toggle);
     void clearLog();
     void saveLog();
+    void toggleTracing(bool toggle);
     void settings();
     void insertMessage(QtMsgType type, const QString &msg);
     void changeTheme();
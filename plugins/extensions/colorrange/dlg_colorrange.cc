@@ -39,7 +39,8 @@
 #include <KisViewManager.h>
 #include <kis_transaction.h>
 #include <kis_cursor.h>
-#include "kis_iterator_ng.h"
+#include "kis_sequential_iterator.h"
+#include "krita_utils.h"
 #include "kis_selection_tool_helper.h"
 #include <kis_slider_spin_box.h>
 #include <KisCursorOverrideLock.h>
@@ -188,22 +189,51 @@ void DlgColorRange::slotSelectClicked()
     KisSelectionSP selection = new KisSelection(new KisSelectionDefaultBounds(m_viewManager->activeDevice()),
                                                 toQShared(new KisImageResolutionProxy(m_viewManager->image())));
 
-    KisHLineConstIteratorSP hiter = m_viewManager->activeDevice()->createHLineConstIteratorNG(x, y, w);
-    KisHLineIteratorSP selIter = selection->pixelSelection()->createHLineIteratorNG(x, y, w);
+    KisPixelSelectionSP pixelSelection = selection->pixelSelection();
 
-    for (int row = y; row < h - y; ++row) {
-        do {
-            // Don't try to select transparent pixels.
-            if (cs->opacityU8(hiter->oldRawData()) >  OPACITY_TRANSPARENT_U8) {
+    // the value written into the matching pixels, the rest are left untouched
+    const quint8 selectedValue = (m_mode == SELECTION_ADD) != m_invert ? MAX_SELECTED : MIN_SELECTED;
+    const enumAction currentAction = m_currentAction;
+
+    /**
+     * The pixels are processed in patches concurrently, and the runs of
+     * consequent pixels are converted (or compared) by the color space
+     * in one go
+     */
+    const QVector<QRect> patches = KritaUtils::splitRectIntoPatches(QRect(x, y, w, h), KritaUtils::optimalPatchSize());
+
+    KritaUtils::processConcurrently(patches.size(), [&] (int index) {
+        const QRect patch = patches[index];
+
+        QVector<quint8> differences(patch.width());
+        QVector<quint16> labPixels(patch.width() * 4);
+
+        KisSequentialConstIterator srcIt(device, patch);
+        KisSequentialIterator selIt(pixelSelection, patch);
+
+        int numConseqPixels = qMin(srcIt.nConseqPixels(), selIt.nConseqPixels());
+        while (srcIt.nextPixels(numConseqPixels) && selIt.nextPixels(numConseqPixels)) {
+            numConseqPixels = qMin(srcIt.nConseqPixels(), selIt.nConseqPixels());
+
+            const quint8 *srcPtr = srcIt.oldRawData();
+            quint8 *selPtr = selIt.rawData();
+
+            if (currentAction > MAGENTAS) {
+                cs->toLabA16(srcPtr, reinterpret_cast<quint8*>(labPixels.data()), numConseqPixels);
+            } else {
+                cs->differences(match.data(), srcPtr, differences.data(), numConseqPixels);
+            }
+
+            for (int i = 0; i < numConseqPixels; i++) {
+                // Don't try to select transparent pixels.
+                if (cs->opacityU8(srcPtr + i * cs->pixelSize()) == OPACITY_TRANSPARENT_U8) continue;
 
                 bool selected = false;
 
-                KoColor c(hiter->oldRawData(), cs);
-                if (m_currentAction > MAGENTAS) {
-                    c.convertTo(lab);
-                    quint8 L = lab->scaleToU8(c.data(), 0);
+                if (currentAction > MAGENTAS) {
+                    quint8 L = lab->scaleToU8(reinterpret_cast<const quint8*>(labPixels.constData() + i * 4), 0);
 
-                    switch (m_currentAction) {
+                    switch (currentAction) {
                     case HIGHLIGHTS:
                         selected = (L > MAX_SELECTED - fuzziness);
                         break;
@@ -218,34 +248,19 @@ void DlgColorRange::slotSelectClicked()
                     }
                 }
                 else {
-                    quint8 difference = cs->difference(match.data(), c.data());
-                    selected = (difference <= fuzziness);
+                    selected = (differences[i] <= fuzziness);
                 }
 
                 if (selected) {
-                    if (!m_invert) {
-                        if (m_mode == SELECTION_ADD) {
-                            *(selIter->rawData()) =  MAX_SELECTED;
-                        } else if (m_mode == SELECTION_SUBTRACT) {
-                            *(selIter->rawData()) = MIN_SELECTED;
-                        }
-                    } else {
-                        if (m_mode == SELECTION_ADD) {
-                            *(selIter->rawData()) = MIN_SELECTED;
-                        } else if (m_mode == SELECTION_SUBTRACT) {
-                            *(selIter->rawData()) =  MAX_SELECTED;
-                        }
-                    }
+                    selPtr[i] = selectedValue;
                 }
             }
-        } while (hiter->nextPixel() && selIter->nextPixel());
-        hiter->nextRow();
-        selIter->nextRow();
-    }
+        }
+    });
 
-    selection->pixelSelection()->invalidateOutlineCache();
+    pixelSelection->invalidateOutlineCache();
     KisSelectionToolHelper helper(m_viewManager->canvasBase(), kundo2_i18n("Color Range Selection"));
-    helper.selectPixelSelection(selection->pixelSelection(), m_mode);
+    helper.selectPixelSelection(pixelSelection, m_mode);
 
     m_page->bnDeselect->setEnabled(true);
     m_selectionCommandsAdded++;
@@ -29,6 +29,7 @@ KisBlurFilter::KisBlurFilter() : KisFilter(id(), FiltersCategoryBlurId, i18n("&B
     setSupportsPainting(true);
     setSupportsAdjustmentLayers(true);
     setSupportsLevelOfDetail(true);
+    setSupportsStreaming(true);
     setColorSpaceIndependence(FULLY_INDEPENDENT);
 }
 
@@ -0,0 +1,110 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_CIRCULAR_IRIS_KERNEL_H
+#define __KIS_CIRCULAR_IRIS_KERNEL_H
+
+#include <QVector>
+#include <QtMath>
+
+#include <Eigen/Core>
+
+#include <kis_global.h>
+
+#include <complex>
+
+/**
+ * A disc-shaped kernel is approximated by a weighted sum of the
+ * components, each of them being a product of two one-dimensional
+ * complex kernels:
+ *
+ *   f(x) = exp(-a * x^2) * (cos(b * x^2) + i * sin(b * x^2))
+ *   disc(x, y) ~= sum(A * Re(f(x) * f(y)) + B * Im(f(x) * f(y)))
+ *
+ * where x and y are normalized by the radius of the disc. The
+ * coefficients are taken from Olli Niemitalo's "Circularly symmetric
+ * convolution and lens blur" (2018). Every component is separable, so the
+ * cost per pixel is linear to the radius instead of being quadratic.
+ */
+namespace KisCircularIrisKernel {
+
+typedef std::complex<qreal> complex;
+
+struct Component {
+    qreal a;
+    qreal b;
+    qreal A;
+    qreal B;
+};
+
+const Component components[] = {
+    {0.886528, 5.268909, 0.411259, -0.548794},
+    {1.960518, 1.558213, 0.513282, 4.561110}
+};
+
+const int numComponents = sizeof(components) / sizeof(Component);
+
+/**
+ * The components don't fade out at the edge of the disc, they
+ * cancel each other there, so the kernels should be a bit wider
+ * than the disc itself.
+ */
+const qreal kernelExtent = 1.2;
+
+inline int halfSize(qreal radius)
+{
+    return qCeil(kernelExtent * radius);
+}
+
+/**
+ * @return the one-dimensional kernel of the component \p index,
+ *         its size is 2 * halfSize(radius) + 1
+ */
+inline QVector<complex> componentKernel(int index, qreal radius)
+{
+    const Component &c = components[index];
+    const int half = halfSize(radius);
+
+    QVector<complex> kernel(2 * half + 1);
+
+    for (int t = -half; t <= half; t++) {
+        const qreal x2 = pow2(t / radius);
+        kernel[t + half] = std::exp(-c.a * x2) * complex(std::cos(c.b * x2), std::sin(c.b * x2));
+    }
+
+    return kernel;
+}
+
+/**
+ * @return the non-normalized two-dimensional kernel the separable
+ *         components sum up to. It is not used for filtering, only
+ *         as a reference for the separable implementation.
+ */
+inline Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> fullKernel(qreal radius)
+{
+    const int size = 2 * halfSize(radius) + 1;
+
+    Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> result(size, size);
+    result.setZero();
+
+    for (int k = 0; k < numComponents; k++) {
+        const Component &c = components[k];
+        const QVector<complex> kernel = componentKernel(k, radius);
+
+        for (int y = 0; y < size; y++) {
+            for (int x = 0; x < size; x++) {
+                const complex value = kernel[x] * kernel[y];
+                result(y, x) += c.A * value.real() + c.B * value.imag();
+            }
+        }
+    }
+
+    return result;
+}
+
+}
+
+#endif /* __KIS_CIRCULAR_IRIS_KERNEL_H */
@@ -34,6 +34,7 @@ KisGaussianBlurFilter::KisGaussianBlurFilter() : KisFilter(id(), FiltersCategory
     setSupportsPainting(true);
     setSupportsAdjustmentLayers(true);
     setSupportsLevelOfDetail(true);
+    setSupportsStreaming(true);
     setColorSpaceIndependence(FULLY_INDEPENDENT);
 }
 
@@ -9,6 +9,7 @@
 
 #include "kis_lens_blur_filter.h"
 #include "kis_wdg_lens_blur.h"
+#include "kis_circular_iris_kernel.h"
 
 #include <KoCompositeOp.h>
 
@@ -26,7 +27,18 @@
 
 
 #include <QPainter>
-
+#include <QtMath>
+
+#include <KoChannelInfo.h>
+#include <KoUpdater.h>
+#include <kis_datamanager.h>
+#include <kis_global.h>
+#include <kis_default_bounds.h>
+#include <kis_iterator_ng.h>
+#include <kis_repeat_iterators_pixel.h>
+
+#include <limits>
+#include <numeric>
 #include <math.h>
 
 
@@ -44,8 +56,28 @@ KisConfigWidget * KisLensBlurFilter::createConfigurationWidget(QWidget* parent,
     return new KisWdgLensBlur(parent);
 }
 
+qreal KisLensBlurFilter::getCircularIrisRadius(const KisFilterConfigurationSP config, int lod)
+{
+    KIS_ASSERT_RECOVER(config) { return 0.0; }
+
+    KisLodTransformScalar t(lod);
+
+    QVariant value;
+    config->getProperty("irisShape", value);
+    if (value.toString() != "Circle") return 0.0;
+
+    config->getProperty("irisRadius", value);
+    return t.scale(value.toUInt());
+}
+
 QSize KisLensBlurFilter::getKernelHalfSize(const KisFilterConfigurationSP config, int lod)
 {
+    const qreal circularRadius = getCircularIrisRadius(config, lod);
+    if (circularRadius > 0.0) {
+        const int halfSize = KisCircularIrisKernel::halfSize(circularRadius);
+        return QSize(halfSize, halfSize);
+    }
+
     QPolygonF iris = getIrisPolygon(config, lod);
     QRect rect = iris.boundingRect().toAlignedRect();
 
@@ -130,6 +162,18 @@ void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
     }
 
     const int lod = device->defaultBounds()->currentLevelOfDetail();
+
+    const qreal circularRadius = getCircularIrisRadius(config, lod);
+    if (circularRadius >= 1.0) {
+        applyCircularIris(device, rect, circularRadius, channelFlags, progressUpdater);
+        return;
+    }
+
+    /**
+     * Polygonal irises are not separable, so they are convolved
+     * directly. KisConvolutionPainter switches to the FFT engine
+     * for such big kernels.
+     */
     QPolygonF transformedIris = getIrisPolygon(config, lod);
     if (transformedIris.isEmpty()) return;
 
@@ -167,6 +211,210 @@ void KisLensBlurFilter::processImpl(KisPaintDeviceSP device,
     painter.applyMatrix(kernel, device, srcTopLeft, srcTopLeft, rect.size(), BORDER_REPEAT);
 }
 
+void KisLensBlurFilter::applyCircularIris(KisPaintDeviceSP device, const QRect &rect,
+                                          qreal radius, const QBitArray &channelFlags,
+                                          KoUpdater *progressUpdater)
+{
+    const KoColorSpace *cs = device->colorSpace();
+    const int numChannels = cs->channelCount();
+
+    const int halfSize = KisCircularIrisKernel::halfSize(radius);
+    const int kernelSize = 2 * halfSize + 1;
+
+    using KisCircularIrisKernel::complex;
+    using KisCircularIrisKernel::numComponents;
+
+    // the kernels are symmetric, so convolution is the same as correlation
+    QVector<complex> kernels;
+    qreal normalizationFactor = 0.0;
+
+    for (int k = 0; k < numComponents; k++) {
+        const KisCircularIrisKernel::Component &c = KisCircularIrisKernel::components[k];
+        const QVector<complex> kernel = KisCircularIrisKernel::componentKernel(k, radius);
+
+        const complex sum = std::accumulate(kernel.begin(), kernel.end(), complex(0.0));
+        kernels.append(kernel);
+
+        // the sum of the 2D kernel is the square of the sum of the 1D one
+        const complex sum2D = sum * sum;
+        normalizationFactor += c.A * sum2D.real() + c.B * sum2D.imag();
+    }
+
+    KIS_SAFE_ASSERT_RECOVER_RETURN(normalizationFactor > 0.0);
+
+    /**
+     * Normalized channel values go in the order of the pixel
+     * layout, while channel flags go in the order of channels()
+     */
+    QVector<bool> processChannel(numChannels, channelFlags.isEmpty());
+    {
+        const QList<KoChannelInfo *> channels = cs->channels();
+        for (int i = 0; i < channels.size() && i < channelFlags.size(); i++) {
+            processChannel[channels[i]->pos() / channels[i]->size()] = channelFlags.testBit(i);
+        }
+    }
+
+    const int alphaPos = cs->alphaPos();
+    const bool premultiply = alphaPos >= 0 && processChannel[alphaPos];
+
+    /**
+     * We read the neighbourhood of every pixel with oldRawData(), so
+     * without a transaction on the device we should read from a copy
+     * of it, otherwise the already processed pixels would be read back.
+     */
+    KisPaintDeviceSP src = device;
+    if (!device->dataManager()->hasCurrentMemento()) {
+        src = new KisPaintDevice(*device);
+    }
+
+    // the same logic as in KisConvolutionPainter::applyMatrix()
+    const bool useRepeatIterators = !src->defaultBounds()->wrapAroundMode();
+    QRect dataRect = rect | src->defaultBounds()->bounds();
+    if (src->defaultBounds()->bounds() == KisDefaultBounds().bounds()) {
+        dataRect = rect | src->exactBounds();
+    }
+
+    /**
+     * The rect is processed in blocks to keep the memory usage bounded
+     */
+    const int blockSize = qMax(256, 2 * halfSize);
+
+    const int numBlocks =
+        ((rect.width() + blockSize - 1) / blockSize) *
+        ((rect.height() + blockSize - 1) / blockSize);
+    int currentBlock = 0;
+
+    QVector<float> normalizedPixel(numChannels);
+    QVector<qreal> srcBlock;
+    QVector<complex> horizontalBlock;
+    QVector<complex> verticalValues(numChannels);
+    QVector<qreal> result;
+
+    for (int blockY = rect.y(); blockY <= rect.bottom(); blockY += blockSize) {
+        for (int blockX = rect.x(); blockX <= rect.right(); blockX += blockSize) {
+            const int width = qMin(blockSize, rect.right() - blockX + 1);
+            const int height = qMin(blockSize, rect.bottom() - blockY + 1);
+
+            const int srcWidth = width + 2 * halfSize;
+            const int srcHeight = height + 2 * halfSize;
+
+            srcBlock.resize(srcWidth * srcHeight * numChannels);
+
+            auto readSource = [&] (auto srcIt) {
+                qreal *dstPtr = srcBlock.data();
+
+                for (int y = 0; y < srcHeight; y++) {
+                    for (int x = 0; x < srcWidth; x++) {
+                        cs->normalisedChannelsValue(srcIt->oldRawData(), normalizedPixel);
+
+                        const qreal alpha = premultiply ? normalizedPixel[alphaPos] : 1.0;
+
+                        for (int i = 0; i < numChannels; i++) {
+                            *dstPtr++ = i != alphaPos ? normalizedPixel[i] * alpha : normalizedPixel[i];
+                        }
+
+                        srcIt->nextPixel();
+                    }
+                    srcIt->nextRow();
+                }
+            };
+
+            if (useRepeatIterators) {
+                readSource(src->createRepeatHLineConstIterator(blockX - halfSize, blockY - halfSize, srcWidth, dataRect));
+            } else {
+                readSource(src->createHLineConstIteratorNG(blockX - halfSize, blockY - halfSize, srcWidth));
+            }
+
+            result.fill(0.0, width * height * numChannels);
+            horizontalBlock.resize(srcHeight * width * numChannels);
+
+            for (int k = 0; k < numComponents; k++) {
+                const complex *kernel = kernels.constData() + k * kernelSize;
+
+                horizontalBlock.fill(0.0);
+
+                for (int y = 0; y < srcHeight; y++) {
+                    for (int x = 0; x < width; x++) {
+                        complex *dstPtr = horizontalBlock.data() + (y * width + x) * numChannels;
+                        const qreal *srcPtr = srcBlock.constData() + (y * srcWidth + x) * numChannels;
+
+                        for (int t = 0; t < kernelSize; t++) {
+                            for (int i = 0; i < numChannels; i++) {
+                                dstPtr[i] += srcPtr[i] * kernel[t];
+                            }
+                            srcPtr += numChannels;
+                        }
+                    }
+                }
+
+                const KisCircularIrisKernel::Component &c = KisCircularIrisKernel::components[k];
+
+                for (int y = 0; y < height; y++) {
+                    for (int x = 0; x < width; x++) {
+                        verticalValues.fill(0.0);
+
+                        const complex *srcPtr = horizontalBlock.constData() + (y * width + x) * numChannels;
+
+                        for (int t = 0; t < kernelSize; t++) {
+                            for (int i = 0; i < numChannels; i++) {
+                                verticalValues[i] += srcPtr[i] * kernel[t];
+                            }
+                            srcPtr += width * numChannels;
+                        }
+
+                        qreal *dstPtr = result.data() + (y * width + x) * numChannels;
+
+                        for (int i = 0; i < numChannels; i++) {
+                            dstPtr[i] += c.A * verticalValues[i].real() + c.B * verticalValues[i].imag();
+                        }
+                    }
+                }
+            }
+
+            KisHLineIteratorSP dstIt = device->createHLineIteratorNG(blockX, blockY, width);
+            const qreal *resultPtr = result.constData();
+
+            for (int y = 0; y < height; y++) {
+                for (int x = 0; x < width; x++) {
+                    quint8 *dstPixel = dstIt->rawData();
+                    cs->normalisedChannelsValue(dstPixel, normalizedPixel);
+
+                    qreal alphaMultiplier = 1.0;
+
+                    if (premultiply) {
+                        const qreal alpha = qBound(0.0, resultPtr[alphaPos] / normalizationFactor, 1.0);
+                        normalizedPixel[alphaPos] = alpha;
+                        alphaMultiplier = alpha > std::numeric_limits<float>::epsilon() ? 1.0 / alpha : 0.0;
+                    }
+
+                    for (int i = 0; i < numChannels; i++) {
+                        if (i == alphaPos || !processChannel[i]) continue;
+
+                        // the approximation has some ringing, which may give negative values
+                        normalizedPixel[i] = qMax(0.0, resultPtr[i] / normalizationFactor * alphaMultiplier);
+                    }
+
+                    if (!premultiply && alphaPos >= 0 && processChannel[alphaPos]) {
+                        normalizedPixel[alphaPos] = qBound(0.0, resultPtr[alphaPos] / normalizationFactor, 1.0);
+                    }
+
+                    cs->fromNormalisedChannelsValue(dstPixel, normalizedPixel);
+
+                    resultPtr += numChannels;
+                    dstIt->nextPixel();
+                }
+                dstIt->nextRow();
+            }
+
+            currentBlock++;
+            if (progressUpdater) {
+                progressUpdater->setProgress(100 * currentBlock / numBlocks);
+                if (progressUpdater->interrupted()) return;
+            }
+        }
+    }
+}
+
 QRect KisLensBlurFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int lod) const
 {
     KisLodTransformScalar t(lod);
@@ -42,6 +42,16 @@ public:
 
 private:
     static QPolygonF getIrisPolygon(const KisFilterConfigurationSP config, int lod);
+
+    /**
+     * @return the radius of the circular iris or zero if the iris
+     *         in \p config is a polygon
+     */
+    static qreal getCircularIrisRadius(const KisFilterConfigurationSP config, int lod);
+
+    static void applyCircularIris(KisPaintDeviceSP device, const QRect &rect,
+                                  qreal radius, const QBitArray &channelFlags,
+                                  KoUpdater *progressUpdater);
 };
 
 #endif
@@ -36,6 +36,7 @@ KisWdgLensBlur::KisWdgLensBlur(QWidget * parent) : KisConfigWidget(parent)
     m_shapeTranslations[i18n("Hexagon (6)")] = "Hexagon (6)";
     m_shapeTranslations[i18n("Heptagon (7)")] = "Heptagon (7)";
     m_shapeTranslations[i18n("Octagon (8)")] = "Octagon (8)";
+    m_shapeTranslations[i18n("Circle")] = "Circle";
 
     connect(m_widget->irisShapeCombo, SIGNAL(currentIndexChanged(int)), SIGNAL(sigConfigurationItemChanged()));
     connect(m_widget->irisRadiusSlider, SIGNAL(valueChanged(int)), SIGNAL(sigConfigurationItemChanged()));
@@ -0,0 +1,113 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "kis_lens_blur_filter_test.h"
+
+#include <simpletest.h>
+
+#include <QPainter>
+
+#include "kis_transaction.h"
+#include "kis_convolution_kernel.h"
+#include "kis_convolution_painter.h"
+#include "filter/kis_filter.h"
+#include "filter/kis_filter_configuration.h"
+#include "filter/kis_filter_registry.h"
+#include <KisGlobalResourcesInterface.h>
+#include <KoColorSpaceRegistry.h>
+#include "testutil.h"
+#include "testing_timed_default_bounds.h"
+
+#include "../kis_circular_iris_kernel.h"
+
+void KisLensBlurFilterTest::testCircularIris_data()
+{
+    QTest::addColumn<int>("radius");
+    QTest::addColumn<QRect>("processRect");
+    QTest::addColumn<bool>("skipGreenChannel");
+
+    // the rect spans several processing blocks of 256 pixels
+    QTest::newRow("r4") << 4 << QRect(10, 5, 300, 40) << false;
+    QTest::newRow("r9") << 9 << QRect(10, 5, 300, 40) << false;
+    QTest::newRow("r4-flags") << 4 << QRect(0, 0, 64, 48) << true;
+}
+
+void KisLensBlurFilterTest::testCircularIris()
+{
+    QFETCH(int, radius);
+    QFETCH(QRect, processRect);
+    QFETCH(bool, skipGreenChannel);
+
+    const KoColorSpace *cs = KoColorSpaceRegistry::instance()->rgb8();
+    const QRect imageRect(0, 0, 320, 64);
+
+    /**
+     * The colors are kept away from 0 and 255, so the ringing of the
+     * approximation is not clamped in either of the implementations
+     */
+    QImage srcImage(imageRect.size(), QImage::Format_ARGB32);
+    srcImage.fill(QColor(30, 60, 90));
+    {
+        QPainter gc(&srcImage);
+        for (int x = 0; x < imageRect.width(); x += 16) {
+            gc.fillRect(QRect(x, 0, 8, imageRect.height()), QColor(120, 40, 200));
+        }
+        gc.fillRect(QRect(20, 20, 24, 24), QColor(220, 210, 50));
+        gc.fillRect(QRect(250, 10, 40, 30), QColor(200, 220, 210));
+    }
+
+    KisPaintDeviceSP dev = new KisPaintDevice(cs);
+    dev->setDefaultBounds(new TestUtil::TestingTimedDefaultBounds(imageRect));
+    dev->convertFromQImage(srcImage, 0, 0, 0);
+
+    KisPaintDeviceSP src = new KisPaintDevice(*dev);
+    KisPaintDeviceSP ref = new KisPaintDevice(*dev);
+
+    QBitArray channelFlags(cs->channelCount(), true);
+    if (skipGreenChannel) {
+        channelFlags.clearBit(1);
+    }
+
+    KisFilterSP f = KisFilterRegistry::instance()->value("lens blur");
+    QVERIFY(f);
+
+    KisFilterConfigurationSP kfc = f->defaultConfiguration(KisGlobalResourcesInterface::instance());
+    QVERIFY(kfc);
+
+    const int halfSize = KisCircularIrisKernel::halfSize(radius);
+
+    kfc->setProperty("irisShape", "Circle");
+    kfc->setProperty("irisRadius", radius);
+    kfc->setProperty("halfWidth", halfSize);
+    kfc->setProperty("halfHeight", halfSize);
+    kfc->setChannelFlags(channelFlags);
+
+    KisTransaction t(dev);
+    f->process(dev, processRect, kfc->cloneWithResourcesSnapshot());
+    t.end();
+
+    // the separable components should sum up to the full 2D kernel
+    const Eigen::Matrix<qreal, Eigen::Dynamic, Eigen::Dynamic> fullKernel =
+        KisCircularIrisKernel::fullKernel(radius);
+
+    KisConvolutionKernelSP kernel = KisConvolutionKernel::fromMatrix(fullKernel, 0, fullKernel.sum());
+
+    KisConvolutionPainter painter(ref);
+    painter.setChannelFlags(channelFlags);
+    painter.applyMatrix(kernel, src, processRect.topLeft(), processRect.topLeft(),
+                        processRect.size(), BORDER_REPEAT);
+
+    const QImage result = dev->convertToQImage(0, imageRect);
+    const QImage expected = ref->convertToQImage(0, imageRect);
+
+    QPoint pt;
+    if (!TestUtil::compareQImages(pt, result, expected, 1, 1)) {
+        QFAIL(QString("Circular iris differs from the full kernel at point (%1, %2)")
+              .arg(pt.x()).arg(pt.y()).toLatin1());
+    }
+}
+
+SIMPLE_TEST_MAIN(KisLensBlurFilterTest)
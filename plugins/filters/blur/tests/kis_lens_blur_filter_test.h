@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef __KIS_LENS_BLUR_FILTER_TEST_H
+#define __KIS_LENS_BLUR_FILTER_TEST_H
+
+#include <simpletest.h>
+
+class KisLensBlurFilterTest : public QObject
+{
+    Q_OBJECT
+private Q_SLOTS:
+    void testCircularIris_data();
+    void testCircularIris();
+};
+
+#endif /* __KIS_LENS_BLUR_FILTER_TEST_H */
@@ -26,6 +26,7 @@ KisConvolutionFilter::KisConvolutionFilter(const KoID& id, const KoID & category
 {
     setColorSpaceIndependence(FULLY_INDEPENDENT);
     setSupportsLevelOfDetail(true);
+    setSupportsStreaming(true);
 }
 
 
@@ -15,6 +15,7 @@
 
 #include <stdlib.h>
 #include <vector>
+#include <algorithm>
 
 #include <QPoint>
 #include <QSpinBox>
@@ -28,7 +29,6 @@
 
 #include <KisDocument.h>
 #include <kis_image.h>
-#include <KisSequentialIteratorProgress.h>
 #include <kis_layer.h>
 #include <filter/kis_filter_registry.h>
 #include <kis_global.h>
@@ -37,6 +37,8 @@
 #include <filter/kis_filter_configuration.h>
 #include <kis_processing_information.h>
 #include <kis_paint_device.h>
+#include <kis_datamanager.h>
+#include <KisSlidingWindowHistogram.h>
 #include "widgets/kis_multi_integer_filter_widget.h"
 #include <KisGlobalResourcesInterface.h>
 
@@ -44,7 +46,7 @@
 KisOilPaintFilter::KisOilPaintFilter() : KisFilter(id(), FiltersCategoryArtisticId, i18n("&Oilpaint..."))
 {
     setSupportsPainting(true);
-    setSupportsThreading(false);
+    setSupportsThreading(true);
     setSupportsAdjustmentLayers(true);
 }
 
@@ -60,7 +62,17 @@ void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
     const quint32 brushSize = config ? config->getInt("brushSize", 1) : 1;
     const quint32 smooth = config ? config->getInt("smooth", 30) : 30;
 
-    OilPaint(device, device, applyRect, brushSize, smooth, progressUpdater);
+    /**
+     * The filter reads the neighbourhood of every pixel with oldRawData(),
+     * so without a transaction on the device we should read from a copy
+     * of it, otherwise the already processed pixels would be read back.
+     */
+    KisPaintDeviceSP src = device;
+    if (!device->dataManager()->hasCurrentMemento()) {
+        src = new KisPaintDevice(*device);
+    }
+
+    OilPaint(src, device, applyRect, brushSize, smooth, progressUpdater);
 }
 
 // This method have been ported from Pieter Z. Voloshyn algorithm code.
@@ -80,98 +92,63 @@ void KisOilPaintFilter::processImpl(KisPaintDeviceSP device,
 void KisOilPaintFilter::OilPaint(const KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
                                  int BrushSize, int Smoothness, KoUpdater* progressUpdater) const
 {
-    KisSequentialConstIteratorProgress it(src, applyRect, progressUpdater);
-    KisSequentialIterator dstIt(dst, applyRect);
-
-    while (it.nextPixel() && dstIt.nextPixel()) {
-        MostFrequentColor(src, dstIt.rawData(), applyRect, it.x(), it.y(), BrushSize, Smoothness);
-    }
-}
-
-// This method has been ported from Pieter Z. Voloshyn's algorithm code in Digikam.
-
-/* Function to determine the most frequent color in a matrix
- *
- * Bits             => Bits array
- * Width            => Image width
- * Height           => Image height
- * X                => Position horizontal
- * Y                => Position vertical
- * Radius           => Is the radius of the matrix to be analyzed
- * Intensity        => Intensity to calculate
- *
- * Theory           => This function creates a matrix with the analyzed pixel in
- *                     the center of this matrix and find the most frequent color
- */
-
-void KisOilPaintFilter::MostFrequentColor(KisPaintDeviceSP src, quint8* dst, const QRect& /*bounds*/, int X, int Y, int Radius, int Intensity) const
-{
-    uint I;
-
-    double Scale = Intensity / 255.0;
-
-    // Alloc some arrays to be used
-    uchar *IntensityCount = new uchar[(Intensity + 1)];
-
     const KoColorSpace* cs = src->colorSpace();
 
+    const double Scale = Smoothness / 255.0;
     QVector<float> channel(cs->channelCount());
-    QVector<float>* AverageChannels = new QVector<float>[(Intensity + 1)];
-
-    // Erase the array
-    memset(IntensityCount, 0, (Intensity + 1) * sizeof(uchar));
-
-    int startx = X - Radius;
-    int starty = Y - Radius;
-    int width = (2 * Radius) + 1;
-    int height = (2 * Radius) + 1;
-
-    qreal middlePointAlpha = 1;
-    {
-        // if the current pixel is transparent, the result must be transparent, too.
-        KisSequentialConstIterator middlePointIt(src, QRect(X, Y, 1, 1));
-        middlePointIt.nextPixel();
-        middlePointAlpha = cs->opacityF(middlePointIt.oldRawData());
-    }
 
+    /**
+     * The histogram of the window is updated incrementally, so the
+     * cost per pixel doesn't depend on the brush size
+     */
+    auto binFunc = [cs, Scale, &channel] (const quint8 *pixel, float *payload) {
+        if (cs->opacityU8(pixel) == 0) {
+            // if the pixel is transparent, it's not going to provide any useful information
+            return -1;
+        }
 
-    KisSequentialConstIterator srcIt(src, QRect(startx, starty, width, height));
-    while (middlePointAlpha > 0 && srcIt.nextPixel()) {
+        cs->normalisedChannelsValue(pixel, channel);
+        std::copy(channel.constBegin(), channel.constEnd(), payload);
 
-        cs->normalisedChannelsValue(srcIt.oldRawData(), channel);
+        return int(cs->intensity8(pixel) * Scale);
+    };
 
-        if (cs->opacityU8(srcIt.oldRawData()) == 0) {
-            // if the pixel is transparent, it's not going to provide any useful information
-            continue;
-        }
+    auto resultFunc = [cs, &channel] (const KisSlidingWindowHistogram &histogram,
+                                      const quint8 *srcPixel, quint8 *dst) {
+        MostFrequentColor(cs, histogram, srcPixel, dst, channel);
+    };
 
-        I = (uint)(cs->intensity8(srcIt.oldRawData()) * Scale);
+    KritaUtils::processSlidingWindowHistogram(src, dst, applyRect, BrushSize,
+                                              Smoothness + 1, cs->channelCount(),
+                                              binFunc, resultFunc, progressUpdater);
+}
 
-        IntensityCount[I]++;
+// This method has been ported from Pieter Z. Voloshyn's algorithm code in Digikam.
 
-        if (IntensityCount[I] == 1) {
-            AverageChannels[I] = channel;
-        } else {
-            for (int i = 0; i < channel.size(); i++) {
-                AverageChannels[I][i] += channel[i];
-            }
-        }
-    }
+/* Function to determine the most frequent color in a matrix
+ *
+ * histogram        => Intensity histogram of the matrix
+ * srcPixel         => The analyzed pixel in the center of the matrix
+ * dst              => The resulting pixel
+ *
+ * Theory           => This function takes the most frequent intensity in
+ *                     the matrix and writes the average color of the pixels
+ *                     with this intensity
+ */
 
-    I = 0;
-    int MaxInstance = 0;
+void KisOilPaintFilter::MostFrequentColor(const KoColorSpace *cs, const KisSlidingWindowHistogram &histogram,
+                                          const quint8 *srcPixel, quint8* dst, QVector<float> &channel)
+{
+    // if the current pixel is transparent, the result must be transparent, too.
+    const qreal middlePointAlpha = cs->opacityF(srcPixel);
+    const int I = middlePointAlpha > 0 ? histogram.mostFrequentBin() : -1;
 
-    for (int i = 0 ; i <= Intensity ; ++i) {
-        if (IntensityCount[i] > MaxInstance) {
-            I = i;
-            MaxInstance = IntensityCount[i];
-        }
-    }
+    if (I >= 0) {
+        const int MaxInstance = histogram.count(I);
+        const double *AverageChannels = histogram.payload(I);
 
-    if (MaxInstance != 0) {
-        channel = AverageChannels[I];
         for (int i = 0; i < channel.size(); i++) {
-            channel[i] /= MaxInstance;
+            channel[i] = AverageChannels[i] / MaxInstance;
         }
         cs->fromNormalisedChannelsValue(dst, channel);
         cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
@@ -179,10 +156,6 @@ void KisOilPaintFilter::MostFrequentColor(KisPaintDeviceSP src, quint8* dst, con
         memset(dst, 0, cs->pixelSize());
         cs->setOpacity(dst, OPACITY_OPAQUE_U8, middlePointAlpha);
     }
-
-
-    delete [] IntensityCount;        // free all the arrays
-    delete [] AverageChannels;
 }
 
 QRect KisOilPaintFilter::neededRect(const QRect & rect, const KisFilterConfigurationSP _config, int /*lod*/) const
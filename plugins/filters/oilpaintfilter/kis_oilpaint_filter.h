@@ -12,6 +12,9 @@
 #include "filter/kis_filter.h"
 #include "kis_config_widget.h"
 
+class KoColorSpace;
+class KisSlidingWindowHistogram;
+
 class KisOilPaintFilter : public KisFilter
 {
 public:
@@ -37,7 +40,8 @@ public:
 private:
     void OilPaint(const KisPaintDeviceSP src, KisPaintDeviceSP dst, const QRect &applyRect,
                   int BrushSize, int Smoothness, KoUpdater* progressUpdater) const;
-    void MostFrequentColor(KisPaintDeviceSP src, quint8* dst, const QRect& bounds, int X, int Y, int Radius, int Intensity) const;
+    static void MostFrequentColor(const KoColorSpace *cs, const KisSlidingWindowHistogram &histogram,
+                                  const quint8 *srcPixel, quint8* dst, QVector<float> &channel);
 };
 
 #endif
@@ -33,6 +33,7 @@ KisUnsharpFilter::KisUnsharpFilter() : KisFilter(id(), FiltersCategoryEnhanceId,
     setSupportsPainting(true);
     setSupportsAdjustmentLayers(true);
     setSupportsThreading(true);
+    setSupportsStreaming(true);
 
     /**
      * Officially Unsharp Mask doesn't support LoD, because it
@@ -69,6 +69,7 @@ KisToolFill::KisToolFill(KoCanvasBase * canvas)
     : KisToolPaint(canvas, KisCursor::load("tool_fill_cursor.png", 6, 6))
     , m_fillMask(nullptr)
     , m_referencePaintDevice(nullptr)
+    , m_regionLabelMap(new KisFillRegionLabelMap)
     , m_referenceNodeList(nullptr)
     , m_previousTime(0)
     , m_compressorFillUpdate(150, KisSignalCompressor::FIRST_ACTIVE)
@@ -117,6 +118,12 @@ void KisToolFill::deactivate()
 {
     m_referencePaintDevice = nullptr;
     m_referenceNodeList = nullptr;
+    /**
+     * A running fill holds the map until it is finished, so clearing
+     * it here could block the GUI. The fill keeps its own reference
+     * and the old map is freed together with the fill's stroke.
+     */
+    m_regionLabelMap = new KisFillRegionLabelMap;
     KisCanvas2 *kisCanvas = static_cast<KisCanvas2*>(canvas());
     KisCanvasResourceProvider *resourceProvider = kisCanvas->viewManager()->canvasResourceProvider();
     if (resourceProvider) {
@@ -392,6 +399,7 @@ void KisToolFill::addFillingOperation(const QVector<QPoint> &seedPoints)
         visitor->setFillThreshold(m_threshold);
         visitor->setOpacitySpread(m_opacitySpread);
         visitor->setCloseGap(m_closeGap);
+        visitor->setRegionLabelMap(m_regionLabelMap);
         visitor->setUseSelectionAsBoundary(m_useSelectionAsBoundary);
         visitor->setAntiAlias(m_antiAlias);
         visitor->setSizeMod(m_sizemod);
@@ -25,6 +25,7 @@
 #include <kis_resources_snapshot.h>
 #include <commands_new/KisMergeLabeledLayersCommand.h>
 #include <KoCompositeOpRegistry.h>
+#include <floodfill/kis_fill_region_label_map.h>
 
 class KisOptionCollectionWidget;
 class KoGroupButton;
@@ -133,6 +134,7 @@ private:
     KisSelectionSP m_fillMask;
     QSharedPointer<KoColor> m_referenceColor;
     KisPaintDeviceSP m_referencePaintDevice;
+    KisFillRegionLabelMapSP m_regionLabelMap;
     KisMergeLabeledLayersCommand::ReferenceNodeInfoListSP m_referenceNodeList;
     int m_previousTime;
     KisResourcesSnapshotSP m_resourcesSnapshot;
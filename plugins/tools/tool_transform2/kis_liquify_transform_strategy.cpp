@@ -66,6 +66,15 @@ struct KisLiquifyTransformStrategy::Private
 
     QImage transformedImage;
 
+    /**
+     * The thumbnail scaled for the flake optimization. It is recreated
+     * only when the scale changes, so the liquify worker gets the same
+     * source image on every update and can reuse its preview.
+     */
+    QImage scaledThumbnail;
+    QTransform scaledThumbnailTransform;
+    qint64 scaledThumbnailSourceKey = 0;
+
     // size-gesture-related
     QPointF lastMouseWidgetPos;
     QPointF startResizeImagePos;
@@ -133,6 +142,11 @@ void KisLiquifyTransformStrategy::externalConfigChanged()
     m_d->recalculateTransformations();
 }
 
+qint64 KisLiquifyTransformStrategy::testingScaledThumbnailKey() const
+{
+    return m_d->scaledThumbnail.cacheKey();
+}
+
 bool KisLiquifyTransformStrategy::acceptsClicks() const
 {
     return true;
@@ -272,7 +286,18 @@ void KisLiquifyTransformStrategy::Private::recalculateTransformations()
     paintingOffset = transaction.originalTopLeft();
     if (!q->originalImage().isNull()) {
         if (useFlakeOptimization) {
-            transformedImage = q->originalImage().transformed(resultThumbTransform);
+            const QImage originalImage = q->originalImage();
+
+            if (scaledThumbnail.isNull() ||
+                scaledThumbnailTransform != resultThumbTransform ||
+                scaledThumbnailSourceKey != originalImage.cacheKey()) {
+
+                scaledThumbnail = originalImage.transformed(resultThumbTransform);
+                scaledThumbnailTransform = resultThumbTransform;
+                scaledThumbnailSourceKey = originalImage.cacheKey();
+            }
+
+            transformedImage = scaledThumbnail;
             paintingTransform = QTransform();
         } else {
             transformedImage = q->originalImage();
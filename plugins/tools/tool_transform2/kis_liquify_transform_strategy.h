@@ -50,6 +50,12 @@ public:
     void continueAlternateAction(KoPointerEvent *event, KisTool::AlternateAction action) override;
     bool endAlternateAction(KoPointerEvent *event, KisTool::AlternateAction action) override;
 
+    /**
+     * @return the cache key of the thumbnail scaled for the flake
+     *         optimization, or 0 if it is not used
+     */
+    qint64 testingScaledThumbnailKey() const;
+
 Q_SIGNALS:
     void requestCanvasUpdate();
     void requestUpdateOptionWidget();
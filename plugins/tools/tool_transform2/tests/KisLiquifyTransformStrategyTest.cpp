@@ -0,0 +1,91 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#include "KisLiquifyTransformStrategyTest.h"
+
+#include <QPainter>
+
+#include <testutil.h>
+#include "kistest.h"
+
+#include "kis_coordinates_converter.h"
+#include "kis_liquify_transform_strategy.h"
+#include "kis_liquify_transform_worker.h"
+#include "tool_transform_args.h"
+#include "transform_transaction_properties.h"
+
+
+QImage paintPreview(KisLiquifyTransformStrategy &strategy, const QSize &size)
+{
+    QImage result(size, QImage::Format_ARGB32);
+    result.fill(0);
+
+    QPainter gc(&result);
+    strategy.paint(gc);
+
+    return result;
+}
+
+void KisLiquifyTransformStrategyTest::testScaledPreviewCache()
+{
+    const QRect rc(0, 0, 256, 256);
+
+    TestUtil::MaskParent p(rc);
+    p.image->setResolution(100, 100);
+    KisNodeSP node = p.layer;
+
+    KisCoordinatesConverter converter;
+    converter.setResolution(100, 100);
+    converter.setImage(p.image);
+    converter.setDocumentOffset(QPoint(0, 0));
+    converter.setCanvasWidgetSize(QSize(500, 500));
+    converter.setZoom(0.5);
+
+    QImage thumbnail(rc.size(), QImage::Format_ARGB32);
+    thumbnail.fill(Qt::red);
+    {
+        QPainter gc(&thumbnail);
+        gc.fillRect(QRect(64, 64, 128, 128), Qt::blue);
+    }
+
+    ToolTransformArgs args;
+    args.setMode(ToolTransformArgs::LIQUIFY);
+    args.initLiquifyTransformMode(rc);
+
+    TransformTransactionProperties transaction(rc, &args, KisNodeList() << node, {node});
+
+    KisLiquifyTransformStrategy strategy(&converter, args, transaction, nullptr);
+    strategy.setThumbnailImage(thumbnail, QTransform());
+
+    // the zoom is below 100%, so the flake optimization is used
+    strategy.externalConfigChanged();
+    const qint64 thumbnailKey = strategy.testingScaledThumbnailKey();
+    QVERIFY(thumbnailKey != 0);
+
+    args.liquifyWorker()->translatePoints(QPointF(128, 128),
+                                          QPointF(20, 0),
+                                          40, false, 0.2);
+    strategy.externalConfigChanged();
+
+    // the worker gets the same scaled thumbnail, so it can update its preview incrementally
+    QCOMPARE(strategy.testingScaledThumbnailKey(), thumbnailKey);
+
+    ToolTransformArgs refArgs(args);
+    TransformTransactionProperties refTransaction(rc, &refArgs, KisNodeList() << node, {node});
+
+    KisLiquifyTransformStrategy refStrategy(&converter, refArgs, refTransaction, nullptr);
+    refStrategy.setThumbnailImage(thumbnail, QTransform());
+    refStrategy.externalConfigChanged();
+
+    QCOMPARE(paintPreview(strategy, rc.size()), paintPreview(refStrategy, rc.size()));
+
+    // the change of the zoom recreates the scaled thumbnail
+    converter.setZoom(0.25);
+    strategy.externalConfigChanged();
+    QVERIFY(strategy.testingScaledThumbnailKey() != thumbnailKey);
+}
+
+KISTEST_MAIN(KisLiquifyTransformStrategyTest)
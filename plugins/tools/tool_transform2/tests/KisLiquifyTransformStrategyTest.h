@@ -0,0 +1,20 @@
+/*
+ *  SPDX-FileCopyrightText: 2026 Krita developers
+ *
+ *  SPDX-License-Identifier: GPL-2.0-or-later
+ */
+
+#ifndef KISLIQUIFYTRANSFORMSTRATEGYTEST_H
+#define KISLIQUIFYTRANSFORMSTRATEGYTEST_H
+
+#include <simpletest.h>
+
+class KisLiquifyTransformStrategyTest : public QObject
+{
+    Q_OBJECT
+
+private Q_SLOTS:
+    void testScaledPreviewCache();
+};
+
+#endif // KISLIQUIFYTRANSFORMSTRATEGYTEST_H